@@ -28,6 +28,12 @@ DLLEXPORT void Chain_Get_Rx(State * state, float * Rx, int idx_chain = -1) noexc
 DLLEXPORT void Chain_Get_Rx_Interpolated(State * state, float * Rx_interpolated, int idx_chain = -1) noexcept;
 DLLEXPORT void Chain_Get_Energy(State * state, float * energy, int idx_chain = -1) noexcept;
 DLLEXPORT void Chain_Get_Energy_Interpolated(State * state, float * E_interpolated, int idx_chain = -1) noexcept;
+// Parallel tempering statistics of the last run (see Simulation_PlayPause with the method "PT"):
+//      the exchange acceptance ratios of the images i and i+1 (noi-1 values) and the means of the energy
+//      and of the norm of the magnetization at the temperature of each image (noi values)
+DLLEXPORT void Chain_Get_PT_Exchange_Ratios(State * state, float * ratios, int idx_chain = -1) noexcept;
+DLLEXPORT void Chain_Get_PT_Energy_Mean(State * state, float * energies, int idx_chain = -1) noexcept;
+DLLEXPORT void Chain_Get_PT_Magnetization_Mean(State * state, float * magnetizations, int idx_chain = -1) noexcept;
 // TODO: energy array getter
 // std::vector<std::vector<float>> Chain_Get_Energy_Array_Interpolated(State * state, int idx_chain=-1) noexcept;
 
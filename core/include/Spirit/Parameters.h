@@ -6,6 +6,11 @@
 
 struct State;
 
+// Monte Carlo algorithms
+#define MC_Algorithm_Metropolis 0   // Metropolis steps in a cone around the spin or on the entire unit sphere
+#define MC_Algorithm_Heat_Bath  1   // Each spin is drawn from its local Boltzmann distribution
+#define MC_Algorithm_Wolff      2   // Wolff cluster updates of the exchange, corrected for the other interactions
+
 //      Set LLG
 // Output
 DLLEXPORT void Parameters_Set_LLG_Output_Tag(State *state, const char * tag, int idx_image=-1, int idx_chain=-1) noexcept;
@@ -16,8 +21,12 @@ DLLEXPORT void Parameters_Set_LLG_Output_Configuration(State *state, bool config
 DLLEXPORT void Parameters_Set_LLG_N_Iterations(State *state, int n_iterations, int n_iterations_log, int idx_image=-1, int idx_chain=-1) noexcept;
 // Simulation Parameters
 DLLEXPORT void Parameters_Set_LLG_Direct_Minimization(State *state, bool direct, int idx_image=-1, int idx_chain=-1) noexcept;
+// Calculate the energy together with the gradient after each step, instead of on demand
+DLLEXPORT void Parameters_Set_LLG_Energy_From_Gradient(State *state, bool energy_from_gradient, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_LLG_Convergence(State *state, float convergence, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_LLG_Time_Step(State *state, float dt, int idx_image=-1, int idx_chain=-1) noexcept;
+// Set the largest error of a spin direction in a step of the adaptive RK45 solver
+DLLEXPORT void Parameters_Set_LLG_RK_Tolerance(State *state, float tolerance, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_LLG_Damping(State *state, float damping, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_LLG_STT(State *state, bool use_gradient, float magnitude, const float normal[3], int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_LLG_Temperature(State *state, float T, int idx_image=-1, int idx_chain=-1) noexcept;
@@ -34,6 +43,12 @@ DLLEXPORT void Parameters_Set_MC_N_Iterations(State *state, int n_iterations, in
 // Simulation Parameters
 DLLEXPORT void Parameters_Set_MC_Temperature(State *state, float T, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_MC_Acceptance_Ratio(State *state, float ratio, int idx_image=-1, int idx_chain=-1) noexcept;
+// Set whether the Metropolis algorithm should cache the local fields of the spins
+DLLEXPORT void Parameters_Set_MC_Local_Field_Cache(State *state, bool use_cache, int idx_image=-1, int idx_chain=-1) noexcept;
+// Set whether the Metropolis algorithm should update the spins of each colour of the interaction graph in parallel
+DLLEXPORT void Parameters_Set_MC_Parallel_Sweep(State *state, bool parallel_sweep, int idx_image=-1, int idx_chain=-1) noexcept;
+// Set the MC algorithm (MC_Algorithm_Metropolis, MC_Algorithm_Heat_Bath or MC_Algorithm_Wolff)
+DLLEXPORT void Parameters_Set_MC_Algorithm(State *state, int algorithm, int idx_image=-1, int idx_chain=-1) noexcept;
 
 //      Set GNEB
 // Output
@@ -51,6 +66,9 @@ DLLEXPORT void Parameters_Set_GNEB_Climbing_Falling(State *state, int image_type
 //    Maxima are set to climbing, minima to falling, others are not changed.
 DLLEXPORT void Parameters_Set_GNEB_Image_Type_Automatically(State *state, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Set_GNEB_N_Energy_Interpolations(State *state, int n, int idx_chain=-1) noexcept;
+// Evaluate the images of the chain in parallel (on the OpenMP threads) instead of parallelising
+//    over the spins of each image. The results are the same in both cases.
+DLLEXPORT void Parameters_Set_GNEB_Parallel_Images(State *state, bool parallel_images, int idx_chain=-1) noexcept;
 
 
 //      Get LLG
@@ -63,9 +81,11 @@ DLLEXPORT void Parameters_Get_LLG_Output_Configuration(State *state, bool * conf
 DLLEXPORT void Parameters_Get_LLG_N_Iterations(State *state, int * iterations, int * iterations_log, int idx_image=-1, int idx_chain=-1) noexcept;
 // Simulation Parameters
 DLLEXPORT bool Parameters_Get_LLG_Direct_Minimization(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
+DLLEXPORT bool Parameters_Get_LLG_Energy_From_Gradient(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT float Parameters_Get_LLG_Convergence(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 // Set the LLG time step in [ps]
 DLLEXPORT float Parameters_Get_LLG_Time_Step(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
+DLLEXPORT float Parameters_Get_LLG_RK_Tolerance(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT float Parameters_Get_LLG_Damping(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT float Parameters_Get_LLG_Temperature(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT void Parameters_Get_LLG_Temperature_Gradient(State *state, float * direction, float normal[3], int idx_image=-1, int idx_chain=-1) noexcept;
@@ -82,6 +102,9 @@ DLLEXPORT void Parameters_Get_MC_N_Iterations(State *state, int * iterations, in
 // Simulation Parameters
 DLLEXPORT float Parameters_Get_MC_Temperature(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT float Parameters_Get_MC_Acceptance_Ratio(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
+DLLEXPORT bool Parameters_Get_MC_Local_Field_Cache(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
+DLLEXPORT bool Parameters_Get_MC_Parallel_Sweep(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
+DLLEXPORT int Parameters_Get_MC_Algorithm(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 
 //      Get GNEB
 // Output
@@ -96,6 +119,7 @@ DLLEXPORT float Parameters_Get_GNEB_Convergence(State *state, int idx_image=-1,
 DLLEXPORT float Parameters_Get_GNEB_Spring_Constant(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT int Parameters_Get_GNEB_Climbing_Falling(State *state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT int Parameters_Get_GNEB_N_Energy_Interpolations(State *state, int idx_chain=-1) noexcept;
+DLLEXPORT bool Parameters_Get_GNEB_Parallel_Images(State *state, int idx_chain=-1) noexcept;
 
 #include "DLL_Undefine_Export.h"
 #endif
\ No newline at end of file
@@ -11,4 +11,21 @@ DLLEXPORT void Quantity_Get_Magnetization(State * state, float m[3], int idx_ima
 // Topological Charge
 DLLEXPORT float Quantity_Get_Topological_Charge(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 
+// ------ Monte Carlo averages ------
+// The MC method takes a sample of the total energy E and of the magnetization m per spin after each
+// iteration. The samples are accumulated across MC runs, until they are reset.
+
+// Number of samples
+DLLEXPORT int Quantity_Get_MC_N_Samples(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
+// Thermal averages <E>, <m>, <|m|>, <m^2> and <m^4>
+DLLEXPORT void Quantity_Get_MC_Averages(State * state, float * energy, float m[3], float * m_abs, float * m_2, float * m_4, int idx_image=-1, int idx_chain=-1) noexcept;
+// Specific heat per spin (in units of kB), susceptibility per spin (in 1/meV) and Binder cumulant
+// at the MC temperature of the image
+DLLEXPORT void Quantity_Get_MC_Response(State * state, float * specific_heat, float * susceptibility, float * binder_cumulant, int idx_image=-1, int idx_chain=-1) noexcept;
+// Integrated autocorrelation times (in iterations) of E and |m| and the standard errors of <E> and <|m|>,
+// from a blocking analysis
+DLLEXPORT void Quantity_Get_MC_Autocorrelation(State * state, float * tau_energy, float * tau_m_abs, float * error_energy, float * error_m_abs, int idx_image=-1, int idx_chain=-1) noexcept;
+// Remove all samples, e.g. after the thermalisation
+DLLEXPORT void Quantity_Reset_MC_Averages(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
+
 #endif
\ No newline at end of file
@@ -12,6 +12,10 @@ DLLEXPORT int System_Get_Index(State * state) noexcept;
 DLLEXPORT int System_Get_NOS(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 
 // Data
+//      The effective field and energies are calculated on demand, i.e. if the spins or the Hamiltonian
+//      have changed since they were last calculated
+//      The effective field is minus the gradient of the Hamiltonian, -dE/dn_i in meV, for any method.
+//      It is not projected onto the tangent planes of the spins, as the LLG method used to do.
 DLLEXPORT scalar * System_Get_Spin_Directions(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT scalar * System_Get_Effective_Field(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 DLLEXPORT float System_Get_Rx(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
@@ -22,6 +26,7 @@ DLLEXPORT void System_Get_Energy_Array(State * state, float * energies, int idx_
 DLLEXPORT void System_Print_Energy_Array(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 
 // Update Data (primarily for plots)
+//      Recalculates the energies, e.g. after the spins were changed through System_Get_Spin_Directions
 DLLEXPORT void System_Update_Data(State * state, int idx_image=-1, int idx_chain=-1) noexcept;
 
 #include "DLL_Undefine_Export.h"
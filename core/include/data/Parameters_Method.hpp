@@ -36,6 +36,11 @@ namespace Data
         // Force convergence criterium
         scalar force_convergence;
 
+        // ---------------- Images ---------------
+        // Evaluate the images of a method (e.g. GNEB) in parallel instead of parallelising
+        // over the spins of each image. The results are identical.
+        bool parallel_images;
+
         // ----------------- Output --------------
         // Data output folder
         std::string output_folder;
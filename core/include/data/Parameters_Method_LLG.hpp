@@ -6,6 +6,7 @@
 
 #include "Spirit_Defines.h"
 #include <engine/Vectormath_Defines.hpp>
+#include <engine/Random.hpp>
 #include <data/Parameters_Method_Solver.hpp>
 
 namespace Data
@@ -21,7 +22,7 @@ namespace Data
             int rng_seed, scalar temperature, Vector3 temperature_gradient_direction, scalar temperature_gradient_inclination,
             scalar damping, scalar beta, scalar time_step, 
             bool renorm_sd, bool stt_use_gradient, scalar stt_magnitude, 
-            Vector3 stt_polarisation_normal);
+            Vector3 stt_polarisation_normal, scalar rk_tolerance);
 
         // Damping
         scalar damping;
@@ -31,6 +32,8 @@ namespace Data
         int rng_seed;
         // Mersenne twister PRNG
         std::mt19937 prng;
+        // Counter-based PRNG for the thermal noise, reproducible for any number of threads
+        Engine::Random::Philox philox;
 
         // Temperature [K]
         scalar temperature;
@@ -49,6 +52,12 @@ namespace Data
         // Do direct minimization instead of dynamics
         bool direct_minimization;
 
+        // Calculate the energy together with the gradient after each step, instead of on demand
+        bool energy_from_gradient;
+
+        // Largest error of a spin direction in a step of the adaptive RK45 solver
+        scalar rk_tolerance;
+
         // ----------------- Output --------------
         // Energy output settings
         bool output_energy_step;
@@ -7,9 +7,21 @@
 
 #include "Spirit_Defines.h"
 #include <data/Parameters_Method.hpp>
+#include <engine/Random.hpp>
 
 namespace Data
 {
+    // Monte Carlo algorithms (see MC_Algorithm_* of the API)
+    enum class MC_Algorithm
+    {
+        // Metropolis steps in a cone around the spin or on the entire unit sphere
+        Metropolis = 0,
+        // Each spin is drawn from its local Boltzmann distribution
+        Heat_Bath  = 1,
+        // Wolff cluster updates of the exchange, with a Metropolis criterion for the other interactions
+        Wolff      = 2
+    };
+
     // LLG_Parameters contains all LLG information about the spin system
     class Parameters_Method_MC : public Parameters_Method
     {
@@ -18,15 +30,20 @@ namespace Data
             std::array<bool,10> output, int output_configuration_filetype,
             long int n_iterations, long int n_iterations_log, long int max_walltime_sec,
             std::shared_ptr<Pinning> pinning, int rng_seed, 
-            scalar temperature, scalar acceptance_ratio_target);
+            scalar temperature, scalar acceptance_ratio_target, bool local_field_cache, bool parallel_sweep,
+            MC_Algorithm algorithm);
 
         // Temperature [K]
         scalar temperature;
+        // The algorithm of the steps
+        MC_Algorithm algorithm;
         // Seed for RNG
         int rng_seed;
 
         // Mersenne twister PRNG
         std::mt19937 prng;
+        // Counter-based PRNG for the trial moves
+        Engine::Random::Philox philox;
 
         // Whether to sample spins randomly or in sequence in Metropolis algorithm
         bool metropolis_random_sample;
@@ -40,6 +57,14 @@ namespace Data
         // Target acceptance ratio of mc steps for adaptive cone angle
         scalar acceptance_ratio_target;
 
+        // Whether to keep the local fields of all spins and update them after each accepted step,
+        // so that a Metropolis step costs O(neighbours) instead of a full single spin energy
+        bool local_field_cache;
+
+        // Whether to sweep over the colours of the interaction graph, updating the spins of one colour in
+        // parallel, instead of the serial Metropolis sweep. This uses the local fields.
+        bool parallel_sweep;
+
         // ----------------- Output --------------
         // Energy output settings
         bool output_energy_step;
@@ -5,6 +5,7 @@
 #include <random>
 #include <memory>
 #include <mutex>
+#include <cstdint>
 
 #include "Spirit_Defines.h"
 #include <engine/Vectormath_Defines.hpp>
@@ -13,6 +14,7 @@
 #include <data/Parameters_Method_LLG.hpp>
 #include <data/Parameters_Method_MC.hpp>
 #include <data/Parameters_Method_GNEB.hpp>
+#include <utility/Statistics.hpp>
 
 namespace Data
 {
@@ -30,9 +32,19 @@ namespace Data
 		// Assignment operator
 		Spin_System& operator=(Spin_System const & other);
 
-		// Update
-		void UpdateEnergy();
+		// Update the observables E, E_array, M and effective_field. They are calculated on demand,
+		// i.e. only if the spins or the Hamiltonian have changed since they were last calculated.
+		//		If the contributions are not needed, a known total energy is not recalculated.
+		void UpdateEnergy(bool contributions = true);
 		void UpdateEffectiveField();
+		void UpdateMagnetization();
+		// Mark the observables as outdated. Has to be called whenever the spins or the Hamiltonian are changed.
+		void InvalidateObservables();
+		// Set the total energy of the current spins, e.g. if it was calculated together with the gradient
+		void SetEnergy(scalar E);
+		// Number of changes of the spins and the Hamiltonian so far. Data derived from the spins is
+		// outdated if the count has changed since it was calculated.
+		std::uint64_t Changes() const;
 
 		// For multithreading
 		void Lock() const;
@@ -53,17 +65,24 @@ namespace Data
 		// Is it allowed to iterate on this system?
 		bool iteration_allowed;
 
-		// Total Energy of the spin system (to be updated from outside, i.e. SIB, GNEB, ...)
+		// Total Energy of the spin system (see UpdateEnergy)
 		scalar E;
 		std::vector<std::pair<std::string, scalar>> E_array;
 		// Mean of magnetization
 		Vector3 M;
 		// Total effective field of the spins [3][nos]
 		vectorfield effective_field;
+		// Thermal averages of the MC samples (one per iteration) since they were last reset (not copied with the system)
+		Utility::MC_Observables mc_observables;
 
 	private:
 		// Mutex for thread-safety
 		mutable std::mutex mutex;
+
+		// Number of changes of the spins and the Hamiltonian, and the number of changes at which
+		// each of the observables was last calculated
+		std::uint64_t n_changes;
+		std::uint64_t n_changes_E, n_changes_E_array, n_changes_M, n_changes_effective_field;
 	};
 }
 #endif
\ No newline at end of file
@@ -49,6 +49,12 @@ namespace Data
 		std::vector<scalar> E_interpolated;
 		std::vector<std::vector<scalar>> E_array_interpolated;
 
+		// Parallel tempering statistics of the last run: the exchanges attempted and accepted between
+		// images i and i+1, and the means of the energy and of the norm of the magnetization at the
+		// temperature of each image
+		std::vector<int> pt_exchanges_attempted, pt_exchanges_accepted;
+		std::vector<scalar> pt_energy_mean, pt_magnetization_mean;
+
 	private:
 		// Mutex for thread-safety
 		mutable std::mutex mutex;
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <array>
+
+#include "Spirit_Defines.h"
+#include <engine/Vectormath_Defines.hpp>
+
+namespace Engine
+{
+    namespace FFT
+    {
+        using FFT_cpx_type = std::complex<scalar>;
+        using cpxfield     = field<FFT_cpx_type>;
+
+        // Complex transform of a single length. Powers of two use an iterative radix-2
+        // scheme, all other lengths are mapped onto a radix-2 transform (Bluestein).
+        class FFT_Plan_1D
+        {
+        public:
+            FFT_Plan_1D(int n=1);
+
+            // In-place transform of n contiguous values. The inverse is not normalised.
+            void Execute(FFT_cpx_type * data, bool inverse, cpxfield & scratch) const;
+
+            int n;
+
+        private:
+            // Length of the underlying radix-2 transform
+            int m;
+            cpxfield twiddles;
+            // Bluestein chirp and the transform of its filter (empty for powers of two)
+            cpxfield chirp;
+            cpxfield chirp_filter;
+
+            void Radix2(FFT_cpx_type * data, bool inverse) const;
+        };
+
+        // Complex transform of a 3D array with index a + na*(b + nb*c)
+        class FFT_Plan
+        {
+        public:
+            FFT_Plan(std::array<int,3> dims = {1,1,1});
+
+            void Forward(FFT_cpx_type * data) const;
+            // Normalised inverse of Forward
+            void Backward(FFT_cpx_type * data) const;
+
+            std::array<int,3> dims;
+            int size;
+
+        private:
+            std::array<FFT_Plan_1D,3> plans;
+
+            void Transform(FFT_cpx_type * data, bool inverse) const;
+        };
+    }
+}
+
+#endif
@@ -36,9 +36,57 @@ namespace Engine
 
         /*
             Calculate the Hessian matrix of a spin configuration.
-            This function uses finite differences and may thus be quite inefficient.
+            This function uses finite differences (see Sparse_Hessian_FD).
         */
         virtual void Hessian_FD(const vectorfield & spins, MatrixX & hessian) final;
+
+        /*
+            Calculate the Hessian matrix of a spin configuration in sparse format, using finite differences.
+            Spins which do not interact, directly or via a common partner, are displaced together,
+            so that 6 gradient evaluations are needed per colour of the interaction graph.
+        */
+        virtual void Sparse_Hessian_FD(const vectorfield & spins, SpMatrixX & hessian) final;
+
+        /*
+            The spins each spin interacts with (excluding itself), i.e. the sparsity pattern of the
+            Hessian, in compressed sparse row format: the partners of spin i are stored at
+            [offsets[i], offsets[i+1]).
+            A Hamiltonian returning true has to implement Energy_Single_Spin such that it only depends on
+            the spin and its partners and that its sum over all spins is the energy.
+            Returns false if every spin may interact with every other spin, which is the fallback.
+        */
+        virtual bool Interaction_Graph(int nos, intfield & offsets, intfield & partners);
+
+        /*
+            Greedy colouring of the interaction graph, s.t. spins of one colour do not interact (distance 1)
+            or, with distance 2, additionally do not share a partner. Spins of one colour can then e.g. be
+            updated concurrently. Returns the number of colours, or 0 if there is no interaction graph.
+        */
+        virtual int Interaction_Colouring(int nos, int distance, intfield & colours) final;
+
+        /*
+            The isotropic exchange in compressed sparse row format: the partners of spin i and the exchange
+            constants J_ij of the pair energies -J_ij s_i.s_j are stored at [offsets[i], offsets[i+1]), with
+            both directions of each pair present. Used e.g. for Monte Carlo cluster updates.
+            Returns false if the Hamiltonian does not provide it.
+        */
+        virtual bool Exchange_Graph(int nos, intfield & offsets, intfield & partners, scalarfield & magnitudes);
+
+        /*
+            Calculate the Hessian matrix of a spin configuration in sparse format.
+            This function converts the dense Hessian and thus needs O(N^2) memory. You should
+            override it if the interactions are short-ranged.
+            This function is the fallback for derived classes where it has not been overridden.
+        */
+        virtual void Sparse_Hessian(const vectorfield & spins, SpMatrixX & hessian);
+
+        /*
+            Calculate the product of the Hessian matrix of a spin configuration with a vector field.
+            This function uses finite differences of the gradient (two gradient evaluations). You
+            should override it if you want to get proper performance or accuracy.
+            This function is the fallback for derived classes where it has not been overridden.
+        */
+        virtual void Hessian_Vector_Product(const vectorfield & spins, const vectorfield & vectors, vectorfield & product);
         
         /*
             Calculate the energy gradient of a spin configuration.
@@ -50,10 +98,18 @@ namespace Engine
 
         /*
             Calculate the energy gradient of a spin configuration.
-            This function uses finite differences and may thus be quite inefficient.
+            This function uses finite differences. If the interaction graph is known, only the single
+            spin energies of each displaced spin and its partners are recalculated, otherwise the energy.
         */
         virtual void Gradient_FD(const vectorfield & spins, vectorfield & gradient) final;
 
+        /*
+            Calculate the energy gradient of a spin configuration and return its energy.
+            Derived classes should override this to obtain both from the same pass over the
+            interactions. This function is the fallback, which calls Gradient and Energy.
+        */
+        virtual scalar Energy_and_Gradient(const vectorfield & spins, vectorfield & gradient);
+
         // Calculate the Energy contributions for the spins of a configuration
         virtual void Energy_Contributions_per_Spin(const vectorfield & spins, std::vector<std::pair<std::string, scalarfield>> & contributions);
 
@@ -65,6 +121,24 @@ namespace Engine
 
         // Calculate the total energy for a single spin
         virtual scalar Energy_Single_Spin(int ispin, const vectorfield & spins);
+
+        /*
+            Local fields h_i = -dE/ds_i of the interactions which couple spin i to other spins,
+            i.e. excluding single spin terms such as Zeeman and anisotropy.
+            With these, the energy difference of a single spin move can be calculated in O(1),
+            e.g. in Monte Carlo.
+        */
+        virtual void Local_Fields(const vectorfield & spins, vectorfield & fields);
+
+        // Energy difference of moving spin ispin to spin_new, given up to date local fields
+        virtual scalar Energy_Difference_Single_Spin(int ispin, const Vector3 & spin_new, const vectorfield & spins, const vectorfield & fields);
+
+        // Update the local fields after spin ispin has been moved away from spin_old (spins contain the new orientation)
+        virtual void Update_Local_Fields(int ispin, const Vector3 & spin_old, const vectorfield & spins, vectorfield & fields);
+
+        // The field h of all terms linear in spin ispin, i.e. the local field plus e.g. the Zeeman field, given
+        // up to date local fields. The energy of the spin is -s.h plus the remaining (e.g. anisotropy) terms.
+        virtual Vector3 Linear_Field_Single_Spin(int ispin, const vectorfield & spins, const vectorfield & fields);
         
         // Hamiltonian name as string
         virtual const std::string& Name();
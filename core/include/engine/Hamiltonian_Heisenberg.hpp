@@ -4,14 +4,26 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdint>
 
 #include "Spirit_Defines.h"
 #include <engine/Vectormath_Defines.hpp>
 #include <engine/Hamiltonian.hpp>
+#include <engine/FFT.hpp>
 #include <data/Geometry.hpp>
 
 namespace Engine
 {
+    // Evaluation of the dipole-dipole interaction
+    enum class DDI_Method
+    {
+        // Direct summation over the pairs within the cutoff radius
+        Cutoff = 0,
+        // Convolution of the spins with the dipolar tensor on the lattice, using FFTs
+        FFT    = 1
+    };
+
     /*
         The Heisenberg Hamiltonian using Pairs contains all information on the interactions between spins.
         The information is presented in pair lists and parameter lists in order to easily e.g. calculate the energy of the system via summation.
@@ -26,10 +38,11 @@ namespace Engine
             intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
             pairfield exchange_pairs, scalarfield exchange_magnitudes,
             pairfield dmi_pairs, scalarfield dmi_magnitudes, vectorfield dmi_normals,
-            scalar ddi_radius,
+            DDI_Method ddi_method, scalar ddi_radius,
             quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
             std::shared_ptr<Data::Geometry> geometry,
-            intfield boundary_conditions
+            intfield boundary_conditions,
+            std::string interaction_cache_file = ""
         );
 
         Hamiltonian_Heisenberg(
@@ -38,10 +51,11 @@ namespace Engine
             intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
             scalarfield exchange_shell_magnitudes,
             scalarfield dmi_shell_magnitudes, int dm_chirality,
-            scalar ddi_radius,
+            DDI_Method ddi_method, scalar ddi_radius,
             quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
             std::shared_ptr<Data::Geometry> geometry,
-            intfield boundary_conditions
+            intfield boundary_conditions,
+            std::string interaction_cache_file = ""
         );
 
         void Update_Interactions();
@@ -49,12 +63,23 @@ namespace Engine
         void Update_Energy_Contributions() override;
 
         void Hessian(const vectorfield & spins, MatrixX & hessian) override;
+        void Sparse_Hessian(const vectorfield & spins, SpMatrixX & hessian) override;
+        void Hessian_Vector_Product(const vectorfield & spins, const vectorfield & vectors, vectorfield & product) override;
         void Gradient(const vectorfield & spins, vectorfield & gradient) override;
+        scalar Energy_and_Gradient(const vectorfield & spins, vectorfield & gradient) override;
+        bool Interaction_Graph(int nos, intfield & offsets, intfield & partners) override;
+        bool Exchange_Graph(int nos, intfield & offsets, intfield & partners, scalarfield & magnitudes) override;
         void Energy_Contributions_per_Spin(const vectorfield & spins, std::vector<std::pair<std::string, scalarfield>> & contributions) override;
 
         // Calculate the total energy for a single spin
         scalar Energy_Single_Spin(int ispin, const vectorfield & spins) override;
 
+        // Local fields of the pair and quadruplet interactions, e.g. for Monte Carlo
+        void Local_Fields(const vectorfield & spins, vectorfield & fields) override;
+        scalar Energy_Difference_Single_Spin(int ispin, const Vector3 & spin_new, const vectorfield & spins, const vectorfield & fields) override;
+        void Update_Local_Fields(int ispin, const Vector3 & spin_old, const vectorfield & spins, vectorfield & fields) override;
+        Vector3 Linear_Field_Single_Spin(int ispin, const vectorfield & spins, const vectorfield & fields) override;
+
         // Hamiltonian name as string
         const std::string& Name() override;
         
@@ -73,6 +98,10 @@ namespace Engine
         intfield anisotropy_indices;
         scalarfield anisotropy_magnitudes;
         vectorfield anisotropy_normals;
+        // The anisotropy axes of each basis atom in compressed sparse row format: the indices into
+        // the arrays above for basis atom ibasis are stored at [offsets[ibasis], offsets[ibasis+1])
+        intfield anisotropy_basis_offsets;
+        intfield anisotropy_basis_terms;
 
         // ------------ Pair Interactions ------------
         // Exchange interaction
@@ -90,19 +119,89 @@ namespace Engine
         pairfield   dmi_pairs;
         scalarfield dmi_magnitudes;
         vectorfield dmi_normals;
+        // Neighbour tables in compressed sparse row format, built from the pairs above:
+        // the partners of spin i are stored at [offsets[i], offsets[i+1]), with both
+        // directions of each pair present and invalid pairs (bounds, vacancies) dropped
+        intfield    exchange_offsets;
+        intfield    exchange_partners;
+        scalarfield exchange_partner_magnitudes;
+        intfield    dmi_offsets;
+        intfield    dmi_partners;
+        scalarfield dmi_partner_magnitudes;
+        vectorfield dmi_partner_normals;
         // Dipole Dipole interaction
+        //   with the FFT method the cutoff radius is optional (0 means all pairs in the lattice)
+        DDI_Method  ddi_method;
         scalar      ddi_cutoff_radius;
         pairfield   ddi_pairs;
         scalarfield ddi_magnitudes;
         vectorfield ddi_normals;
+        // Neighbour table of the cutoff method, with the prefactors mu_i*mu_j*mult/r^3 as magnitudes
+        intfield    ddi_offsets;
+        intfield    ddi_partners;
+        scalarfield ddi_partner_prefactors;
+        vectorfield ddi_partner_normals;
 
         // ------------ Quadruplet Interactions ------------
         quadrupletfield quadruplets;
         scalarfield     quadruplet_magnitudes;
+        // Quadruplets on the lattice (four spin indices each) and, in compressed sparse row
+        // format, the indices of the lattice quadruplets each spin takes part in
+        intfield        quadruplet_lattice_spins;
+        scalarfield     quadruplet_lattice_magnitudes;
+        intfield        quadruplet_offsets;
+        intfield        quadruplet_memberships;
+
+        // ------------ Interaction Cache ------------
+        // Binary file in which the interaction tables are stored, keyed by a hash of the geometry and
+        // the parameters they are built from. If it matches, the tables are read instead of rebuilt.
+        // An empty name disables the cache.
+        std::string interaction_cache_file;
 
     private:
         std::shared_ptr<Data::Geometry> geometry;
 
+        // Build all interaction tables from the parameters
+        void Build_Interactions();
+        // Hash of everything the interaction tables are built from
+        std::uint64_t Interaction_Cache_Key();
+        // Read (returns false if the file does not exist or does not match the key) or write the interaction cache
+        bool Read_Interaction_Cache(std::uint64_t key);
+        void Write_Interaction_Cache(std::uint64_t key);
+        // Apply an archive (reader or writer) to each of the interaction tables
+        template<typename Archive>
+        void Archive_Interactions(Archive & archive);
+        // Build the per-basis anisotropy table
+        void Build_Anisotropy_Table();
+        // Build a per-spin neighbour table from a list of pairs (normals may be empty)
+        void Build_Neighbour_Table( const pairfield & pairs, const scalarfield & magnitudes, const vectorfield & normals, bool pairs_are_redundant,
+            intfield & offsets, intfield & partners, scalarfield & partner_magnitudes, vectorfield & partner_normals );
+        // Build the lattice quadruplets and the per-spin quadruplet table
+        void Build_Quadruplet_Table();
+        // Nonzero entries of the Hessian, except for the FFT dipole-dipole interaction beyond the cutoff
+        void Hessian_Triplets(const vectorfield & spins, std::vector<Eigen::Triplet<scalar>> & triplets);
+
+        // ------------ FFT Dipole-Dipole ------------
+        // Dipolar tensor (including mu_s of the second atom) between two basis atoms at a cell translation
+        Matrix3 DDI_Tensor(int ibasis, int jbasis, std::array<int,3> translations);
+        // Dipolar tensor of the minimum image of a cell translation along periodic directions
+        Matrix3 DDI_Tensor_Minimum_Image(int ibasis, int jbasis, std::array<int,3> translations);
+        // Set up the FFT plan and buffers on the (zero-padded) lattice and, unless they were
+        // read from the interaction cache, build the transformed dipolar tensors
+        void Update_DDI_FFT(bool transform_tensors = true);
+        // Dipolar field sum_j T_ij s_j at every spin
+        void DDI_Field_FFT(const vectorfield & spins, vectorfield & ddi_field);
+        // Dipolar tensor T_ij of two spins as used in the convolution, i.e. with the same images
+        Matrix3 DDI_Tensor_FFT(int ispin, int jspin);
+        FFT::FFT_Plan    ddi_fft_plan;
+        // Transformed tensors, indexed [component][ibasis][jbasis][padded cell], with the six
+        // independent components xx, xy, xz, yy, yz, zz
+        FFT::cpxfield    ddi_fft_kernel;
+        // Transformed spins and fields, indexed [component][basis][padded cell]
+        FFT::cpxfield    ddi_fft_spins;
+        FFT::cpxfield    ddi_fft_field;
+        vectorfield      ddi_field;
+
         // ------------ Effective Field Functions ------------
         // Calculate the Zeeman effective field of a single Spin
         void Gradient_Zeeman(vectorfield & gradient);
@@ -29,6 +29,7 @@ namespace Engine
     private:
         // Calculate Forces onto Systems
         void Calculate_Force(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<vectorfield> & forces) override;
+        bool Calculate_Energy_and_Force(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<scalar> & energies, std::vector<vectorfield> & forces) override;
         void Calculate_Force_Virtual(const std::vector<std::shared_ptr<vectorfield>> & configurations, const std::vector<vectorfield> & forces, std::vector<vectorfield> & forces_virtual) override;
 
         // Check if the Forces are converged
@@ -46,10 +47,16 @@ namespace Engine
 
         // Last calculated forces
         std::vector<vectorfield> Gradient;
+        // Whether the Gradient was calculated together with the energy of the spins of a system,
+        // and the number of changes of the system (see Spin_System::Changes) at that point
+        std::vector<bool> gradient_from_energy;
+        std::vector<std::uint64_t> gradient_changes;
+        // Energies belonging to the Gradient, and whether the Gradient was last calculated together
+        // with the energy of the spins of a system (e.g. in a line search of the solver)
+        std::vector<scalar> gradient_energies;
+        std::vector<bool> gradient_at_spins;
         // Convergence parameters
         std::vector<bool> force_converged;
-        // Temperature distribution
-        scalarfield temperature_distribution;
         // Field for stt gradient method
         vectorfield s_c_grad;
 
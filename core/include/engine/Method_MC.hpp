@@ -17,20 +17,46 @@ namespace Engine
     class Method_MC : public Method
     {
     public:
-        // Constructor
-        Method_MC(std::shared_ptr<Data::Spin_System> system, int idx_img, int idx_chain);
+        // Constructor. Streams other than 0 draw random numbers independent of those of the MC parameters' seed,
+        // e.g. for the replicas of parallel tempering, which are usually copies of an image with the same seed.
+        Method_MC(std::shared_ptr<Data::Spin_System> system, int idx_img, int idx_chain, int stream=0);
 
         // Method name as string
         std::string Name() override;
         
     private:
+        // Parallel tempering sweeps each of its replicas with the iteration of a Method_MC
+        friend class Method_PT;
+
         // Solver_Iteration represents one iteration of a certain Solver
         void Iteration() override;
 
-        // Metropolis iteration with adaptive cone radius
-        void Metropolis(const vectorfield & spins_old, vectorfield & spins_new);
+        // Sweep of single spin steps (on average one per spin), with adaptive cone radius
+        void Sweep(vectorfield & spins);
+        // Sweep of single spin steps, updating the spins of one colour of the interaction graph after the other,
+        // each colour in parallel
+        void Sweep_Parallel(vectorfield & spins);
+        // Wolff cluster updates, until about as many spins as the system has were flipped
+        void Wolff(vectorfield & spins);
+        // Single spin step (Metropolis or heat bath) using the cached local fields, given three random numbers
+        // in [0,1). An accepted step is applied to the spins and the local fields and its energy difference is
+        // added to energy_change. Returns whether it was accepted.
+        bool Local_Field_Step(int ispin, scalar random_theta, scalar random_phi, scalar random_accept, scalar cos_cone_angle,
+            vectorfield & spins, scalar & energy_change);
+        // Sum of the single spin energies of a spin and its partners in the interaction graph. Its change
+        // is the energy difference of a step of the spin.
+        scalar Energy_Neighbourhood(int ispin, const vectorfield & spins) const;
+        // Adapt the cone angle to the acceptance ratio of the last iteration
+        void Adapt_Cone_Angle();
+        // Trial orientation of a spin (in the cone or on the entire unit sphere), from two random numbers in [0,1)
+        Vector3 Trial_Spin(const Vector3 & spin_current, scalar random_theta, scalar random_phi, scalar cos_cone_angle) const;
+        // Trial orientation of a spin drawn from the Boltzmann distribution exp(s.h/kB_T) in the linear field h,
+        // from two random numbers in [0,1)
+        Vector3 Heat_Bath_Spin(const Vector3 & spin_current, const Vector3 & field, scalar random_theta, scalar random_phi) const;
+        // Metropolis criterion for an energy difference, given a random number in [0,1)
+        bool Metropolis_Accept(scalar Ediff, scalar random) const;
 
-        // Save the current Step's Data: spins and energy
+        // Save the current Step's Data: the thermal averages of the samples at the end
         void Save_Current(std::string starttime, int iteration, bool initial=false, bool final=false) override;
         // A hook into the Method before an Iteration of the Solver
         void Hook_Pre_Iteration() override;
@@ -51,10 +77,53 @@ namespace Engine
 
         std::shared_ptr<Data::Parameters_Method_MC> parameters_mc;
 
+        // Generator of the random numbers, keyed by the seed and the stream. The draws are counted
+        // by the generator of the MC parameters, so that subsequent runs continue the sequence.
+        Random::Philox philox;
+
         // Cosine of current cone angle
         scalar cone_angle;
         int n_rejected;
         scalar acceptance_ratio_current;
+
+        // Heat bath instead of Metropolis steps (requires the local fields)
+        bool use_heat_bath;
+
+        // Wolff cluster updates (require the local fields) on the exchange graph of the Hamiltonian
+        bool use_wolff;
+        intfield exchange_offsets, exchange_partners;
+        scalarfield exchange_magnitudes;
+        // The spins of the current cluster and whether each spin is in it
+        intfield cluster_spins, in_cluster;
+
+        // Cached local fields of all spins, used if the Hamiltonian supports them. They are kept up to date by
+        // the sweeps and only calculated anew if the spins of the system were changed otherwise.
+        bool use_local_fields;
+        vectorfield local_fields;
+
+        // Energy of the spins, kept up to date by adding the energy differences of the accepted steps. It is
+        // calculated anew if the spins of the system were changed otherwise and every few iterations, so that
+        // the rounding errors of the differences do not accumulate.
+        scalar energy_current;
+        int iterations_since_energy;
+
+        // The spins and their number of changes (see Spin_System::Changes) recorded after the last iteration.
+        // If the spins were replaced or the number of changes differs, they were changed otherwise.
+        const vectorfield * cached_spins;
+        std::uint64_t cached_changes;
+
+        // Interaction graph of the Hamiltonian, used for the energy differences without the local fields.
+        // Without both, the energy differences are those of the total energy.
+        bool use_interaction_graph;
+        intfield interaction_offsets, interaction_partners;
+
+        // The spins of each colour of the interaction graph, if the parallel sweep is used
+        bool use_parallel_sweep;
+        std::vector<intfield> colour_spins;
+
+        // Energy and magnetization of the last sample, which is taken after each iteration
+        scalar sample_energy;
+        Vector3 sample_magnetization;
     };
 }
 
@@ -11,6 +11,14 @@ namespace Engine
 {
     /*
         The Minimum Mode Following (MMF) method
+            The force is inverted along the lowest eigenmode of the Hessian, so that the systems
+            climb to first order saddle points without needing a chain. The mode is found with a
+            matrix-free Lanczos iteration in the tangent space of the spins, which only needs
+            Hessian-vector products and starts from the mode of the previous iteration.
+        Paper: G. Henkelman and H. Jonsson, A dimer method for finding saddle points on high
+               dimensional potential surfaces using only first derivatives, J. Chem. Phys. 111, 7010 (1999).
+               G. P. Mueller et al., Duplication, collapse, and escape of magnetic skyrmions revealed
+               using a systematic saddle point search method, Phys. Rev. Lett. 121, 197202 (2018).
     */
     template <Solver solver>
     class Method_MMF : public Method_Solver<solver>
@@ -27,7 +35,12 @@ namespace Engine
         void Calculate_Force(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<vectorfield> & forces) override;
         
         // Functions for getting the minimum mode of a Hessian
-        void Calculate_Force_Spectra_Matrix(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<vectorfield> & forces);
+        void Calculate_Force_Lanczos(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<vectorfield> & forces);
+        // Lowest eigenmode of the Hessian in the tangent space of a spin configuration, starting from the
+        // given mode, which is overwritten. Returns the eigenvalue.
+        scalar Calculate_Minimum_Mode(int ichain, const vectorfield & image, const vectorfield & gradient, vectorfield & mode);
+        // Product of the Hessian in the tangent space with a tangent vector field
+        void Hessian_Tangent_Product(int ichain, const vectorfield & image, const vectorfield & vectors, vectorfield & product);
         
         // Check if the Forces are converged
         bool Converged() override;
@@ -46,15 +59,23 @@ namespace Engine
         bool Iterations_Allowed() override;
         
         
-        bool switched1, switched2;
         std::shared_ptr<Data::Spin_System_Chain_Collection> collection;
 
-        // Last calculated hessian
-        std::vector<MatrixX> hessian;
         // Last calculated gradient
         std::vector<vectorfield> gradient;
-        // Last calculated minimum mode
+        // Last calculated minimum mode and its eigenvalue
         std::vector<vectorfield> minimum_mode;
+        std::vector<scalar> minimum_eigenvalue;
+
+        // Lanczos iteration: number of steps before a restart, maximum number of restarts and the
+        // tolerance of the residual, relative to the largest Ritz value
+        int lanczos_max_steps;
+        int lanczos_max_restarts;
+        scalar lanczos_tolerance;
+        // Krylov basis, Hessian-vector product and curvature of the unit spheres -(s_i . g_i)
+        std::vector<std::vector<vectorfield>> lanczos_basis;
+        std::vector<vectorfield> lanczos_product;
+        std::vector<scalarfield> lanczos_curvature;
 
         // Last iterations spins and reaction coordinate
         scalar Rx_last;
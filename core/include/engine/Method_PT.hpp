@@ -0,0 +1,72 @@
+#pragma once
+#ifndef METHOD_PT_H
+#define METHOD_PT_H
+
+#include "Spirit_Defines.h"
+#include <engine/Method_MC.hpp>
+#include <data/Spin_System_Chain.hpp>
+
+#include <vector>
+
+namespace Engine
+{
+    /*
+        Parallel tempering (replica exchange Monte Carlo), see K. Hukushima and K. Nemoto,
+        J Phys Soc Jpn 65, 1604 (1996).
+        The images of a chain are the replicas, each at the temperature of its MC parameters.
+        In each iteration the replicas are swept in parallel and then the configurations of neighbouring
+        images are exchanged according to the Metropolis criterion. The iterations and the output
+        are configured by the MC parameters of the first image.
+    */
+    class Method_PT : public Method
+    {
+    public:
+        // Constructor
+        Method_PT(std::shared_ptr<Data::Spin_System_Chain> chain, int idx_chain);
+
+        // Method name as string
+        std::string Name() override;
+
+    private:
+        // One sweep of each replica, followed by exchanges of neighbouring replicas
+        void Iteration() override;
+        // Attempt to exchange the configurations of images i and i+1
+        void Exchange(int i);
+
+        // Save the current Step's Data
+        void Save_Current(std::string starttime, int iteration, bool initial=false, bool final=false) override;
+        // A hook into the Method before an Iteration
+        void Hook_Pre_Iteration() override;
+        // A hook into the Method after an Iteration
+        void Hook_Post_Iteration() override;
+
+        // Sets iteration_allowed to false for the chain
+        void Finalize() override;
+
+        bool Iterations_Allowed() override;
+
+        // Lock systems in order to prevent otherwise access
+        void Lock() override;
+        // Unlock systems to re-enable access
+        void Unlock() override;
+
+        // Log message blocks
+        void Message_Start() override;
+        void Message_Step() override;
+        void Message_End() override;
+
+        // Exchange acceptance ratios of the neighbouring images
+        std::vector<scalar> Exchange_Ratios();
+
+
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // The MC method of each replica
+        std::vector<std::shared_ptr<Method_MC>> replicas;
+        // Energies and norms of the magnetization of the current configurations of the images
+        std::vector<scalar> energies;
+        std::vector<scalar> magnetizations;
+    };
+}
+
+#endif
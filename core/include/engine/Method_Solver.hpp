@@ -13,11 +13,13 @@
 #include <utility/Logging.hpp>
 #include <utility/Constants.hpp>
 
+#include <cmath>
 #include <deque>
 #include <fstream>
 #include <map>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 
 #include <fmt/format.h>
 
@@ -31,7 +33,8 @@ namespace Engine
         Depondt,
         NCG,
         BFGS,
-        VP
+        VP,
+        RK45
     };
 
     /*
@@ -70,6 +73,15 @@ namespace Engine
 
         }
 
+        // Calculate the energies and forces of a set of configurations
+        //      This is overridden by methods whose forces are minus the gradient of an energy, so that a
+        //      solver can use the energies in a line search. Returns false if the forces of the method
+        //      are not such gradients (e.g. the GNEB and MMF forces), in which case nothing is calculated.
+        virtual bool Calculate_Energy_and_Force(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<scalar> & energies, std::vector<vectorfield> & forces)
+        {
+            return false;
+        }
+
         // Calculate virtual Forces onto Systems (can be precession and damping forces, correctly scaled)
         // Calculate the effective force on a configuration. It is a combination of
         //      precession and damping terms for the Hamiltonian, spin currents and
@@ -80,7 +92,7 @@ namespace Engine
             using namespace Utility;
 
             // Calculate the cross product with the spin configuration to get direct minimization
-            for (unsigned int i=0; i<configurations.size(); ++i)
+            this->For_Each_Image(0, configurations.size(), [&](int i)
             {
                 auto& image = *configurations[i];
                 auto& force = forces[i];
@@ -95,7 +107,21 @@ namespace Engine
                 #ifdef SPIRIT_ENABLE_PINNING
                     Vectormath::set_c_a(1, force_virtual, force_virtual, parameters.pinning->mask_unpinned);
                 #endif // SPIRIT_ENABLE_PINNING
-            }
+            });
+        }
+
+        // Call f(i) for the images i in [begin, end)
+        //      If `parallel_images` is set in the parameters, the images are distributed over the
+        //      OpenMP threads and the operations on a single image run on one thread (unless
+        //      nested parallelism is enabled). Since the operations on different images are
+        //      independent and the reductions do not depend on the number of threads, the results
+        //      are the same as for the serial loop.
+        template<typename Function>
+        void For_Each_Image(int begin, int end, Function f)
+        {
+            #pragma omp parallel for schedule(dynamic) if(this->parameters->parallel_images)
+            for (int i = begin; i < end; ++i)
+                f(i);
         }
 
 
@@ -131,7 +157,7 @@ namespace Engine
         std::vector<vectorfield> rotationaxis;
         std::vector<scalarfield> forces_virtual_norm;
         // Preccession angle
-        scalarfield angle;
+        std::vector<scalarfield> angle;
 
         //////////// NCG ////////////////////////////////////////////////////////////
         // Check if the Newton-Raphson has converged
@@ -154,6 +180,8 @@ namespace Engine
         
         // Residual and new configuration states
         std::vector<vectorfield> residual, direction;
+        // Product of the Hessian with the direction
+        std::vector<vectorfield> hessian_direction;
 
         // buffer variables for checking convergence for solver and Newton-Raphson
         std::vector<scalarfield> r_dot_d, dda2;
@@ -172,6 +200,34 @@ namespace Engine
         std::vector<scalar> projection;
         // |force|^2
         std::vector<scalar> force_norm2;
+
+        //////////// BFGS /////////////////////////////////////////////////////////////
+        // Uses direction, rotationaxis and forces_previous from above
+        // Uses configurations_temp from the Method to restart the line search
+        // Number of stored steps, largest RMS rotation of the spins of an image in one step (with
+        // and without a line search) and largest number of step halvings of the line search
+        int lbfgs_memory;
+        scalar lbfgs_max_rotation, lbfgs_max_rotation_forces;
+        int lbfgs_max_backtracks;
+        // Energies of the images, if the method provides them
+        std::vector<scalar> lbfgs_energies;
+        // Ring buffers of the last steps and force differences of all images [memory][noi][nos]
+        std::vector<std::vector<vectorfield>> lbfgs_steps, lbfgs_force_differences;
+        // 1/(step*difference) and the coefficients of the two-loop recursion [memory]
+        scalarfield lbfgs_rho, lbfgs_alpha;
+        // Curvature scale of the initial inverse Hessian
+        scalar lbfgs_gamma;
+        // Number of stored pairs and ring buffer index of the newest step
+        int lbfgs_n_updates, lbfgs_newest;
+
+        //////////// RK45 /////////////////////////////////////////////////////////////
+        // Uses forces_predictor and configurations_predictor from the Method
+        // Derivatives of the spins of the seven stages [7][noi][nos]
+        std::vector<std::vector<vectorfield>> rk_stages;
+        // Step size for the next step and size of the last accepted step [ps]
+        scalar rk_dt, rk_dt_taken;
+        // Whether the last stage of the previous step can be reused as the first stage
+        bool rk_fsal;
     };
 
 
@@ -310,6 +366,8 @@ namespace Engine
     #include <engine/Solver_Heun.hpp>
     #include <engine/Solver_Depondt.hpp>
     #include <engine/Solver_NCG.hpp>
+    #include <engine/Solver_BFGS.hpp>
+    #include <engine/Solver_RK45.hpp>
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+
+#include "Spirit_Defines.h"
+
+namespace Engine
+{
+    namespace Random
+    {
+        /*
+            Counter-based pseudo random number generator Philox4x32-10
+            (J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+            The random numbers are a pure function of the seed and a counter (draw, index),
+            so they can be generated in parallel and in any order. Using e.g. the iteration
+            as draw and the spin index as index, the results do not depend on the number of threads.
+        */
+        class Philox
+        {
+        public:
+            Philox(std::uint64_t seed = 0) :
+                draw(0), key{{ std::uint32_t(seed), std::uint32_t(seed >> 32) }}
+            {
+            }
+
+            // 128 random bits for a counter
+            std::array<std::uint32_t,4> Bits(std::uint64_t draw, std::uint64_t index) const
+            {
+                std::array<std::uint32_t,4> ctr{{ std::uint32_t(index), std::uint32_t(index >> 32),
+                                                  std::uint32_t(draw),  std::uint32_t(draw >> 32) }};
+                std::array<std::uint32_t,2> k = key;
+                for (int round = 0; round < 10; ++round)
+                {
+                    if (round > 0)
+                    {
+                        k[0] += 0x9E3779B9;
+                        k[1] += 0xBB67AE85;
+                    }
+                    std::uint64_t p0 = std::uint64_t(0xD2511F53) * ctr[0];
+                    std::uint64_t p1 = std::uint64_t(0xCD9E8D57) * ctr[2];
+                    ctr = {{ std::uint32_t(p1 >> 32) ^ ctr[1] ^ k[0], std::uint32_t(p1),
+                             std::uint32_t(p0 >> 32) ^ ctr[3] ^ k[1], std::uint32_t(p0) }};
+                }
+                return ctr;
+            }
+
+            // Two uniform random numbers in [0,1) for a counter
+            std::array<scalar,2> Uniform(std::uint64_t draw, std::uint64_t index) const
+            {
+                auto bits = this->Bits(draw, index);
+                return {{ To_Uniform(bits[0], bits[1]), To_Uniform(bits[2], bits[3]) }};
+            }
+
+            // The number of draws made so far. Users of a generator increment it after
+            // each draw, so that subsequent draws yield new random numbers.
+            std::uint64_t draw;
+
+        private:
+            std::array<std::uint32_t,2> key;
+
+            // Map 64 random bits onto [0,1), using as many bits as the mantissa of scalar holds
+            static scalar To_Uniform(std::uint32_t hi, std::uint32_t lo)
+            {
+                const int digits = std::numeric_limits<scalar>::digits;
+                std::uint64_t bits = (std::uint64_t(hi) << 32) | lo;
+                return scalar(bits >> (64 - digits)) * std::ldexp(scalar(1), -digits);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,250 @@
+template <> inline
+void Method_Solver<Solver::BFGS>::Initialize ()
+{
+    this->lbfgs_memory              = 10;                           // number of stored steps
+    this->lbfgs_max_rotation        = Utility::Constants::Pi / 20;  // largest RMS rotation of the spins of an image in one step
+    this->lbfgs_max_rotation_forces = Utility::Constants::Pi / 100; // the same, if there is no line search to control the step
+    this->lbfgs_max_backtracks      = 10;                           // largest number of step halvings of the line search
+
+    this->forces         = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+    this->forces_virtual = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+
+    this->direction       = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+    this->rotationaxis    = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+    this->forces_previous = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+    this->lbfgs_energies  = std::vector<scalar>( this->noi, 0 );
+
+    this->configurations_temp = std::vector<std::shared_ptr<vectorfield>>( this->noi );
+    for (int i=0; i<this->noi; i++)
+        configurations_temp[i] = std::shared_ptr<vectorfield>(new vectorfield(this->nos));
+
+    this->lbfgs_steps             = std::vector<std::vector<vectorfield>>( this->lbfgs_memory,
+                                        std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) ) );
+    this->lbfgs_force_differences = this->lbfgs_steps;
+    this->lbfgs_rho       = scalarfield( this->lbfgs_memory, 0 );
+    this->lbfgs_alpha     = scalarfield( this->lbfgs_memory, 0 );
+    this->lbfgs_gamma     = 0;
+    this->lbfgs_n_updates = 0;
+    this->lbfgs_newest    = -1;
+};
+
+
+/*
+    Template instantiation of the Simulation class for use with the (L-)BFGS Solver.
+        The limited-memory BFGS method approximates the inverse Hessian from the last few
+        steps and force differences, which makes it converge much faster than the dynamics
+        based solvers close to a minimum. It works on the product of spheres: the stored
+        vectors are transported into the current tangent space by projection and the spins
+        are moved by rotations. The images are treated as one system, as their forces are
+        coupled e.g. by the GNEB springs. The RMS rotation angle of the spins of an image
+        in a single step is limited. If the forces are minus the gradient of an energy (LLG),
+        the step is in addition shortened by a backtracking line search until it decreases the
+        energy sufficiently (Armijo condition). This needs no extra evaluations when the full step
+        is accepted, as the energy is calculated together with the gradient. The GNEB and MMF forces
+        are not gradients of an energy, so for them a smaller rotation limit is used and the stored
+        steps are discarded whenever the forces grow.
+    Paper: J. Nocedal, Updating quasi-Newton matrices with limited storage,
+           Math. Comp. 35, 773 (1980).
+           A. V. Ivanov et al., Fast and robust algorithm for energy minimization of spin systems
+           applied in an analysis of high temperature spin configurations in terms of skyrmion
+           density, Comp. Phys. Comm. 260, 107749 (2021).
+*/
+template <> inline
+void Method_Solver<Solver::BFGS>::Iteration ()
+{
+    const int memory = this->lbfgs_memory;
+    auto& steps       = this->lbfgs_steps;
+    auto& differences = this->lbfgs_force_differences;
+    auto& rho         = this->lbfgs_rho;
+    auto& alpha       = this->lbfgs_alpha;
+    auto& gamma       = this->lbfgs_gamma;
+    auto& n_updates   = this->lbfgs_n_updates;
+    auto& newest      = this->lbfgs_newest;
+
+    // Scalar product over all images (the images are added up in order)
+    scalarfield image_dots(this->noi, 0);
+    auto dot = [&](const std::vector<vectorfield> & a, const std::vector<vectorfield> & b)
+    {
+        this->For_Each_Image(0, this->noi, [&](int img)
+        {
+            image_dots[img] = Vectormath::dot(a[img], b[img]);
+        });
+        scalar result = 0;
+        for (int img = 0; img < this->noi; ++img)
+            result += image_dots[img];
+        return result;
+    };
+
+    // Get the forces on the configurations (the virtual forces are used to check the convergence)
+    bool line_search = this->Calculate_Energy_and_Force(this->configurations, this->lbfgs_energies, this->forces);
+    if (!line_search)
+        this->Calculate_Force(this->configurations, this->forces);
+    this->Calculate_Force_Virtual(this->configurations, this->forces, this->forces_virtual);
+    this->For_Each_Image(0, this->noi, [&](int img)
+    {
+        Manifoldmath::project_tangential(this->forces[img], *this->configurations[img]);
+    });
+
+    // Complete the pair of the last step with the change of the force and transport
+    // all stored pairs into the tangent space of the current configurations
+    if (newest >= 0)
+    {
+        this->For_Each_Image(0, this->noi, [&](int img)
+        {
+            Manifoldmath::project_tangential(this->forces_previous[img], *this->configurations[img]);
+            Vectormath::set_c_a( 1, this->forces_previous[img], differences[newest][img]);
+            Vectormath::add_c_a(-1, this->forces[img], differences[newest][img]);
+            Manifoldmath::project_tangential(steps[newest][img], *this->configurations[img]);
+        });
+
+        // Without positive curvature along the step the update would not be positive definite,
+        // so the pair is skipped and its slot is reused by the next step
+        scalar sy = dot(steps[newest], differences[newest]);
+        bool accepted = sy > 0;
+        if (accepted)
+        {
+            rho[newest] = 1 / sy;
+            n_updates = std::min(n_updates + 1, memory);
+        }
+        else
+        {
+            newest = (newest - 1 + memory) % memory;
+            n_updates = std::min(n_updates, memory - 1);
+        }
+
+        // Older pairs which lose their positive curvature through the transport are dropped
+        for (int k = accepted ? 1 : 0; k < n_updates; ++k)
+        {
+            int idx = (newest - k + memory) % memory;
+            this->For_Each_Image(0, this->noi, [&](int img)
+            {
+                Manifoldmath::project_tangential(steps[idx][img], *this->configurations[img]);
+                Manifoldmath::project_tangential(differences[idx][img], *this->configurations[img]);
+            });
+            sy = dot(steps[idx], differences[idx]);
+            if (sy <= 0)
+            {
+                n_updates = k;
+                break;
+            }
+            rho[idx] = 1 / sy;
+        }
+
+        // Without an energy, a growing force shows that the stored pairs do not describe the forces
+        // (which are not a gradient, e.g. for a climbing image or after the MMF mode changed), so
+        // they are discarded and the next step is taken along the force
+        if (!line_search && dot(this->forces, this->forces) > dot(this->forces_previous, this->forces_previous))
+            n_updates = 0;
+    }
+
+    // Two-loop recursion for the product of the inverse Hessian with the gradient
+    for (int img = 0; img < this->noi; ++img)
+        Vectormath::set_c_a(-1, this->forces[img], this->direction[img]);
+    for (int k = 0; k < n_updates; ++k)
+    {
+        int idx = (newest - k + memory) % memory;
+        alpha[idx] = rho[idx] * dot(steps[idx], this->direction);
+        for (int img = 0; img < this->noi; ++img)
+            Vectormath::add_c_a(-alpha[idx], differences[idx][img], this->direction[img]);
+    }
+    if (n_updates > 0)
+    {
+        gamma = 1 / (rho[newest] * dot(differences[newest], differences[newest]));
+        for (int img = 0; img < this->noi; ++img)
+            Vectormath::scale(this->direction[img], gamma);
+    }
+    for (int k = n_updates - 1; k >= 0; --k)
+    {
+        int idx = (newest - k + memory) % memory;
+        scalar beta = rho[idx] * dot(differences[idx], this->direction);
+        for (int img = 0; img < this->noi; ++img)
+            Vectormath::add_c_a(alpha[idx] - beta, steps[idx][img], this->direction[img]);
+    }
+
+    // Restart along the force if there is no history or the direction does not point downhill
+    bool restart = n_updates == 0 || dot(this->direction, this->forces) >= 0;
+    scalar scale = -1;
+    if (restart)
+    {
+        n_updates = 0;
+        for (int img = 0; img < this->noi; ++img)
+            Vectormath::set_c_a(1, this->forces[img], this->direction[img]);
+        scale = gamma > 0 ? gamma : 1;
+    }
+
+    // Limit the RMS rotation of the spins of each image. A restart uses the last known
+    // curvature scale or, before there is one, the unit inverse Hessian, so that the
+    // first step from an (almost) converged configuration stays small.
+    this->For_Each_Image(0, this->noi, [&](int img)
+    {
+        image_dots[img] = Vectormath::dot(this->direction[img], this->direction[img]);
+    });
+    scalar rms_rotation = 0;
+    for (int img = 0; img < this->noi; ++img)
+        rms_rotation = std::max(rms_rotation, std::sqrt(image_dots[img] / this->nos));
+    if (rms_rotation == 0) return;
+    scalar max_rotation = line_search ? this->lbfgs_max_rotation : this->lbfgs_max_rotation_forces;
+    if (std::abs(scale) * rms_rotation > max_rotation)
+        scale = std::copysign(max_rotation / rms_rotation, scale);
+
+    // Store the step, the pair is completed in the next iteration
+    newest = (newest + 1) % memory;
+    this->For_Each_Image(0, this->noi, [&](int img)
+    {
+        Vectormath::set_c_a(scale, this->direction[img], steps[newest][img]);
+        Vectormath::set_c_a(1, this->forces[img], this->forces_previous[img]);
+    });
+
+    // Rotate the spins of the images along a step
+    auto rotate = [&](const std::vector<std::shared_ptr<vectorfield>> & start)
+    {
+        this->For_Each_Image(0, this->noi, [&](int img)
+        {
+            Vectormath::cross(*start[img], steps[newest][img], this->rotationaxis[img]);
+            Vectormath::transform(*start[img], this->rotationaxis[img], *this->configurations[img]);
+        });
+    };
+    if (!line_search)
+    {
+        rotate(this->configurations);
+        return;
+    }
+
+    // Backtracking line search: the step is halved until the energy decreases at least by a small
+    // fraction of the decrease predicted by the slope. The last trial is accepted in any case, so the
+    // energies and forces calculated last belong to the new spins and are re-used in the next iteration.
+    // Differences of the energy below its rounding errors are not resolved and are accepted.
+    const scalar c1 = 1e-4;
+    scalar energy = 0;
+    for (int img = 0; img < this->noi; ++img)
+        energy += this->lbfgs_energies[img];
+    scalar tolerance = 10 * std::numeric_limits<scalar>::epsilon() * std::abs(energy);
+    scalar decrease = dot(this->forces_previous, steps[newest]);
+    for (int img = 0; img < this->noi; ++img)
+        Vectormath::set_c_a(1, *this->configurations[img], *this->configurations_temp[img]);
+    for (int n_backtracks = 0; ; ++n_backtracks)
+    {
+        rotate(this->configurations_temp);
+        this->Calculate_Energy_and_Force(this->configurations, this->lbfgs_energies, this->forces);
+        scalar energy_new = 0;
+        for (int img = 0; img < this->noi; ++img)
+            energy_new += this->lbfgs_energies[img];
+        if (energy_new <= energy - c1 * decrease + tolerance || n_backtracks == this->lbfgs_max_backtracks)
+            break;
+        for (int img = 0; img < this->noi; ++img)
+            Vectormath::scale(steps[newest][img], 0.5);
+        decrease *= 0.5;
+    }
+};
+
+template <> inline
+std::string Method_Solver<Solver::BFGS>::SolverName()
+{
+    return "BFGS";
+};
+
+template <> inline
+std::string Method_Solver<Solver::BFGS>::SolverFullName()
+{
+    return "Limited-memory BFGS";
+};
@@ -8,14 +8,12 @@ void Method_Solver<Solver::Depondt>::Initialize ()
     this->forces_virtual_predictor = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
 
     this->rotationaxis = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
-    this->angle = scalarfield( this->nos, 0 );
+    this->angle = std::vector<scalarfield>( this->noi, scalarfield( this->nos, 0 ) );
     this->forces_virtual_norm = std::vector<scalarfield>( this->noi, scalarfield( this->nos, 0 ) );
     
     this->configurations_predictor = std::vector<std::shared_ptr<vectorfield>>( this->noi );
     for (int i=0; i<this->noi; i++)
         configurations_predictor[i] = std::shared_ptr<vectorfield>( new vectorfield( this->nos, {0, 0, 0} ) );
-
-    this->temp1 = vectorfield( this->nos, {0, 0, 0} );
 };
 
 
@@ -34,43 +32,44 @@ void Method_Solver<Solver::Depondt>::Iteration ()
     this->Calculate_Force_Virtual(this->configurations, this->forces, this->forces_virtual);
     
     // Predictor for each image
-    for (int i = 0; i < this->noi; ++i)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& conf           = *this->configurations[i];
         auto& conf_predictor = *this->configurations_predictor[i];
 
         // For Rotation matrix R := R( H_normed, angle )
-        Vectormath::norm( forces_virtual[i], angle );   // angle = |forces_virtual|
+        Vectormath::norm( forces_virtual[i], angle[i] );   // angle = |forces_virtual|
 
         Vectormath::set_c_a( 1, forces_virtual[i], rotationaxis[i] );  // rotationaxis = |forces_virtual|
         Vectormath::normalize_vectors( rotationaxis[i] );            // normalize rotation axis 
         
         // Get spin predictor n' = R(H) * n
-        Vectormath::rotate( conf, rotationaxis[i], angle, conf_predictor );  
-    }
+        Vectormath::rotate( conf, rotationaxis[i], angle[i], conf_predictor );  
+    });
     
     // Calculate_Force for the Corrector
     this->Calculate_Force(this->configurations_predictor, this->forces_predictor);
     this->Calculate_Force_Virtual(this->configurations_predictor, this->forces_predictor, this->forces_virtual_predictor);
     
     // Corrector step for each image
-    for (int i=0; i < this->noi; i++)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& conf   = *this->configurations[i];
+        auto& axis   = rotationaxis[i];
 
         // Calculate the linear combination of the two forces_virtuals
-        Vectormath::set_c_a( 0.5, forces_virtual[i], temp1);   // H = H/2
-        Vectormath::add_c_a( 0.5, forces_virtual_predictor[i], temp1 ); // H = (H + H')/2
+        Vectormath::set_c_a( 0.5, forces_virtual[i], axis );   // H = H/2
+        Vectormath::add_c_a( 0.5, forces_virtual_predictor[i], axis ); // H = (H + H')/2
         
-        // Get the rotation angle as norm of temp1 ...For Rotation matrix R' := R( H'_normed, angle' )
-        Vectormath::norm( temp1, angle );   // angle' = |forces_virtual lin combination|
+        // Get the rotation angle as norm of the combination ...For Rotation matrix R' := R( H'_normed, angle' )
+        Vectormath::norm( axis, angle[i] );   // angle' = |forces_virtual lin combination|
         
-        // Normalize temp1 to get rotation axes
-        Vectormath::normalize_vectors( temp1 );
+        // Normalize to get rotation axes
+        Vectormath::normalize_vectors( axis );
         
         // Get new spin conf n_new = R( (H+H')/2 ) * n
-        Vectormath::rotate( conf, temp1, angle, conf );  
-    }
+        Vectormath::rotate( conf, axis, angle[i], conf );  
+    });
 };
 
 template <> inline
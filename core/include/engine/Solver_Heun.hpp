@@ -14,8 +14,6 @@ void Method_Solver<Solver::Heun>::Initialize ()
     this->configurations_predictor = std::vector<std::shared_ptr<vectorfield>>( this->noi );
     for (int i=0; i<this->noi; i++)
       configurations_predictor[i] = std::shared_ptr<vectorfield>(new vectorfield(this->nos));  
-    
-    this->temp1 = vectorfield( this->nos, {0, 0, 0} );
 };
 
 
@@ -35,7 +33,7 @@ void Method_Solver<Solver::Heun>::Iteration ()
     this->Calculate_Force_Virtual(this->configurations, this->forces, this->forces_virtual);
     
     // Predictor for each image
-    for (int i = 0; i < this->noi; ++i)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& conf           = *this->configurations[i];
         auto& conf_temp      = *this->configurations_temp[i];
@@ -48,14 +46,14 @@ void Method_Solver<Solver::Heun>::Iteration ()
         
         // Normalize spins
         Vectormath::normalize_vectors( conf_predictor );
-    }
+    });
     
     // Calculate_Force for the Corrector
     this->Calculate_Force(this->configurations_predictor, this->forces_predictor);
     this->Calculate_Force_Virtual(this->configurations_predictor, this->forces_predictor, this->forces_virtual_predictor);
     
     // Corrector step for each image
-    for (int i=0; i < this->noi; i++)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& conf           = *this->configurations[i];
         auto& conf_temp      = *this->configurations_temp[i];
@@ -64,15 +62,14 @@ void Method_Solver<Solver::Heun>::Iteration ()
         // Second step - Corrector
         Vectormath::scale( conf_temp, 0.5 );                                     // configurations_temp = 0.5 * configurations_temp
         Vectormath::add_c_a( 1, conf, conf_temp );                               // configurations_temp = conf + 0.5 * configurations_temp 
-        Vectormath::set_c_cross( -1, conf_predictor, forces_virtual_predictor[i], temp1 );   // temp1 = - ( conf' x A' )
-        Vectormath::add_c_a( 0.5, temp1, conf_temp );                            // configurations_temp = conf + 0.5 * configurations_temp + 0.5 * temp1        
+        Vectormath::add_c_cross( -0.5, conf_predictor, forces_virtual_predictor[i], conf_temp ); // configurations_temp = conf + 0.5 * configurations_temp - 0.5 * ( conf' x A' )
 
         // Normalize spins
         Vectormath::normalize_vectors( conf_temp );
         
         // Copy out
         conf = conf_temp;
-    } 
+    });
 };
 
 template <> inline
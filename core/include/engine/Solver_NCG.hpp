@@ -20,6 +20,7 @@ void Method_Solver<Solver::NCG>::Initialize ()
     
     this->residual  = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
     this->direction = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
+    this->hessian_direction = std::vector<vectorfield>( this->noi, vectorfield( this->nos, { 0, 0, 0 } ) );
     
     this->r_dot_d = std::vector<scalarfield>( this->noi, scalarfield( this->nos, 0 ) );
     this->dda2    = std::vector<scalarfield>( this->noi, scalarfield( this->nos, 0 ) );
@@ -61,8 +62,10 @@ void Method_Solver<Solver::NCG>::Iteration ()
     this->restart_nCG = false;
     
     // Calculate delta_d
-    for (int img=0; img<this->noi; img++)
+    this->For_Each_Image(0, this->noi, [&](int img)
+    {
         Engine::Vectormath::dot( this->direction[img], this->direction[img], this->delta_d[img] );
+    });
     
     // Perform a Newton-Raphson line search in order to determine the minimum along d  
     for( int j=0; j<jmax && continue_NR; j++ )
@@ -71,19 +74,18 @@ void Method_Solver<Solver::NCG>::Iteration ()
         this->Calculate_Force(this->configurations, this->forces);
 
 		// Do line search per image
+        //      The images are visited in order, as the line search stops at the first converged image
         for (int img = 0; img < this->noi; img++)
         {
             // Project force into the tangent space of the spin configuration
             Manifoldmath::project_tangential(this->forces[img], *this->configurations[img]);
 
-            // Calculate Hessian
-            auto hessian = MatrixX(3 * this->nos, 3 * this->nos);
-            this->systems[img]->hamiltonian->Hessian(*this->configurations[img], hessian);
+            // Calculate the product of the Hessian with the direction
+            this->systems[img]->hamiltonian->Hessian_Vector_Product(*this->configurations[img], this->direction[img], this->hessian_direction[img]);
 
             // Calculate alpha (NR step length)
-            // alpha = - (f'*d)/(d*f''*d)	// TODO: How to get the second derivative from here??
-            Eigen::Ref<VectorX> direction_ref = Eigen::Map<VectorX>(this->direction[img][0].data(), this->nos);
-            scalar denominator = direction_ref.dot( hessian * direction_ref );
+            // alpha = - (f'*d)/(d*f''*d), where f''*d is the Hessian-vector product
+            scalar denominator = Engine::Vectormath::dot(this->direction[img], this->hessian_direction[img]);
             scalar numerator = Engine::Vectormath::dot(this->forces[img], this->direction[img]); // / ppp;
             scalar ratio = 1;
             if (std::abs(denominator) > 0)
@@ -116,7 +118,7 @@ void Method_Solver<Solver::NCG>::Iteration ()
     this->Calculate_Force( this->configurations, this->forces );
     
     // Update the direction
-    for (int img=0; img<this->noi; img++)
+    this->For_Each_Image(0, this->noi, [&](int img)
     {
         // Project force into the tangent space of the spin configuration
         Manifoldmath::project_tangential(this->forces[img], *this->configurations[img]);
@@ -136,7 +138,7 @@ void Method_Solver<Solver::NCG>::Iteration ()
         // direction = residual + beta*direction
         Engine::Vectormath::set_c_a( this->beta[img], this->direction[img], this->direction[img] ); // direction = beta*direction
         Engine::Vectormath::add_c_a( 1, this->residual[img], this->direction[img] );                // direction += residual
-    }
+    });
 
     // Restart if direction is not a descent direction or after nos iterations
     //    The latter improves convergence for small nos
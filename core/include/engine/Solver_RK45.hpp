@@ -0,0 +1,177 @@
+template <> inline
+void Method_Solver<Solver::RK45>::Initialize ()
+{
+    this->forces         = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
+    this->forces_virtual = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
+
+    this->forces_predictor         = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
+    this->forces_virtual_predictor = std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) );
+
+    this->configurations_predictor = std::vector<std::shared_ptr<vectorfield>>( this->noi );
+    for (int i=0; i<this->noi; i++)
+      configurations_predictor[i] = std::shared_ptr<vectorfield>(new vectorfield(this->nos));
+
+    // The local error estimates
+    this->configurations_temp = std::vector<std::shared_ptr<vectorfield>>( this->noi );
+    for (int i=0; i<this->noi; i++)
+      configurations_temp[i] = std::shared_ptr<vectorfield>(new vectorfield(this->nos));
+
+    this->rk_stages = std::vector<std::vector<vectorfield>>( 7, std::vector<vectorfield>( this->noi, vectorfield( this->nos, {0, 0, 0} ) ) );
+
+    // Start with the fixed time step, the step size is then adapted to the error estimates
+    this->rk_dt       = this->systems[0]->llg_parameters->dt;
+    this->rk_dt_taken = 0;
+    this->rk_fsal     = false;
+};
+
+
+/*
+    Template instantiation of the Simulation class for use with the RK45 Solver.
+        The Dormand-Prince method is an embedded Runge-Kutta method of fifth order, which
+        uses the difference to a fourth order solution of the same stages as an estimate
+        of the local error. The step size is adapted s.t. the largest error of a spin
+        direction in a step stays below the tolerance `rk_tolerance` of the LLG parameters,
+        so that large steps are taken where the dynamics is slow. Close to an equilibrium
+        the step size is eventually limited by the stability of the explicit method, and
+        the remaining torque is of the order of the tolerance. The configurations of
+        the stages are projected onto the unit sphere. The last stage is evaluated at the
+        new configuration, so it is reused as the first stage of the following step.
+        With a temperature the step size is kept at dt, as the error estimate would be
+        dominated by the stochastic term. If the error is not finite, or the tolerance is
+        not reached within a number of rejections or above a minimum step size, the step
+        is discarded and the iteration is stopped with an error.
+    Paper: J. R. Dormand and P. J. Prince, A family of embedded Runge-Kutta formulae,
+           J. Comput. Appl. Math. 6, 19 (1980).
+*/
+template <> inline
+void Method_Solver<Solver::RK45>::Iteration ()
+{
+    // Butcher tableau: the coefficients of the stages, the fifth order weights b (which are
+    // the coefficients of the last stage) and the differences e to the fourth order weights
+    static const scalar a[6][6] = {
+        { 1.0/5 },
+        { 3.0/40,       9.0/40 },
+        { 44.0/45,      -56.0/15,      32.0/9 },
+        { 19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729 },
+        { 9017.0/3168,  -355.0/33,     46732.0/5247, 49.0/176,  -5103.0/18656 },
+        { 35.0/384,     0,             500.0/1113,   125.0/192, -2187.0/6784,   11.0/84 } };
+    static const scalar e[7] = { 71.0/57600, 0, -71.0/16695, 71.0/1920, -17253.0/339200, 22.0/525, -1.0/40 };
+    // Limits of the step size control, beyond which the integration is aborted
+    static const int    max_rejections = 50;
+    static const scalar min_h_dt       = 1e-8;
+
+    auto& parameters = *this->systems[0]->llg_parameters;
+    bool adaptive = parameters.temperature == 0 && parameters.temperature_gradient_inclination == 0;
+
+    // The derivative of the spins per time step dt at the current configurations. It is known
+    // from the last stage of the previous step, unless the configurations were changed since.
+    bool reuse_stage = adaptive && this->rk_fsal;
+    for (int img = 0; img < this->noi; ++img)
+        reuse_stage = reuse_stage && *this->configurations[img] == *this->configurations_predictor[img];
+    if (!reuse_stage)
+    {
+        this->Calculate_Force(this->configurations, this->forces);
+        this->Calculate_Force_Virtual(this->configurations, this->forces, this->forces_virtual);
+        this->For_Each_Image(0, this->noi, [&](int img)
+        {
+            Vectormath::set_c_cross( -1, *this->configurations[img], forces_virtual[img], this->rk_stages[0][img] );
+        });
+    }
+
+    scalar h = adaptive ? this->rk_dt : parameters.dt;
+    int n_rejections = 0;
+    while (true)
+    {
+        scalar h_dt = h / parameters.dt;
+
+        // Stages
+        for (int stage = 1; stage < 7; ++stage)
+        {
+            this->For_Each_Image(0, this->noi, [&](int img)
+            {
+                auto& conf_stage = *this->configurations_predictor[img];
+                Vectormath::set_c_a( 1, *this->configurations[img], conf_stage );
+                for (int j = 0; j < stage; ++j)
+                    if (a[stage-1][j] != 0)
+                        Vectormath::add_c_a( h_dt * a[stage-1][j], this->rk_stages[j][img], conf_stage );
+
+                // Project onto the unit sphere
+                Vectormath::normalize_vectors( conf_stage );
+            });
+            this->Calculate_Force(this->configurations_predictor, this->forces_predictor);
+            this->Calculate_Force_Virtual(this->configurations_predictor, this->forces_predictor, this->forces_virtual_predictor);
+            this->For_Each_Image(0, this->noi, [&](int img)
+            {
+                Vectormath::set_c_cross( -1, *this->configurations_predictor[img], forces_virtual_predictor[img], this->rk_stages[stage][img] );
+            });
+        }
+
+        if (!adaptive)
+            break;
+
+        // Largest error of a spin direction
+        std::vector<scalar> image_errors( this->noi, 0 );
+        this->For_Each_Image(0, this->noi, [&](int img)
+        {
+            auto& error_estimate = *this->configurations_temp[img];
+            Vectormath::fill( error_estimate, {0, 0, 0} );
+            for (int j = 0; j < 7; ++j)
+                if (e[j] != 0)
+                    Vectormath::add_c_a( h_dt * e[j], this->rk_stages[j][img], error_estimate );
+            image_errors[img] = Vectormath::max_abs_component( error_estimate );
+        });
+        scalar error = *std::max_element( image_errors.begin(), image_errors.end() );
+
+        // A non-finite error would be rejected forever, and a step size that keeps shrinking means
+        // that the tolerance cannot be reached, so the step is discarded and the iteration stopped
+        if( !std::isfinite(error) || n_rejections >= max_rejections || h < min_h_dt * parameters.dt )
+        {
+            Log( Utility::Log_Level::Error, Utility::Log_Sender::LLG,
+                fmt::format( "RK45: no step with an error below the tolerance {} found (error {} at dt = {} after {} rejected steps), stopping",
+                    parameters.rk_tolerance, error, h, n_rejections ), this->idx_image, this->idx_chain );
+            this->systems[0]->iteration_allowed = false;
+            this->rk_dt       = parameters.dt;
+            this->rk_dt_taken = 0;
+            this->rk_fsal     = false;
+            return;
+        }
+
+        // Adapt the step size, by at most a factor of 5 up and down
+        scalar factor = 5;
+        if (error > 0)
+            factor = std::min( scalar(5), std::max( scalar(0.2), scalar(0.9) * std::pow( parameters.rk_tolerance / error, scalar(0.2) ) ) );
+
+        if (error <= parameters.rk_tolerance)
+        {
+            this->rk_dt = h * factor;
+            break;
+        }
+        // Reject the step and retry with a smaller one
+        h *= std::min( scalar(0.9), factor );
+        ++n_rejections;
+    }
+
+    // Accept the fifth order solution, which is the configuration of the last stage,
+    // together with its forces
+    this->For_Each_Image(0, this->noi, [&](int img)
+    {
+        Vectormath::set_c_a( 1, *this->configurations_predictor[img], *this->configurations[img] );
+    });
+    std::swap( this->forces, this->forces_predictor );
+    std::swap( this->forces_virtual, this->forces_virtual_predictor );
+    std::swap( this->rk_stages[0], this->rk_stages[6] );
+    this->rk_dt_taken = h;
+    this->rk_fsal     = true;
+};
+
+template <> inline
+std::string Method_Solver<Solver::RK45>::SolverName()
+{
+    return "RK45";
+};
+
+template <> inline
+std::string Method_Solver<Solver::RK45>::SolverFullName()
+{
+    return "Dormand-Prince RK5(4)";
+};
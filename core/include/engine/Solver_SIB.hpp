@@ -25,7 +25,7 @@ void Method_Solver<Solver::SIB>::Iteration ()
     // First part of the step
     this->Calculate_Force(this->configurations, this->forces);
     this->Calculate_Force_Virtual(this->configurations, this->forces, this->forces_virtual);
-    for (int i = 0; i < this->noi; ++i)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& image      = *this->systems[i]->spins;
         auto& image_temp = *this->configurations_predictor[i];
@@ -33,17 +33,17 @@ void Method_Solver<Solver::SIB>::Iteration ()
         Vectormath::transform(image, forces_virtual[i], image_temp);
         Vectormath::add_c_a(1, image, image_temp);
         Vectormath::scale(image_temp, 0.5);
-    }
+    });
 
     // Second part of the step
     this->Calculate_Force(this->configurations_predictor, this->forces_predictor);
     this->Calculate_Force_Virtual(this->configurations_predictor, this->forces_predictor, this->forces_virtual_predictor);
-    for (int i = 0; i < this->noi; ++i)
+    this->For_Each_Image(0, this->noi, [&](int i)
     {
         auto& image      = *this->systems[i]->spins;
         
         Vectormath::transform(image, forces_virtual_predictor[i], image);
-    }
+    });
 };
 
 template <> inline
@@ -31,17 +31,17 @@ void Method_Solver<Solver::VP>::Iteration ()
     scalar force_norm2_full = 0;
 
     // Set previous
-    for (int i = 0; i < noi; ++i)
+    this->For_Each_Image(0, noi, [&](int i)
     {
         Vectormath::set_c_a(1.0, forces[i],   forces_previous[i]);
         Vectormath::set_c_a(1.0, velocities[i], velocities_previous[i]);
-    }
+    });
 
     // Get the forces on the configurations
     this->Calculate_Force(configurations, forces);
     this->Calculate_Force_Virtual(configurations, forces, forces_virtual);
     
-    for (int i = 0; i < noi; ++i)
+    this->For_Each_Image(0, noi, [&](int i)
     {
         auto& velocity      = velocities[i];
         auto& force         = forces[i];
@@ -54,13 +54,13 @@ void Method_Solver<Solver::VP>::Iteration ()
         // Get the projection of the velocity on the force
         projection[i] = Vectormath::dot(velocity, force);
         force_norm2[i] = Vectormath::dot(force, force);
-    }
+    });
     for (int i = 0; i < noi; ++i)
     {
         projection_full += projection[i];
         force_norm2_full += force_norm2[i];
     }
-    for (int i = 0; i < noi; ++i)
+    this->For_Each_Image(0, noi, [&](int i)
     {
         auto& velocity           = velocities[i];
         auto& force              = forces[i];
@@ -90,7 +90,7 @@ void Method_Solver<Solver::VP>::Iteration ()
 
         // Copy out
         Vectormath::set_c_a(1.0, configuration_temp, configuration);
-    }
+    });
 };
 
 template <> inline
@@ -4,12 +4,14 @@
 
 #include <vector>
 #include <memory>
+#include <algorithm>
 
 #include <Eigen/Core>
 
 #include <data/Geometry.hpp>
 #include <data/Spin_System.hpp>
 #include <engine/Vectormath_Defines.hpp>
+#include <engine/Random.hpp>
 
 namespace Engine
 {
@@ -79,6 +81,33 @@ namespace Engine
                     (boundary_conditions[2] || (0 <= dc && dc < n_cells[2])));
         }
 
+        // Sum of term(i) for i in [0, size). The terms are summed in fixed blocks, which are
+        // added up in order, so that the result does not depend on the number of threads
+        // (or on whether the sum is evaluated inside an outer parallel region).
+        // The partial sums are kept on the stack, so the number of blocks is limited and
+        // the block size grows for large sizes. It depends only on the size.
+        template<typename T, typename Term>
+        inline T block_sum(int size, T zero, Term term)
+        {
+            const int max_blocks = 256;
+            const int block = std::max(256, (size + max_blocks - 1) / max_blocks);
+            const int n_blocks = (size + block - 1) / block;
+            T partial[max_blocks];
+            #pragma omp parallel for
+            for (int iblock = 0; iblock < n_blocks; ++iblock)
+            {
+                T s = zero;
+                const int end = std::min(size, (iblock + 1) * block);
+                for (int i = iblock * block; i < end; ++i)
+                    s += term(i);
+                partial[iblock] = s;
+            }
+            T ret = zero;
+            for (int iblock = 0; iblock < n_blocks; ++iblock)
+                ret += partial[iblock];
+            return ret;
+        }
+
         #endif
         #ifdef SPIRIT_USE_CUDA
     
@@ -391,6 +420,11 @@ namespace Engine
         void get_random_vectorfield(std::mt19937 & prng, vectorfield & xi);
         void get_random_vector_unitsphere(std::uniform_real_distribution<scalar> & distribution, std::mt19937 & prng, Vector3 & vec);
         void get_random_vectorfield_unitsphere(std::mt19937 & prng, vectorfield & xi);
+        // Counter-based versions, which draw the vector of spin i from the counter (prng.draw, i) and
+        // increment prng.draw afterwards. They are reproducible for any number of threads.
+        void get_random_vector_unitsphere(const Random::Philox & prng, std::uint64_t draw, std::uint64_t index, Vector3 & vec);
+        void get_random_vectorfield(Random::Philox & prng, vectorfield & xi);
+        void get_random_vectorfield_unitsphere(Random::Philox & prng, vectorfield & xi);
 
         // Calculate a gradient scalar distribution according to a starting value, direction and inclination
         void get_gradient_distribution(const Data::Geometry & geometry, Vector3 gradient_direction, scalar gradient_start, scalar gradient_inclination, scalarfield & distribution, scalar range_min, scalar range_max);
@@ -36,6 +36,11 @@ namespace IO
                                             const std::string filename, bool normalize_nos=true,
                                             bool readability_toggle = true);
 
+    // =========================== Saving MC Observables =====================
+    // Save the thermal averages of the MC samples of a spin system, with their errors and autocorrelation
+    // times, and the specific heat, susceptibility and Binder cumulant
+    void Write_MC_Observables( const Data::Spin_System & system, const std::string filename );
+
     // =========================== Saving Forces ===========================
     // Saves the forces on an image chain
     void Write_System_Force( const Data::Spin_System& s, const std::string filename );
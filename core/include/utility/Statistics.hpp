@@ -0,0 +1,86 @@
+#pragma once
+#ifndef UTILITY_STATISTICS_H
+#define UTILITY_STATISTICS_H
+
+#include "Spirit_Defines.h"
+#include <engine/Vectormath_Defines.hpp>
+
+#include <vector>
+
+namespace Utility
+{
+    /*
+        Running statistics of a correlated time series, e.g. of Monte Carlo samples, with a blocking analysis
+        (H. Flyvbjerg and H. G. Petersen, J Chem Phys 91, 461 (1989)): level k contains the means of consecutive
+        blocks of 2^k samples, of which the mean and the sum of squared deviations are updated as each block is
+        completed. Only a few numbers per level are stored, i.e. the memory grows with the logarithm of the
+        number of samples.
+    */
+    class Blocking_Statistics
+    {
+    public:
+        Blocking_Statistics();
+
+        // Add a sample
+        void Add(scalar x);
+        // Remove all samples
+        void Reset();
+
+        // Number of samples
+        long int N() const;
+        // Mean and (biased) variance <x^2>-<x>^2 of the samples
+        scalar Mean() const;
+        scalar Variance() const;
+        // Integrated autocorrelation time tau = 1/2 + sum_t rho(t) in units of samples, i.e. 1/2 for
+        // uncorrelated samples, estimated from the highest level with at least 32 blocks
+        scalar Autocorrelation_Time() const;
+        // Standard error of the mean, sqrt(2 tau Var(x) / N)
+        scalar Error() const;
+
+    private:
+        struct Level
+        {
+            long int n;
+            scalar mean;
+            scalar sum_squared_deviations;
+            // First half of the next block of the level above
+            bool has_pending;
+            scalar pending;
+        };
+        std::vector<Level> levels;
+
+        // Sample variance of the mean of the blocks of a level
+        scalar Variance_of_Mean(int level) const;
+        // Level from which the autocorrelation time is estimated
+        int Plateau_Level() const;
+    };
+
+    /*
+        Thermal averages of the Monte Carlo samples of the total energy E and of the magnetization m per spin,
+        together with the response functions derived from their fluctuations
+    */
+    struct MC_Observables
+    {
+        // Add a sample
+        void Add(scalar energy, const Vector3 & magnetization);
+        // Remove all samples
+        void Reset();
+
+        // Number of samples
+        long int N() const;
+        // Specific heat per spin (<E^2>-<E>^2)/(N (kB T)^2), i.e. in units of kB (0 at zero temperature)
+        scalar Specific_Heat(scalar temperature, int nos) const;
+        // Susceptibility per spin N(<m^2>-<|m|>^2)/(kB T) in 1/meV (0 at zero temperature)
+        scalar Susceptibility(scalar temperature, int nos) const;
+        // Binder cumulant 1 - <m^4>/(3<m^2>^2)
+        scalar Binder_Cumulant() const;
+
+        Blocking_Statistics energy;
+        Blocking_Statistics magnetization[3];
+        Blocking_Statistics magnetization_abs;
+        Blocking_Statistics magnetization_2;
+        Blocking_Statistics magnetization_4;
+    };
+}
+
+#endif
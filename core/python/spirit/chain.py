@@ -155,4 +155,33 @@ def Get_Energy_Interpolated(p_state, idx_chain=-1):
     len_Energy = noi + (noi-1)*n_interp
     Energy_interp = (len_Energy*ctypes.c_float)()
     _Get_Energy_Interpolated(ctypes.c_void_p(p_state), Energy_interp, ctypes.c_int(idx_chain))
-    return [E for E in Energy_interp]
\ No newline at end of file
+    return [E for E in Energy_interp]
+### Get the exchange acceptance ratios of neighbouring images of the last parallel tempering run
+_Get_PT_Exchange_Ratios          = _spirit.Chain_Get_PT_Exchange_Ratios
+_Get_PT_Exchange_Ratios.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+_Get_PT_Exchange_Ratios.restype  = None
+def Get_PT_Exchange_Ratios(p_state, idx_chain=-1):
+    noi = Get_NOI(p_state, idx_chain)
+    ratios = ((noi-1)*ctypes.c_float)()
+    _Get_PT_Exchange_Ratios(ctypes.c_void_p(p_state), ratios, ctypes.c_int(idx_chain))
+    return [r for r in ratios]
+
+### Get the mean energies at the temperatures of the images of the last parallel tempering run
+_Get_PT_Energy_Mean          = _spirit.Chain_Get_PT_Energy_Mean
+_Get_PT_Energy_Mean.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+_Get_PT_Energy_Mean.restype  = None
+def Get_PT_Energy_Mean(p_state, idx_chain=-1):
+    noi = Get_NOI(p_state, idx_chain)
+    Energy = (noi*ctypes.c_float)()
+    _Get_PT_Energy_Mean(ctypes.c_void_p(p_state), Energy, ctypes.c_int(idx_chain))
+    return [E for E in Energy]
+
+### Get the mean norms of the magnetization at the temperatures of the images of the last parallel tempering run
+_Get_PT_Magnetization_Mean          = _spirit.Chain_Get_PT_Magnetization_Mean
+_Get_PT_Magnetization_Mean.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+_Get_PT_Magnetization_Mean.restype  = None
+def Get_PT_Magnetization_Mean(p_state, idx_chain=-1):
+    noi = Get_NOI(p_state, idx_chain)
+    M = (noi*ctypes.c_float)()
+    _Get_PT_Magnetization_Mean(ctypes.c_void_p(p_state), M, ctypes.c_int(idx_chain))
+    return [m for m in M]
@@ -92,6 +92,14 @@ _Set_GNEB_Image_Type_Automatically.restype     = None
 def setImageTypeAutomatically(p_state, idx_chain=-1):
     _Set_GNEB_Image_Type_Automatically(ctypes.c_void_p(p_state), ctypes.c_int(idx_chain))
 
+### Set GNEB parallel evaluation of the images
+_Set_GNEB_Parallel_Images             = _spirit.Parameters_Set_GNEB_Parallel_Images
+_Set_GNEB_Parallel_Images.argtypes    = [ctypes.c_void_p, ctypes.c_bool, ctypes.c_int]
+_Set_GNEB_Parallel_Images.restype     = None
+def setParallelImages(p_state, parallel_images, idx_chain=-1):
+    _Set_GNEB_Parallel_Images(ctypes.c_void_p(p_state), ctypes.c_bool(parallel_images),
+                              ctypes.c_int(idx_chain))
+
 ### ---------------------------------- Get ----------------------------------
 
 ### Get GNEB N Iterations
@@ -136,4 +144,11 @@ _Get_GNEB_N_Energy_Interpolations             = _spirit.Parameters_Get_GNEB_N_En
 _Get_GNEB_N_Energy_Interpolations.argtypes    = [ctypes.c_void_p, ctypes.c_int]
 _Get_GNEB_N_Energy_Interpolations.restype     = ctypes.c_int
 def getEnergyInterpolations(p_state, idx_chain=-1):
-    return int(_Get_GNEB_N_Energy_Interpolations(ctypes.c_void_p(p_state), ctypes.c_int(idx_chain)))
\ No newline at end of file
+    return int(_Get_GNEB_N_Energy_Interpolations(ctypes.c_void_p(p_state), ctypes.c_int(idx_chain)))
+
+### Get GNEB parallel evaluation of the images
+_Get_GNEB_Parallel_Images             = _spirit.Parameters_Get_GNEB_Parallel_Images
+_Get_GNEB_Parallel_Images.argtypes    = [ctypes.c_void_p, ctypes.c_int]
+_Get_GNEB_Parallel_Images.restype     = ctypes.c_bool
+def getParallelImages(p_state, idx_chain=-1):
+    return bool(_Get_GNEB_Parallel_Images(ctypes.c_void_p(p_state), ctypes.c_int(idx_chain)))
\ No newline at end of file
@@ -72,6 +72,15 @@ def setDirectMinimization(p_state, use_minimization, idx_image=-1, idx_chain=-1)
     _Set_LLG_Direct_Minimization(ctypes.c_void_p(p_state), ctypes.c_bool(use_minimization), 
                                  ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
 
+### Set LLG Energy From Gradient
+_Set_LLG_Energy_From_Gradient           = _spirit.Parameters_Set_LLG_Energy_From_Gradient
+_Set_LLG_Energy_From_Gradient.argtypes  = [ctypes.c_void_p, ctypes.c_bool,
+                                           ctypes.c_int, ctypes.c_int ]
+_Set_LLG_Energy_From_Gradient.restype   = None
+def setEnergyFromGradient(p_state, energy_from_gradient, idx_image=-1, idx_chain=-1):
+    _Set_LLG_Energy_From_Gradient(ctypes.c_void_p(p_state), ctypes.c_bool(energy_from_gradient),
+                                  ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+
 _Set_LLG_Convergence            = _spirit.Parameters_Set_LLG_Convergence
 _Set_LLG_Convergence.argtypes   = [ctypes.c_void_p, ctypes.c_float, ctypes.c_int, ctypes.c_int ]
 _Set_LLG_Convergence.restype    = None
@@ -86,6 +95,14 @@ _Set_LLG_Time_Step.restype     = None
 def setTimeStep(p_state, dt, idx_image=-1, idx_chain=-1):
     _Set_LLG_Time_Step(p_state, ctypes.c_float(dt), idx_image, idx_chain)
 
+### Set LLG RK45 Tolerance
+_Set_LLG_RK_Tolerance          = _spirit.Parameters_Set_LLG_RK_Tolerance
+_Set_LLG_RK_Tolerance.argtypes = [ctypes.c_void_p, ctypes.c_float, ctypes.c_int, ctypes.c_int]
+_Set_LLG_RK_Tolerance.restype  = None
+def setRKTolerance(p_state, tolerance, idx_image=-1, idx_chain=-1):
+    _Set_LLG_RK_Tolerance(ctypes.c_void_p(p_state), ctypes.c_float(tolerance),
+                          ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+
 ### Set LLG Damping
 _Set_LLG_Damping             = _spirit.Parameters_Set_LLG_Damping
 _Set_LLG_Damping.argtypes    = [ctypes.c_void_p, ctypes.c_float, ctypes.c_int, ctypes.c_int]
@@ -147,6 +164,14 @@ def getDirectMinimization(p_state, idx_image=-1, idx_chain=-1):
     return float(_Get_LLG_Direct_Minimization(ctypes.c_void_p(p_state),
                                               ctypes.c_int(idx_image), ctypes.c_int(idx_chain)))
 
+### Get LLG Energy From Gradient
+_Get_LLG_Energy_From_Gradient           = _spirit.Parameters_Get_LLG_Energy_From_Gradient
+_Get_LLG_Energy_From_Gradient.argtypes  = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int ]
+_Get_LLG_Energy_From_Gradient.restype   = ctypes.c_bool
+def getEnergyFromGradient(p_state, idx_image=-1, idx_chain=-1):
+    return bool(_Get_LLG_Energy_From_Gradient(ctypes.c_void_p(p_state),
+                                              ctypes.c_int(idx_image), ctypes.c_int(idx_chain)))
+
 ### Get LLG Convergence
 _Get_LLG_Convergence            = _spirit.Parameters_Get_LLG_Convergence
 _Get_LLG_Convergence.argtypes   = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int ]
@@ -163,6 +188,14 @@ def getTimeStep(p_state, idx_image=-1, idx_chain=-1):
     return float(_Get_LLG_Time_Step(ctypes.c_void_p(p_state), ctypes.c_int(idx_image), 
                                     ctypes.c_int(idx_chain)))
 
+### Get LLG RK45 Tolerance
+_Get_LLG_RK_Tolerance          = _spirit.Parameters_Get_LLG_RK_Tolerance
+_Get_LLG_RK_Tolerance.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Get_LLG_RK_Tolerance.restype  = ctypes.c_float
+def getRKTolerance(p_state, idx_image=-1, idx_chain=-1):
+    return float(_Get_LLG_RK_Tolerance(ctypes.c_void_p(p_state), ctypes.c_int(idx_image),
+                                       ctypes.c_int(idx_chain)))
+
 ### Get LLG Damping
 _Get_LLG_Damping             = _spirit.Parameters_Get_LLG_Damping
 _Get_LLG_Damping.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
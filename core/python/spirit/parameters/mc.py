@@ -78,6 +78,30 @@ _Set_MC_Acceptance_Ratio.restype     = None
 def setAcceptanceRatio(p_state, ratio, idx_image=-1, idx_chain=-1):
     _Set_MC_Acceptance_Ratio(p_state, ctypes.c_float(ratio), idx_image, idx_chain)
 
+### Set whether the local fields should be cached in the Metropolis algorithm
+_Set_MC_Local_Field_Cache             = _spirit.Parameters_Set_MC_Local_Field_Cache
+_Set_MC_Local_Field_Cache.argtypes    = [ctypes.c_void_p, ctypes.c_bool, ctypes.c_int, ctypes.c_int]
+_Set_MC_Local_Field_Cache.restype     = None
+def setLocalFieldCache(p_state, use_cache, idx_image=-1, idx_chain=-1):
+    _Set_MC_Local_Field_Cache(ctypes.c_void_p(p_state), ctypes.c_bool(use_cache),
+                         ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+
+### Set whether the spins of each colour of the interaction graph should be updated in parallel
+_Set_MC_Parallel_Sweep             = _spirit.Parameters_Set_MC_Parallel_Sweep
+_Set_MC_Parallel_Sweep.argtypes    = [ctypes.c_void_p, ctypes.c_bool, ctypes.c_int, ctypes.c_int]
+_Set_MC_Parallel_Sweep.restype     = None
+def setParallelSweep(p_state, parallel_sweep, idx_image=-1, idx_chain=-1):
+    _Set_MC_Parallel_Sweep(ctypes.c_void_p(p_state), ctypes.c_bool(parallel_sweep),
+                         ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+
+### Set the MC algorithm (0: Metropolis, 1: heat bath, 2: Wolff cluster updates)
+_Set_MC_Algorithm             = _spirit.Parameters_Set_MC_Algorithm
+_Set_MC_Algorithm.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.c_int]
+_Set_MC_Algorithm.restype     = None
+def setAlgorithm(p_state, algorithm, idx_image=-1, idx_chain=-1):
+    _Set_MC_Algorithm(ctypes.c_void_p(p_state), ctypes.c_int(algorithm),
+                         ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+
 ## ---------------------------------- Get ----------------------------------
 
 ### Get number of iterations and step size
@@ -106,4 +130,28 @@ _Get_MC_Acceptance_Ratio.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_
 _Get_MC_Acceptance_Ratio.restype     = ctypes.c_float
 def getAcceptanceRatio(p_state, idx_image=-1, idx_chain=-1):
     return float(_Get_MC_Acceptance_Ratio(ctypes.c_void_p(p_state), ctypes.c_int(idx_image),
+                                    ctypes.c_int(idx_chain)))
+
+### Get whether the local fields are cached in the Metropolis algorithm
+_Get_MC_Local_Field_Cache             = _spirit.Parameters_Get_MC_Local_Field_Cache
+_Get_MC_Local_Field_Cache.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Get_MC_Local_Field_Cache.restype     = ctypes.c_bool
+def getLocalFieldCache(p_state, idx_image=-1, idx_chain=-1):
+    return bool(_Get_MC_Local_Field_Cache(ctypes.c_void_p(p_state), ctypes.c_int(idx_image),
+                                    ctypes.c_int(idx_chain)))
+
+### Get whether the spins of each colour of the interaction graph are updated in parallel
+_Get_MC_Parallel_Sweep             = _spirit.Parameters_Get_MC_Parallel_Sweep
+_Get_MC_Parallel_Sweep.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Get_MC_Parallel_Sweep.restype     = ctypes.c_bool
+def getParallelSweep(p_state, idx_image=-1, idx_chain=-1):
+    return bool(_Get_MC_Parallel_Sweep(ctypes.c_void_p(p_state), ctypes.c_int(idx_image),
+                                    ctypes.c_int(idx_chain)))
+
+### Get the MC algorithm
+_Get_MC_Algorithm             = _spirit.Parameters_Get_MC_Algorithm
+_Get_MC_Algorithm.argtypes    = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Get_MC_Algorithm.restype     = ctypes.c_int
+def getAlgorithm(p_state, idx_image=-1, idx_chain=-1):
+    return int(_Get_MC_Algorithm(ctypes.c_void_p(p_state), ctypes.c_int(idx_image),
                                     ctypes.c_int(idx_chain)))
\ No newline at end of file
@@ -19,4 +19,67 @@ _Get_Topological_Charge.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
 _Get_Topological_Charge.restype  = ctypes.c_float
 def Get_Topological_Charge(p_state, idx_image=-1, idx_chain=-1):
     return float(_Get_Topological_Charge(ctypes.c_void_p(p_state),
-                       ctypes.c_int(idx_image), ctypes.c_int(idx_chain)))
\ No newline at end of file
+                       ctypes.c_int(idx_image), ctypes.c_int(idx_chain)))
+
+### ------ Monte Carlo averages ------
+### The MC method takes a sample of the total energy and of the magnetization per spin after each
+### iteration. The samples are accumulated across MC runs, until they are reset.
+
+_Get_MC_N_Samples          = _spirit.Quantity_Get_MC_N_Samples
+_Get_MC_N_Samples.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Get_MC_N_Samples.restype  = ctypes.c_int
+def Get_MC_N_Samples(p_state, idx_image=-1, idx_chain=-1):
+    return int(_Get_MC_N_Samples(ctypes.c_void_p(p_state),
+                       ctypes.c_int(idx_image), ctypes.c_int(idx_chain)))
+
+### Returns the thermal averages <E>, <m> (three components), <|m|>, <m^2> and <m^4>
+_Get_MC_Averages          = _spirit.Quantity_Get_MC_Averages
+_Get_MC_Averages.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                             ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                             ctypes.c_int, ctypes.c_int]
+_Get_MC_Averages.restype  = None
+def Get_MC_Averages(p_state, idx_image=-1, idx_chain=-1):
+    energy = ctypes.c_float()
+    magnetization = (3*ctypes.c_float)()
+    m_abs = ctypes.c_float()
+    m_2 = ctypes.c_float()
+    m_4 = ctypes.c_float()
+    _Get_MC_Averages(ctypes.c_void_p(p_state), ctypes.byref(energy), magnetization,
+                     ctypes.byref(m_abs), ctypes.byref(m_2), ctypes.byref(m_4),
+                     ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+    return float(energy.value), [float(i) for i in magnetization], float(m_abs.value), float(m_2.value), float(m_4.value)
+
+### Returns the specific heat per spin (in units of kB), the susceptibility per spin (in 1/meV) and the Binder cumulant
+_Get_MC_Response          = _spirit.Quantity_Get_MC_Response
+_Get_MC_Response.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                             ctypes.POINTER(ctypes.c_float), ctypes.c_int, ctypes.c_int]
+_Get_MC_Response.restype  = None
+def Get_MC_Response(p_state, idx_image=-1, idx_chain=-1):
+    specific_heat = ctypes.c_float()
+    susceptibility = ctypes.c_float()
+    binder_cumulant = ctypes.c_float()
+    _Get_MC_Response(ctypes.c_void_p(p_state), ctypes.byref(specific_heat), ctypes.byref(susceptibility),
+                     ctypes.byref(binder_cumulant), ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+    return float(specific_heat.value), float(susceptibility.value), float(binder_cumulant.value)
+
+### Returns the integrated autocorrelation times (in iterations) of E and |m| and the standard errors of <E> and <|m|>
+_Get_MC_Autocorrelation          = _spirit.Quantity_Get_MC_Autocorrelation
+_Get_MC_Autocorrelation.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                                    ctypes.POINTER(ctypes.c_float), ctypes.POINTER(ctypes.c_float),
+                                    ctypes.c_int, ctypes.c_int]
+_Get_MC_Autocorrelation.restype  = None
+def Get_MC_Autocorrelation(p_state, idx_image=-1, idx_chain=-1):
+    tau_energy = ctypes.c_float()
+    tau_m_abs = ctypes.c_float()
+    error_energy = ctypes.c_float()
+    error_m_abs = ctypes.c_float()
+    _Get_MC_Autocorrelation(ctypes.c_void_p(p_state), ctypes.byref(tau_energy), ctypes.byref(tau_m_abs),
+                            ctypes.byref(error_energy), ctypes.byref(error_m_abs),
+                            ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
+    return float(tau_energy.value), float(tau_m_abs.value), float(error_energy.value), float(error_m_abs.value)
+
+_Reset_MC_Averages          = _spirit.Quantity_Reset_MC_Averages
+_Reset_MC_Averages.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+_Reset_MC_Averages.restype  = None
+def Reset_MC_Averages(p_state, idx_image=-1, idx_chain=-1):
+    _Reset_MC_Averages(ctypes.c_void_p(p_state), ctypes.c_int(idx_image), ctypes.c_int(idx_chain))
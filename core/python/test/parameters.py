@@ -54,6 +54,12 @@ class LLG_set_get(TestParameters):
         dt_get = parameters.llg.getTimeStep(self.p_state)     # try get
         self.assertAlmostEqual(dt_set, dt_get)
     
+    def test_LLG_rk_tolerance(self):
+        tol_set = 1e-4
+        parameters.llg.setRKTolerance(self.p_state, tol_set)       # try set
+        tol_get = parameters.llg.getRKTolerance(self.p_state)      # try get
+        self.assertAlmostEqual(tol_set, tol_get)
+    
     def test_LLG_damping(self):
         lambda_set = 0.015
         parameters.llg.setDamping(self.p_state, lambda_set)        # try set
@@ -112,6 +118,12 @@ class GNEB_set_get(TestParameters):
         # NOTE: this tests only the wrapping of the function since we cannot know the right value
         E_inter = parameters.gneb.getEnergyInterpolations(self.p_state)
         self.assertTrue(E_inter > 0)
+
+    def test_GNEB_Parallel_Images(self):
+        parameters.gneb.setParallelImages(self.p_state, True)               # try set
+        self.assertTrue(parameters.gneb.getParallelImages(self.p_state))    # try get
+        parameters.gneb.setParallelImages(self.p_state, False)
+        self.assertFalse(parameters.gneb.getParallelImages(self.p_state))
     
 #########
 
@@ -9,6 +9,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+
 int Chain_Get_Index(State * state) noexcept
 {
     try
@@ -638,8 +640,19 @@ void Chain_Get_Energy( State * state, float * Energy, int idx_chain ) noexcept
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
 
+        // The energies are calculated on demand
         for (int i = 0; i < chain->noi; ++i)
         {
+            chain->images[i]->Lock();
+            try
+            {
+                chain->images[i]->UpdateEnergy(false);
+            }
+            catch( ... )
+            {
+                spirit_handle_exception_api(i, idx_chain);
+            }
+            chain->images[i]->Unlock();
             Energy[i] = (float)chain->images[i]->E;
         }
     }
@@ -672,6 +685,79 @@ void Chain_Get_Energy_Interpolated( State * state, float * E_interpolated, int i
     }
 }
 
+void Chain_Get_PT_Exchange_Ratios( State * state, float * ratios, int idx_chain ) noexcept
+{
+    int idx_image = -1;
+    
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        // The chain may have changed since the last run
+        for (int i = 0; i < std::min((int)chain->pt_exchanges_attempted.size(), chain->noi-1); ++i)
+        {
+            if (chain->pt_exchanges_attempted[i] > 0)
+                ratios[i] = (float)chain->pt_exchanges_accepted[i] / (float)chain->pt_exchanges_attempted[i];
+            else
+                ratios[i] = 0;
+        }
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Chain_Get_PT_Energy_Mean( State * state, float * energies, int idx_chain ) noexcept
+{
+    int idx_image = -1;
+    
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        for (int i = 0; i < std::min((int)chain->pt_energy_mean.size(), chain->noi); ++i)
+        {
+            energies[i] = (float)chain->pt_energy_mean[i];
+        }
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Chain_Get_PT_Magnetization_Mean( State * state, float * magnetizations, int idx_chain ) noexcept
+{
+    int idx_image = -1;
+    
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        for (int i = 0; i < std::min((int)chain->pt_magnetization_mean.size(), chain->noi); ++i)
+        {
+            magnetizations[i] = (float)chain->pt_magnetization_mean[i];
+        }
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
 std::vector<std::vector<float>> Chain_Get_Energy_Array_Interpolated( State * state, int idx_chain ) noexcept
 {
     int idx_image = -1;
@@ -726,6 +812,7 @@ void Chain_Update_Data( State * state, int idx_chain ) noexcept
             chain->images[i]->Lock();
             try
             {
+                chain->images[i]->InvalidateObservables();
                 chain->images[i]->UpdateEnergy();
                 if (i > 0) 
                     chain->Rx[i] = chain->Rx[i-1] + 
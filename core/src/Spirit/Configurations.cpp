@@ -149,6 +149,7 @@ void Configuration_From_Clipboard( State *state, const float position[3],
         image->Lock();
         Utility::Configurations::Insert(*image, *state->clipboard_spins, 0, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical,
@@ -204,6 +205,7 @@ bool Configuration_From_Clipboard_Shift( State *state, const float position_init
             image->Lock();
             Utility::Configurations::Insert(*image, *state->clipboard_spins, delta, filter);
             image->llg_parameters->pinning->Apply(*image->spins);
+            image->InvalidateObservables();
             image->Unlock();
 
             auto filterstring = filter_to_string( position_final, r_cut_rectangular, r_cut_cylindrical, 
@@ -250,6 +252,7 @@ void Configuration_Domain( State *state, const float direction[3], const float p
         image->Lock();
         Utility::Configurations::Domain(*image, vdir, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -308,6 +311,7 @@ void Configuration_PlusZ( State *state, const float position[3], const float r_c
         image->Lock();
         Utility::Configurations::Domain(*image, vdir, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
         
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -345,6 +349,7 @@ void Configuration_MinusZ( State *state, const float position[3], const float r_
         image->Lock();
         Utility::Configurations::Domain(*image, vdir, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -381,6 +386,7 @@ void Configuration_Random( State *state, const float position[3], const float r_
         image->Lock();
         Utility::Configurations::Random(*image, filter, external);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -419,6 +425,7 @@ void Configuration_Add_Noise_Temperature( State *state, float temperature, const
         image->Lock();
         Utility::Configurations::Add_Noise_Temperature(*image, temperature, 0, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -458,6 +465,7 @@ void Configuration_Hopfion( State *state, float r, int order, const float positi
         image->Lock();
         Utility::Configurations::Hopfion(*image, vpos, r, order, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -502,6 +510,7 @@ void Configuration_Skyrmion( State *state, float r, float order, float phase, bo
         Utility::Configurations::Skyrmion( *image, vpos, r, order, phase, upDown, achiral, rl,
                                             false, filter );
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
         
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -549,6 +558,7 @@ void Configuration_SpinSpiral( State *state, const char * direction_type, float
         image->Lock();
         Utility::Configurations::SpinSpiral(*image, dir_type, vq, vaxis, theta, filter);
         image->llg_parameters->pinning->Apply(*image->spins);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
@@ -594,6 +604,7 @@ void Configuration_SpinSpiral_2q( State *state, const char * direction_type, flo
         Vector3 vaxis{ axis[0], axis[1], axis[2] };
         image->Lock();
         Utility::Configurations::SpinSpiral(*image, dir_type, vq1, vq2, vaxis, theta, filter);
+        image->InvalidateObservables();
         image->Unlock();
 
         auto filterstring = filter_to_string( position, r_cut_rectangular, r_cut_cylindrical, 
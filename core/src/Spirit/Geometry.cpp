@@ -33,6 +33,8 @@ void Helper_System_Set_Geometry(std::shared_ptr<Data::Spin_System> system, const
     // Heisenberg Hamiltonian
     if (system->hamiltonian->Name() == "Heisenberg")
         std::static_pointer_cast<Engine::Hamiltonian_Heisenberg>(system->hamiltonian)->Update_Interactions();
+
+    system->InvalidateObservables();
 }
 
 void Helper_State_Set_Geometry(State * state, const Data::Geometry & old_geometry, const Data::Geometry & new_geometry)
@@ -35,11 +35,16 @@ void Hamiltonian_Set_Boundary_Conditions(State *state, const bool * periodical,
             image->hamiltonian->boundary_conditions[0] = periodical[0];
             image->hamiltonian->boundary_conditions[1] = periodical[1];
             image->hamiltonian->boundary_conditions[2] = periodical[2];
+
+            // The neighbour tables depend on the boundary conditions
+            if (image->hamiltonian->Name() == "Heisenberg")
+                ((Engine::Hamiltonian_Heisenberg*)image->hamiltonian.get())->Update_Interactions();
         }
         catch( ... )
         {
             spirit_handle_exception_api(idx_image, idx_chain);
         }
+        image->InvalidateObservables();
         image->Unlock();
 
         Log( Utility::Log_Level::Info, Utility::Log_Sender::API,
@@ -70,6 +75,8 @@ void Hamiltonian_Set_mu_s(State *state, float mu_s, int idx_image, int idx_chain
             {
                 auto ham = (Engine::Hamiltonian_Heisenberg*)image->hamiltonian.get();
                 for (auto& m : ham->mu_s) m = mu_s;
+                // The dipole-dipole tables contain the moments
+                ham->Update_Interactions();
                 Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
                     fmt::format("Set mu_s to {}", mu_s), idx_image, idx_chain);
             }
@@ -82,6 +89,7 @@ void Hamiltonian_Set_mu_s(State *state, float mu_s, int idx_image, int idx_chain
             spirit_handle_exception_api(idx_image, idx_chain);
         }
         
+        image->InvalidateObservables();
         image->Unlock();
     }
     catch( ... )
@@ -134,6 +142,8 @@ void Hamiltonian_Set_Field(State *state, float magnitude, const float * normal,
             spirit_handle_exception_api(idx_image, idx_chain);
         }
         
+        image->InvalidateObservables();
+
         // Unlock mutex
         image->Unlock();
     }
@@ -182,8 +192,8 @@ void Hamiltonian_Set_Anisotropy( State *state, float magnitude, const float * no
                 ham->anisotropy_magnitudes = new_magnitudes;
                 ham->anisotropy_normals = new_normals;
 
-                // Update Energies
-                ham->Update_Energy_Contributions();
+                // Update the per-basis table and the energies
+                ham->Update_Interactions();
 
                 Log( Utility::Log_Level::Info, Utility::Log_Sender::API,
                     fmt::format("Set anisotropy to {}, direction ({}, {}, {})", magnitude, normal[0], normal[1], normal[2]),
@@ -198,6 +208,7 @@ void Hamiltonian_Set_Anisotropy( State *state, float magnitude, const float * no
             spirit_handle_exception_api(idx_image, idx_chain);
         }
 
+        image->InvalidateObservables();
         image->Unlock();
     }
     catch( ... )
@@ -242,6 +253,7 @@ void Hamiltonian_Set_Exchange(State *state, int n_shells, const float* jij, int
             spirit_handle_exception_api(idx_image, idx_chain);
         }
                 
+        image->InvalidateObservables();
         image->Unlock();
     }
     catch( ... )
@@ -287,6 +299,7 @@ void Hamiltonian_Set_DMI(State *state, int n_shells, const float * dij, int chir
             spirit_handle_exception_api(idx_image, idx_chain);
         }
 
+        image->InvalidateObservables();
         image->Unlock();
     }
     catch( ... )
@@ -312,23 +325,9 @@ void Hamiltonian_Set_DDI(State *state, float radius, int idx_image, int idx_chai
             {
                 auto ham = (Engine::Hamiltonian_Heisenberg*)image->hamiltonian.get();
 
-                auto pairs = Engine::Neighbours::Get_Pairs_in_Radius(*image->geometry, radius);
-                scalarfield magnitudes(0);
-                vectorfield normals(0);
-                scalar magnitude;
-                Vector3 normal;
-                for (auto& pair : pairs)
-                {
-                    Engine::Neighbours::DDI_from_Pair(*image->geometry, pair, magnitude, normal);
-                    magnitudes.push_back(magnitude);
-                    normals.push_back(normal);
-                }
-                ham->ddi_pairs = pairs;
-                ham->ddi_magnitudes = magnitudes;
-                ham->ddi_normals = normals;
-
-                // Update the list of different contributions
-                ham->Update_Energy_Contributions();
+                // Regenerate the pairs or FFT kernel, depending on the DDI method
+                ham->ddi_cutoff_radius = radius;
+                ham->Update_Interactions();
 
                 Log( Utility::Log_Level::Info, Utility::Log_Sender::API, fmt::format("Set ddi radius to {}", radius), idx_image, idx_chain );
             }
@@ -341,6 +340,7 @@ void Hamiltonian_Set_DDI(State *state, float radius, int idx_image, int idx_chai
             spirit_handle_exception_api(idx_image, idx_chain);
         }
 
+        image->InvalidateObservables();
         image->Unlock();
     }
     catch( ... )
@@ -253,6 +253,7 @@ void IO_Image_Read( State *state, const char *file, int idx_image_infile,
             spirit_handle_exception_api(idx_image_inchain, idx_chain);
         }
         
+        image->InvalidateObservables();
         image->Unlock();
 
     }
@@ -508,6 +509,7 @@ void IO_Chain_Read( State *state, const char *file, int start_image_infile,
                         {
                             file_ovf.read_segment( *images[i]->spins, *images[i]->geometry, 
                                                    start_image_infile );
+                            images[i]->InvalidateObservables();
                             start_image_infile++;
                         }
                         
@@ -551,6 +553,7 @@ void IO_Chain_Read( State *state, const char *file, int start_image_infile,
                                                                 *chain->images[i]->geometry,
                                                                 chain->images[i]->nos,
                                                                 start_image_infile, file );
+                            chain->images[i]->InvalidateObservables();
                             start_image_infile++;
                         }
                         success = true;
@@ -183,6 +183,31 @@ void Parameters_Set_LLG_Direct_Minimization( State *state, bool direct, int idx_
     }
 }
 
+void Parameters_Set_LLG_Energy_From_Gradient( State *state, bool energy_from_gradient, int idx_image, int idx_chain ) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        from_indices(state, idx_image, idx_chain, image, chain);
+
+        image->Lock();
+        image->llg_parameters->energy_from_gradient = energy_from_gradient;
+        image->Unlock();
+
+        if (energy_from_gradient)
+            Log( Utility::Log_Level::Info, Utility::Log_Sender::API, 
+                 "Set LLG to calculate the energy together with the gradient", idx_image, idx_chain );
+        else
+            Log( Utility::Log_Level::Info, Utility::Log_Sender::API, 
+                 "Set LLG to calculate the energy on demand", idx_image, idx_chain );
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
 void Parameters_Set_LLG_Convergence(State *state, float convergence, int idx_image, int idx_chain) noexcept
 {
     try
@@ -231,6 +256,30 @@ void Parameters_Set_LLG_Time_Step(State *state, float dt, int idx_image, int idx
     }
 }
 
+void Parameters_Set_LLG_RK_Tolerance(State *state, float tolerance, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        image->Lock();
+        auto p = image->llg_parameters;
+        p->rk_tolerance = tolerance;
+        image->Unlock();
+
+        Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
+            fmt::format("Set LLG RK45 tolerance = {}", tolerance), idx_image, idx_chain);
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
 void Parameters_Set_LLG_Damping(State *state, float damping, int idx_image, int idx_chain) noexcept
 {
     try
@@ -550,6 +599,88 @@ void Parameters_Set_MC_Acceptance_Ratio( State *state, float ratio, int idx_imag
     }
 }
 
+void Parameters_Set_MC_Local_Field_Cache( State *state, bool use_cache, int idx_image, int idx_chain ) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+        
+        image->Lock();
+
+        image->mc_parameters->local_field_cache = use_cache;
+
+        Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
+            fmt::format("Set MC local field cache to {}", use_cache), idx_image, idx_chain);
+
+        image->Unlock();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Parameters_Set_MC_Parallel_Sweep( State *state, bool parallel_sweep, int idx_image, int idx_chain ) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+        
+        image->Lock();
+
+        image->mc_parameters->parallel_sweep = parallel_sweep;
+
+        Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
+            fmt::format("Set MC parallel sweep to {}", parallel_sweep), idx_image, idx_chain);
+
+        image->Unlock();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Parameters_Set_MC_Algorithm( State *state, int algorithm, int idx_image, int idx_chain ) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        if (algorithm != MC_Algorithm_Metropolis && algorithm != MC_Algorithm_Heat_Bath && algorithm != MC_Algorithm_Wolff)
+        {
+            Log(Utility::Log_Level::Warning, Utility::Log_Sender::API,
+                fmt::format("Invalid MC algorithm {}", algorithm), idx_image, idx_chain);
+            return;
+        }
+        
+        image->Lock();
+
+        image->mc_parameters->algorithm = Data::MC_Algorithm(algorithm);
+
+        Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
+            fmt::format("Set MC algorithm to {}", algorithm), idx_image, idx_chain);
+
+        image->Unlock();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
 /*------------------------------------------------------------------------------------------------------ */
 /*---------------------------------- Set GNEB ---------------------------------------------------------- */
 /*------------------------------------------------------------------------------------------------------ */
@@ -784,11 +915,28 @@ void Parameters_Set_GNEB_Image_Type_Automatically(State *state, int idx_chain) n
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
 
+        // The energies are calculated on demand
+        std::vector<scalar> energies(chain->noi, 0);
+        for (int img = 0; img < chain->noi; ++img)
+        {
+            chain->images[img]->Lock();
+            try
+            {
+                chain->images[img]->UpdateEnergy(false);
+            }
+            catch( ... )
+            {
+                spirit_handle_exception_api(img, idx_chain);
+            }
+            chain->images[img]->Unlock();
+            energies[img] = chain->images[img]->E;
+        }
+
         for (int img = 1; img < chain->noi - 1; ++img)
         {
-            scalar E0 = chain->images[img-1]->E;
-            scalar E1 = chain->images[img]->E;
-            scalar E2 = chain->images[img+1]->E;
+            scalar E0 = energies[img-1];
+            scalar E1 = energies[img];
+            scalar E2 = energies[img+1];
 
             // Maximum
             if (E0 < E1 && E1 > E2) Parameters_Set_GNEB_Climbing_Falling(state, 1, img);
@@ -828,6 +976,31 @@ void Parameters_Set_GNEB_N_Energy_Interpolations(State *state, int n, int idx_ch
     }
 }
 
+void Parameters_Set_GNEB_Parallel_Images(State *state, bool parallel_images, int idx_chain) noexcept
+{
+    int idx_image = -1;
+
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        chain->Lock();
+        chain->gneb_parameters->parallel_images = parallel_images;
+        chain->Unlock();
+
+        Log(Utility::Log_Level::Info, Utility::Log_Sender::API,
+            fmt::format("Set GNEB parallel images = {}", parallel_images), idx_image, idx_chain);
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
 /*------------------------------------------------------------------------------------------------------ */
 /*---------------------------------- Get LLG ----------------------------------------------------------- */
 /*------------------------------------------------------------------------------------------------------ */
@@ -978,6 +1151,24 @@ bool Parameters_Get_LLG_Direct_Minimization(State *state, int idx_image, int idx
     }
 }
 
+bool Parameters_Get_LLG_Energy_From_Gradient(State *state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        from_indices(state, idx_image, idx_chain, image, chain);
+
+        auto p = image->llg_parameters;
+        return p->energy_from_gradient;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return false;
+    }
+}
+
 float Parameters_Get_LLG_Convergence( State *state, int idx_image, int idx_chain ) noexcept
 {
     try
@@ -1018,6 +1209,26 @@ float Parameters_Get_LLG_Time_Step( State *state, int idx_image, int idx_chain )
     }
 }
 
+float Parameters_Get_LLG_RK_Tolerance( State *state, int idx_image, int idx_chain ) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        auto p = image->llg_parameters;
+        return (float)p->rk_tolerance;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return 0;
+    }
+}
+
 float Parameters_Get_LLG_Damping(State *state, int idx_image, int idx_chain) noexcept
 {
     try
@@ -1278,6 +1489,63 @@ float Parameters_Get_MC_Acceptance_Ratio(State *state, int idx_image, int idx_ch
     }
 }
 
+bool Parameters_Get_MC_Local_Field_Cache(State *state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        return image->mc_parameters->local_field_cache;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return false;
+    }
+}
+
+bool Parameters_Get_MC_Parallel_Sweep(State *state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        return image->mc_parameters->parallel_sweep;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return false;
+    }
+}
+
+int Parameters_Get_MC_Algorithm(State *state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        return (int)image->mc_parameters->algorithm;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return 0;
+    }
+}
+
 /*------------------------------------------------------------------------------------------------------ */
 /*---------------------------------- Get GNEB ----------------------------------------------------------- */
 /*------------------------------------------------------------------------------------------------------ */
@@ -1498,4 +1766,25 @@ int Parameters_Get_GNEB_N_Energy_Interpolations(State *state, int idx_chain) noe
         spirit_handle_exception_api(idx_image, idx_chain);
         return 0;
     }
+}
+
+bool Parameters_Get_GNEB_Parallel_Images(State *state, int idx_chain) noexcept
+{
+    int idx_image = -1;
+
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        return chain->gneb_parameters->parallel_images;
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return false;
+    }
 }
\ No newline at end of file
@@ -17,13 +17,13 @@ void Quantity_Get_Magnetization(State * state,  float m[3], int idx_image, int i
         
         // image->Lock(); // Mutex locks in these functions may cause problems with the performance of UIs
         
-        auto mag = Engine::Vectormath::Magnetization(*image->spins);
-        image->M = Vector3{ mag[0], mag[1], mag[2] };
+        // The magnetization is calculated on demand
+        image->UpdateMagnetization();
 
         // image->Unlock();
         
         for (int i=0; i<3; ++i) 
-            m[i] = (float)mag[i];
+            m[i] = (float)image->M[i];
     }
     catch( ... )
     {
@@ -58,4 +58,111 @@ float Quantity_Get_Topological_Charge(State * state, int idx_image, int idx_chai
         spirit_handle_exception_api(idx_image, idx_chain);
         return 0;
     }
-}
\ No newline at end of file
+}
+
+int Quantity_Get_MC_N_Samples(State * state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        return (int)image->mc_observables.N();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+        return 0;
+    }
+}
+
+void Quantity_Get_MC_Averages(State * state, float * energy, float m[3], float * m_abs, float * m_2, float * m_4, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        auto& observables = image->mc_observables;
+        *energy = (float)observables.energy.Mean();
+        for (int i=0; i<3; ++i)
+            m[i] = (float)observables.magnetization[i].Mean();
+        *m_abs = (float)observables.magnetization_abs.Mean();
+        *m_2   = (float)observables.magnetization_2.Mean();
+        *m_4   = (float)observables.magnetization_4.Mean();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Quantity_Get_MC_Response(State * state, float * specific_heat, float * susceptibility, float * binder_cumulant, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        auto& observables = image->mc_observables;
+        scalar temperature = image->mc_parameters->temperature;
+        *specific_heat   = (float)observables.Specific_Heat(temperature, image->nos);
+        *susceptibility  = (float)observables.Susceptibility(temperature, image->nos);
+        *binder_cumulant = (float)observables.Binder_Cumulant();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Quantity_Get_MC_Autocorrelation(State * state, float * tau_energy, float * tau_m_abs, float * error_energy, float * error_m_abs, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        auto& observables = image->mc_observables;
+        *tau_energy   = (float)observables.energy.Autocorrelation_Time();
+        *tau_m_abs    = (float)observables.magnetization_abs.Autocorrelation_Time();
+        *error_energy = (float)observables.energy.Error();
+        *error_m_abs  = (float)observables.magnetization_abs.Error();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
+
+void Quantity_Reset_MC_Averages(State * state, int idx_image, int idx_chain) noexcept
+{
+    try
+    {
+        std::shared_ptr<Data::Spin_System> image;
+        std::shared_ptr<Data::Spin_System_Chain> chain;
+        
+        // Fetch correct indices and pointers
+        from_indices( state, idx_image, idx_chain, image, chain );
+
+        image->Lock();
+        image->mc_observables.Reset();
+        image->Unlock();
+    }
+    catch( ... )
+    {
+        spirit_handle_exception_api(idx_image, idx_chain);
+    }
+}
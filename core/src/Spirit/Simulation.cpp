@@ -7,6 +7,7 @@
 #include <engine/Method_MC.hpp>
 #include <engine/Method_GNEB.hpp>
 #include <engine/Method_MMF.hpp>
+#include <engine/Method_PT.hpp>
 #include <utility/Logging.hpp>
 #include <utility/Exception.hpp>
 
@@ -36,12 +37,24 @@ bool Get_Method( State *state, const char * c_method_type, const char * c_solver
                 solver = Engine::Solver::NCG;
             else if (solver_type == "VP")
                 solver = Engine::Solver::VP;
+            else if (solver_type == "BFGS")
+                solver = Engine::Solver::BFGS;
+            else if (solver_type == "RK45")
+                solver = Engine::Solver::RK45;
             else
             {
                 Log( Utility::Log_Level::Error, Utility::Log_Sender::API, "Invalid Solver selected: " + 
                         solver_type);
                 return false;
             }
+
+            // The adaptive step size is only meaningful for dynamics of a single image
+            if (solver == Engine::Solver::RK45 && method_type != "LLG")
+            {
+                Log( Utility::Log_Level::Error, Utility::Log_Sender::API, 
+                        "The RK45 Solver can only be used with the LLG Method" );
+                return false;
+            }
         }
 
         // Fetch correct indices and pointers for image and chain
@@ -105,6 +118,12 @@ bool Get_Method( State *state, const char * c_method_type, const char * c_solver
                 else if (solver == Engine::Solver::VP)
                     method = std::shared_ptr<Engine::Method>(
                         new Engine::Method_LLG<Engine::Solver::VP>( image, idx_image, idx_chain ) );
+                else if (solver == Engine::Solver::BFGS)
+                    method = std::shared_ptr<Engine::Method>(
+                        new Engine::Method_LLG<Engine::Solver::BFGS>( image, idx_image, idx_chain ) );
+                else if (solver == Engine::Solver::RK45)
+                    method = std::shared_ptr<Engine::Method>(
+                        new Engine::Method_LLG<Engine::Solver::RK45>( image, idx_image, idx_chain ) );
             }
             else if (method_type == "MC")
             {
@@ -153,15 +172,44 @@ bool Get_Method( State *state, const char * c_method_type, const char * c_solver
                     else if (solver == Engine::Solver::VP)
                         method = std::shared_ptr<Engine::Method>(
                             new Engine::Method_GNEB<Engine::Solver::VP>( chain, idx_chain ) );
+                    else if (solver == Engine::Solver::BFGS)
+                        method = std::shared_ptr<Engine::Method>(
+                            new Engine::Method_GNEB<Engine::Solver::BFGS>( chain, idx_chain ) );
+                }
+            }
+            else if (method_type == "PT")
+            {
+                if (Simulation_Running_Anywhere_Chain(state, idx_chain))
+                {
+                    Log( Utility::Log_Level::Error, Utility::Log_Sender::API, 
+                            std::string( "There are still one or more simulations running on the specified chain!" ) +
+                            std::string( " Please stop them before starting a parallel tempering calculation." ) );
+                    chain->Unlock();
+                    return false;
+                }
+                else if (Chain_Get_NOI(state, idx_chain) < 2)
+                {
+                    Log( Utility::Log_Level::Error, Utility::Log_Sender::API, 
+                            std::string( "There are less than 2 images in the specified chain!" ) +
+                            std::string( " Please insert more before starting a parallel tempering calculation." ) );
+                    chain->Unlock();
+                    return false;
+                }
+                else
+                {
+                    // The iterations are configured by the MC parameters of the first image
+                    chain->iteration_allowed = true;
+                    if (n_iterations > 0) 
+                        chain->images[0]->mc_parameters->n_iterations = n_iterations;
+                    if (n_iterations_log > 0) 
+                        chain->images[0]->mc_parameters->n_iterations_log = n_iterations_log;
+
+                    method = std::shared_ptr<Engine::Method>(
+                        new Engine::Method_PT( chain, idx_chain ) );
                 }
             }
             else if (method_type == "MMF")
             {
-                Log( Utility::Log_Level::Error, Utility::Log_Sender::API, 
-                        "MMF is not yet implemented!" );
-                chain->Unlock();
-                return false;
-                
                 if (Simulation_Running_Anywhere_Collection(state))
                 {
                     Log( Utility::Log_Level::Error, Utility::Log_Sender::API, 
@@ -193,6 +241,9 @@ bool Get_Method( State *state, const char * c_method_type, const char * c_solver
                     else if (solver == Engine::Solver::VP)
                         method = std::shared_ptr<Engine::Method>(
                             new Engine::Method_MMF<Engine::Solver::VP>( state->collection, idx_chain ) );
+                    else if (solver == Engine::Solver::BFGS)
+                        method = std::shared_ptr<Engine::Method>(
+                            new Engine::Method_MMF<Engine::Solver::BFGS>( state->collection, idx_chain ) );
                 }
             }
             else
@@ -214,7 +265,7 @@ bool Get_Method( State *state, const char * c_method_type, const char * c_solver
         {
             state->method_image[idx_chain][idx_image] = info;
         }
-        else if (method_type == "GNEB")
+        else if (method_type == "GNEB" || method_type == "PT")
             state->method_chain[idx_chain] = info;
         else if (method_type == "MMF")
             state->method_collection = info;
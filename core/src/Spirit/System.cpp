@@ -64,6 +64,19 @@ scalar * System_Get_Effective_Field(State * state, int idx_image, int idx_chain)
         
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
+
+        // The effective field is calculated on demand
+        image->Lock();
+        try
+        {
+            image->UpdateEffectiveField();
+        }
+        catch( ... )
+        {
+            spirit_handle_exception_api(idx_image, idx_chain);
+        }
+        image->Unlock();
+
         return image->effective_field[0].data();
     }
     catch( ... )
@@ -101,7 +114,19 @@ float System_Get_Energy(State * state, int idx_image, int idx_chain) noexcept
         
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
-        
+
+        // The energy is calculated on demand
+        image->Lock();
+        try
+        {
+            image->UpdateEnergy(false);
+        }
+        catch( ... )
+        {
+            spirit_handle_exception_api(idx_image, idx_chain);
+        }
+        image->Unlock();
+
         return (float)image->E;
     }
     catch( ... )
@@ -120,7 +145,19 @@ void System_Get_Energy_Array(State * state, float * energies, int idx_image, int
         
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
-        
+
+        // The energy contributions are calculated on demand
+        image->Lock();
+        try
+        {
+            image->UpdateEnergy();
+        }
+        catch( ... )
+        {
+            spirit_handle_exception_api(idx_image, idx_chain);
+        }
+        image->Unlock();
+
         for (unsigned int i=0; i<image->E_array.size(); ++i)
         {
             energies[i] = (float)image->E_array[i].second;
@@ -142,6 +179,17 @@ void System_Print_Energy_Array(State * state, int idx_image, int idx_chain) noex
         // Fetch correct indices and pointers
         from_indices( state, idx_image, idx_chain, image, chain );
         
+        image->Lock();
+        try
+        {
+            image->UpdateEnergy();
+        }
+        catch( ... )
+        {
+            spirit_handle_exception_api(idx_image, idx_chain);
+        }
+        image->Unlock();
+
         scalar nd = 1/(scalar)image->nos;
 
         std::cerr << "E_tot = " << image->E*nd << "  ||  ";
@@ -172,6 +220,8 @@ void System_Update_Data(State * state, int idx_image, int idx_chain) noexcept
         image->Lock();
         try
         {
+            // Recalculate, as the spins may have been changed directly (see System_Get_Spin_Directions)
+            image->InvalidateObservables();
             image->UpdateEnergy();
         }
         catch( ... )
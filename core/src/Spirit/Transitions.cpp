@@ -30,6 +30,7 @@ void Transition_Homogeneous(State *state, int idx_1, int idx_2, int idx_chain) n
             for (int img = 0; img < chain->noi; ++img)
             {
                 chain->gneb_parameters->pinning->Apply(*chain->images[img]->spins);
+                chain->images[img]->InvalidateObservables();
             }
         }
         catch( ... )
@@ -67,6 +68,7 @@ void Transition_Add_Noise_Temperature( State *state, float temperature, int idx_
             for (int img = 0; img < chain->noi; ++img)
             {
                 chain->gneb_parameters->pinning->Apply(*chain->images[img]->spins);
+                chain->images[img]->InvalidateObservables();
             }
         }
         catch( ... )
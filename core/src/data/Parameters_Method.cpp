@@ -8,7 +8,7 @@ namespace Data
         output_folder(output_folder), output_file_tag(output_file_tag), output_any(output[0]), 
         output_initial(output[1]), output_final(output[2]), n_iterations(n_iterations), 
         n_iterations_log(n_iterations_log), max_walltime_sec(max_walltime_sec), pinning(pinning), 
-        force_convergence(force_convergence)
+        force_convergence(force_convergence), parallel_images(false)
     {
     }
 }
\ No newline at end of file
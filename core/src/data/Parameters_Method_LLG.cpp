@@ -8,7 +8,7 @@ namespace Data
             std::shared_ptr<Pinning> pinning, int rng_seed, scalar temperature_i,
             Vector3 temperature_gradient_direction, scalar temperature_gradient_inclination,
             scalar damping_i, scalar beta, scalar time_step, bool renorm_sd_i, bool stt_use_gradient, 
-            scalar stt_magnitude_i, Vector3 stt_polarisation_normal_i):
+            scalar stt_magnitude_i, Vector3 stt_polarisation_normal_i, scalar rk_tolerance):
         Parameters_Method_Solver(output_folder, output_file_tag, {output[0], output[1], output[2]}, 
             n_iterations, n_iterations_log, max_walltime_sec, pinning, force_convergence, time_step),
         output_energy_step(output[3]), output_energy_archive(output[4]), 
@@ -18,9 +18,9 @@ namespace Data
         damping(damping_i), beta(beta), temperature(temperature_i),
         temperature_gradient_direction(temperature_gradient_direction),
         temperature_gradient_inclination(temperature_gradient_inclination),
-        rng_seed(rng_seed), prng(std::mt19937(rng_seed)), stt_use_gradient(stt_use_gradient), 
+        rng_seed(rng_seed), prng(std::mt19937(rng_seed)), philox(rng_seed), stt_use_gradient(stt_use_gradient), 
         stt_magnitude(stt_magnitude_i), stt_polarisation_normal(stt_polarisation_normal_i),
-        direct_minimization(false)
+        direct_minimization(false), energy_from_gradient(false), rk_tolerance(rk_tolerance)
     {
     }
 }
\ No newline at end of file
@@ -28,6 +28,13 @@ namespace Data
 		this->M = Vector3{0,0,0};
 		this->effective_field = vectorfield(this->nos);
 
+		// The observables have not been calculated yet
+		this->n_changes = 1;
+		this->n_changes_E = 0;
+		this->n_changes_E_array = 0;
+		this->n_changes_M = 0;
+		this->n_changes_effective_field = 0;
+
 	}//end Spin_System constructor
 
 	 // Copy Constructor
@@ -38,7 +45,16 @@ namespace Data
 
 		this->E = other.E;
 		this->E_array = other.E_array;
+		this->M = other.M;
 		this->effective_field = other.effective_field;
+		// The MC samples belong to the history of the other system, not to the copied spins
+		this->mc_observables.Reset();
+
+		this->n_changes = other.n_changes;
+		this->n_changes_E = other.n_changes_E;
+		this->n_changes_E_array = other.n_changes_E_array;
+		this->n_changes_M = other.n_changes_M;
+		this->n_changes_effective_field = other.n_changes_effective_field;
 
 		this->geometry = std::shared_ptr<Data::Geometry>(new Data::Geometry(*other.geometry));
 		
@@ -68,7 +84,16 @@ namespace Data
 
 			this->E = other.E;
 			this->E_array = other.E_array;
+			this->M = other.M;
 			this->effective_field = other.effective_field;
+			// The MC samples belong to the history of the other system, not to the copied spins
+			this->mc_observables.Reset();
+
+			this->n_changes = other.n_changes;
+			this->n_changes_E = other.n_changes_E;
+			this->n_changes_E_array = other.n_changes_E_array;
+			this->n_changes_M = other.n_changes_M;
+			this->n_changes_effective_field = other.n_changes_effective_field;
 
 			this->geometry = std::shared_ptr<Data::Geometry>(new Data::Geometry(*other.geometry));
 			
@@ -91,18 +116,56 @@ namespace Data
 		return *this;
 	}
 
-	void Spin_System::UpdateEnergy()
+	void Spin_System::UpdateEnergy(bool contributions)
 	{
+		if (this->n_changes_E_array == this->n_changes) return;
+		if (this->n_changes_E == this->n_changes && !contributions) return;
+
+		// The changes are counted before the calculation, so that a change in the meantime
+		// (e.g. by a running method, if this is called without the lock) is not missed
+		std::uint64_t n_changes = this->n_changes;
 		this->E_array = this->hamiltonian->Energy_Contributions(*this->spins);
 		scalar sum = 0;
 		for (auto E : E_array) sum += E.second;
 		this->E = sum;
+		this->n_changes_E = n_changes;
+		this->n_changes_E_array = n_changes;
 	}
 
 	void Spin_System::UpdateEffectiveField()
 	{
+		if (this->n_changes_effective_field == this->n_changes) return;
+
+		std::uint64_t n_changes = this->n_changes;
 		this->hamiltonian->Gradient(*this->spins, this->effective_field);
 		Engine::Vectormath::scale(this->effective_field, -1);
+		this->n_changes_effective_field = n_changes;
+	}
+
+	void Spin_System::UpdateMagnetization()
+	{
+		if (this->n_changes_M == this->n_changes) return;
+
+		std::uint64_t n_changes = this->n_changes;
+		auto mag = Engine::Vectormath::Magnetization(*this->spins);
+		this->M = Vector3{ mag[0], mag[1], mag[2] };
+		this->n_changes_M = n_changes;
+	}
+
+	void Spin_System::InvalidateObservables()
+	{
+		++this->n_changes;
+	}
+
+	void Spin_System::SetEnergy(scalar E)
+	{
+		this->E = E;
+		this->n_changes_E = this->n_changes;
+	}
+
+	std::uint64_t Spin_System::Changes() const
+	{
+		return this->n_changes;
 	}
 
 	void Spin_System::Lock() const
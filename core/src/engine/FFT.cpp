@@ -0,0 +1,150 @@
+#include <engine/FFT.hpp>
+#include <utility/Constants.hpp>
+
+#include <algorithm>
+
+using Utility::Constants::Pi;
+
+namespace Engine
+{
+    namespace FFT
+    {
+        FFT_Plan_1D::FFT_Plan_1D(int n) : n(n), m(1)
+        {
+            bool power_of_two = (n & (n-1)) == 0;
+
+            // Bluestein needs a radix-2 transform which can hold the full linear convolution
+            if (power_of_two) m = n;
+            else while (m < 2*n-1) m *= 2;
+
+            this->twiddles = cpxfield(m/2);
+            for (int k = 0; k < m/2; ++k)
+                this->twiddles[k] = std::polar(scalar(1), -2*Pi*k/m);
+
+            if (!power_of_two)
+            {
+                // Chirp exp(-i*pi*k^2/n), with k^2 taken modulo 2n to keep the argument small
+                this->chirp = cpxfield(n);
+                for (long long k = 0; k < n; ++k)
+                    this->chirp[k] = std::polar(scalar(1), -Pi*((k*k) % (2*n))/n);
+
+                // Filter, wrapped around so that negative offsets sit at the end
+                this->chirp_filter = cpxfield(m, 0);
+                this->chirp_filter[0] = std::conj(this->chirp[0]);
+                for (int k = 1; k < n; ++k)
+                {
+                    this->chirp_filter[k]   = std::conj(this->chirp[k]);
+                    this->chirp_filter[m-k] = std::conj(this->chirp[k]);
+                }
+                this->Radix2(this->chirp_filter.data(), false);
+            }
+        }
+
+        void FFT_Plan_1D::Radix2(FFT_cpx_type * data, bool inverse) const
+        {
+            // Bit reversal permutation
+            for (int i = 1, j = 0; i < m; ++i)
+            {
+                int bit = m >> 1;
+                for (; j & bit; bit >>= 1)
+                    j ^= bit;
+                j ^= bit;
+                if (i < j) std::swap(data[i], data[j]);
+            }
+
+            // Butterflies
+            for (int len = 2; len <= m; len <<= 1)
+            {
+                int step = m / len;
+                for (int i = 0; i < m; i += len)
+                {
+                    for (int k = 0; k < len/2; ++k)
+                    {
+                        FFT_cpx_type w = inverse ? std::conj(twiddles[k*step]) : twiddles[k*step];
+                        FFT_cpx_type u = data[i+k];
+                        FFT_cpx_type v = data[i+k+len/2] * w;
+                        data[i+k]       = u + v;
+                        data[i+k+len/2] = u - v;
+                    }
+                }
+            }
+        }
+
+        void FFT_Plan_1D::Execute(FFT_cpx_type * data, bool inverse, cpxfield & scratch) const
+        {
+            if (chirp.size() == 0)
+            {
+                this->Radix2(data, inverse);
+                return;
+            }
+
+            // Bluestein: the transform becomes a convolution with the chirp filter.
+            // The inverse transform is obtained by conjugating input and output.
+            scratch.assign(m, 0);
+            for (int k = 0; k < n; ++k)
+                scratch[k] = (inverse ? std::conj(data[k]) : data[k]) * chirp[k];
+
+            this->Radix2(scratch.data(), false);
+            for (int k = 0; k < m; ++k)
+                scratch[k] *= chirp_filter[k];
+            this->Radix2(scratch.data(), true);
+
+            for (int k = 0; k < n; ++k)
+            {
+                FFT_cpx_type x = chirp[k] * scratch[k] / scalar(m);
+                data[k] = inverse ? std::conj(x) : x;
+            }
+        }
+
+
+        FFT_Plan::FFT_Plan(std::array<int,3> dims) :
+            dims(dims), size(dims[0]*dims[1]*dims[2]),
+            plans{{ FFT_Plan_1D(dims[0]), FFT_Plan_1D(dims[1]), FFT_Plan_1D(dims[2]) }}
+        {
+        }
+
+        void FFT_Plan::Forward(FFT_cpx_type * data) const
+        {
+            this->Transform(data, false);
+        }
+
+        void FFT_Plan::Backward(FFT_cpx_type * data) const
+        {
+            this->Transform(data, true);
+
+            const scalar norm = 1.0 / size;
+            #pragma omp parallel for
+            for (int i = 0; i < size; ++i)
+                data[i] *= norm;
+        }
+
+        void FFT_Plan::Transform(FFT_cpx_type * data, bool inverse) const
+        {
+            // Transform all lines along each dimension in turn
+            int stride = 1;
+            for (int dim = 0; dim < 3; ++dim)
+            {
+                const int n = dims[dim];
+                if (n > 1)
+                {
+                    const int n_lines = size / n;
+                    #pragma omp parallel
+                    {
+                        cpxfield line(n), scratch(0);
+                        #pragma omp for
+                        for (int iline = 0; iline < n_lines; ++iline)
+                        {
+                            int offset = (iline % stride) + (iline / stride) * stride * n;
+                            for (int k = 0; k < n; ++k)
+                                line[k] = data[offset + k*stride];
+                            plans[dim].Execute(line.data(), inverse, scratch);
+                            for (int k = 0; k < n; ++k)
+                                data[offset + k*stride] = line[k];
+                        }
+                    }
+                }
+                stride *= n;
+            }
+        }
+    }
+}
@@ -4,10 +4,43 @@
 #include <utility/Logging.hpp>
 #include <utility/Exception.hpp>
 
+#include <algorithm>
+
 using namespace Utility;
 
 namespace Engine
 {
+    namespace
+    {
+        // Greedy colouring of a graph in compressed sparse row format. Returns the number of colours.
+        int Greedy_Colouring(int nos, const intfield & offsets, const intfield & partners, int distance, intfield & colours)
+        {
+            colours = intfield(nos, -1);
+            int n_colours = 0;
+            // The last spin for which each colour was found to be forbidden
+            intfield forbidden(nos, -1);
+            for (int i = 0; i < nos; ++i)
+            {
+                for (int idx = offsets[i]; idx < offsets[i+1]; ++idx)
+                {
+                    int j = partners[idx];
+                    if (colours[j] >= 0) forbidden[colours[j]] = i;
+                    if (distance < 2) continue;
+                    for (int jdx = offsets[j]; jdx < offsets[j+1]; ++jdx)
+                    {
+                        int k = partners[jdx];
+                        if (colours[k] >= 0) forbidden[colours[k]] = i;
+                    }
+                }
+                int colour = 0;
+                while (forbidden[colour] == i) ++colour;
+                colours[i] = colour;
+                n_colours = std::max(n_colours, colour+1);
+            }
+            return n_colours;
+        }
+    }
+
     Hamiltonian::Hamiltonian(intfield boundary_conditions) :
         boundary_conditions(boundary_conditions)
     {
@@ -31,62 +64,156 @@ namespace Engine
         this->Hessian_FD(spins, hessian);
     }
 
-    void Hamiltonian::Hessian_FD(const vectorfield & spins, MatrixX & hessian)
+    void Hamiltonian::Sparse_Hessian(const vectorfield & spins, SpMatrixX & hessian)
+    {
+        int nos = spins.size();
+        MatrixX hessian_dense = MatrixX::Zero(3*nos, 3*nos);
+        this->Hessian(spins, hessian_dense);
+        hessian = hessian_dense.sparseView();
+    }
+
+    void Hamiltonian::Hessian_Vector_Product(const vectorfield & spins, const vectorfield & vectors, vectorfield & product)
+    {
+        int nos = spins.size();
+
+        // Central difference of the gradient along the (normalised) vector field
+        scalar norm = std::sqrt(Vectormath::dot(vectors, vectors));
+        if (norm == 0)
+        {
+            Vectormath::fill(product, {0,0,0});
+            return;
+        }
+        scalar step = delta / norm;
+
+        vectorfield spins_plus  = spins;
+        vectorfield spins_minus = spins;
+        Vectormath::add_c_a( step, vectors, spins_plus);
+        Vectormath::add_c_a(-step, vectors, spins_minus);
+
+        vectorfield grad_plus(nos);
+        vectorfield grad_minus(nos);
+        this->Gradient(spins_plus,  grad_plus);
+        this->Gradient(spins_minus, grad_minus);
+
+        Vectormath::set_c_a( 0.5/step, grad_plus,  product);
+        Vectormath::add_c_a(-0.5/step, grad_minus, product);
+    }
+
+    bool Hamiltonian::Interaction_Graph(int /*nos*/, intfield & /*offsets*/, intfield & /*partners*/)
+    {
+        // Without knowledge of the interactions, all spins have to be assumed to interact
+        return false;
+    }
+
+    bool Hamiltonian::Exchange_Graph(int /*nos*/, intfield & /*offsets*/, intfield & /*partners*/, scalarfield & /*magnitudes*/)
     {
-        // This is a regular finite difference implementation (probably not very efficient)
-        // using the differences between gradient values (not function)
-        // see https://v8doc.sas.com/sashtml/ormp/chap5/sect28.htm
+        return false;
+    }
+
+    int Hamiltonian::Interaction_Colouring(int nos, int distance, intfield & colours)
+    {
+        intfield offsets(0), partners(0);
+        if (!this->Interaction_Graph(nos, offsets, partners))
+            return 0;
+        return Greedy_Colouring(nos, offsets, partners, distance, colours);
+    }
 
+    void Hamiltonian::Hessian_FD(const vectorfield & spins, MatrixX & hessian)
+    {
         int nos = spins.size();
+        SpMatrixX hessian_sparse(3*nos, 3*nos);
+        this->Sparse_Hessian_FD(spins, hessian_sparse);
+        hessian = MatrixX(hessian_sparse);
+    }
 
-        vectorfield spins_pi(nos);
-        vectorfield spins_mi(nos);
-        vectorfield spins_pj(nos);
-        vectorfield spins_mj(nos);
+    void Hamiltonian::Sparse_Hessian_FD(const vectorfield & spins, SpMatrixX & hessian)
+    {
+        // This is a coloured finite difference implementation (Curtis, Powell and Reid), using
+        // the differences between gradient values (not function). Displacing all spins of one
+        // colour, the gradient of each spin changes due to at most one of them.
+        int nos = spins.size();
 
-        spins_pi = spins;
-        spins_mi = spins;
-        spins_pj = spins;
-        spins_mj = spins;
+        intfield offsets(0), partners(0);
+        bool sparse = this->Interaction_Graph(nos, offsets, partners);
+        if (!sparse)
+        {
+            // Complete graph
+            offsets  = intfield(nos+1);
+            partners = intfield(0);
+            for (int i = 0; i < nos; ++i)
+            {
+                offsets[i] = partners.size();
+                for (int j = 0; j < nos; ++j)
+                    if (j != i) partners.push_back(j);
+            }
+            offsets[nos] = partners.size();
+        }
 
-        vectorfield grad_pi(nos);
-        vectorfield grad_mi(nos);
-        vectorfield grad_pj(nos);
-        vectorfield grad_mj(nos);
+        // Distance-2 colouring: spins of one colour neither interact nor share a partner
+        intfield colours(nos, -1);
+        int n_colours = 0;
+        if (sparse)
+        {
+            n_colours = Greedy_Colouring(nos, offsets, partners, 2, colours);
+        }
+        else
+        {
+            for (int i = 0; i < nos; ++i)
+                colours[i] = i;
+            n_colours = nos;
+        }
 
+        std::vector<intfield> colour_spins(n_colours);
         for (int i = 0; i < nos; ++i)
+            colour_spins[colours[i]].push_back(i);
+
+        vectorfield spins_plus  = spins;
+        vectorfield spins_minus = spins;
+        vectorfield grad_plus(nos);
+        vectorfield grad_minus(nos);
+
+        std::vector<Eigen::Triplet<scalar>> triplets(0);
+        for (int colour = 0; colour < n_colours; ++colour)
         {
-            for (int j = 0; j < nos; ++j)
+            for (int beta = 0; beta < 3; ++beta)
             {
-                for (int alpha = 0; alpha < 3; ++alpha)
+                // Displace
+                for (int j : colour_spins[colour])
+                {
+                    spins_plus[j][beta]  += delta;
+                    spins_minus[j][beta] -= delta;
+                }
+
+                this->Gradient(spins_plus,  grad_plus);
+                this->Gradient(spins_minus, grad_minus);
+
+                // Un-Displace
+                for (int j : colour_spins[colour])
+                {
+                    spins_plus[j][beta]  = spins[j][beta];
+                    spins_minus[j][beta] = spins[j][beta];
+                }
+
+                // The change of the gradient of j and its partners is due to the displacement of j.
+                // Both halves of the symmetrised Hessian are added, as in 0.5*(H + H^T).
+                for (int j : colour_spins[colour])
                 {
-                    for (int beta = 0; beta < 3; ++beta)
+                    for (int idx = offsets[j]-1; idx < offsets[j+1]; ++idx)
                     {
-                        // Displace
-                        spins_pi[i][alpha] += delta;
-                        spins_mi[i][alpha] -= delta;
-                        spins_pj[j][beta]  += delta;
-                        spins_mj[j][beta]  -= delta;
-
-                        // Calculate Hessian component
-                        this->Gradient(spins_pi, grad_pi);
-                        this->Gradient(spins_mi, grad_mi);
-                        this->Gradient(spins_pj, grad_pj);
-                        this->Gradient(spins_mj, grad_mj);
-
-                        hessian(3*i + alpha, 3*j + beta) = 0.25 / delta *
-                            ( grad_pj[i][alpha] - grad_mj[i][alpha]
-                            + grad_pi[j][beta]  - grad_mi[j][beta] );
-                        
-                        // Un-Displace
-                        spins_pi[i][alpha] -= delta;
-                        spins_mi[i][alpha] += delta;
-                        spins_pj[j][beta]  -= delta;
-                        spins_mj[j][beta]  += delta;
+                        int i = (idx < offsets[j]) ? j : partners[idx];
+                        for (int alpha = 0; alpha < 3; ++alpha)
+                        {
+                            scalar value = 0.25 / delta * (grad_plus[i][alpha] - grad_minus[i][alpha]);
+                            triplets.push_back( {3*i + alpha, 3*j + beta, value} );
+                            triplets.push_back( {3*j + beta, 3*i + alpha, value} );
+                        }
                     }
                 }
             }
         }
+
+        hessian.resize(3*nos, 3*nos);
+        hessian.setFromTriplets(triplets.begin(), triplets.end());
     }
 
     void Hamiltonian::Gradient(const vectorfield & spins, vectorfield & gradient)
@@ -94,11 +221,49 @@ namespace Engine
         this->Gradient_FD(spins, gradient);
     }
 
+    scalar Hamiltonian::Energy_and_Gradient(const vectorfield & spins, vectorfield & gradient)
+    {
+        this->Gradient(spins, gradient);
+        return this->Energy(spins);
+    }
+
     void Hamiltonian::Gradient_FD(const vectorfield & spins, vectorfield & gradient)
     {
         int nos = spins.size();
 
-        // Calculate finite difference
+        // Displacing spin i only changes the single spin energies of i and its partners
+        intfield offsets(0), partners(0);
+        if (this->Interaction_Graph(nos, offsets, partners))
+        {
+            #pragma omp parallel
+            {
+                // Each thread displaces its own copy of the spins
+                vectorfield spins_displaced = spins;
+
+                #pragma omp for
+                for (int i = 0; i < nos; ++i)
+                {
+                    for (int dim = 0; dim < 3; ++dim)
+                    {
+                        scalar E_plus = 0, E_minus = 0;
+
+                        spins_displaced[i][dim] = spins[i][dim] + delta;
+                        for (int idx = offsets[i]-1; idx < offsets[i+1]; ++idx)
+                            E_plus += this->Energy_Single_Spin((idx < offsets[i]) ? i : partners[idx], spins_displaced);
+
+                        spins_displaced[i][dim] = spins[i][dim] - delta;
+                        for (int idx = offsets[i]-1; idx < offsets[i+1]; ++idx)
+                            E_minus += this->Energy_Single_Spin((idx < offsets[i]) ? i : partners[idx], spins_displaced);
+
+                        spins_displaced[i][dim] = spins[i][dim];
+                        gradient[i][dim] = 0.5 * (E_plus - E_minus) / delta;
+                    }
+                }
+            }
+            return;
+        }
+
+        // Calculate finite difference of the energy
         vectorfield spins_plus(nos);
         vectorfield spins_minus(nos);
 
@@ -158,6 +323,34 @@ namespace Engine
             "Tried to use  Hamiltonian::Energy_Single_Spin() of the Hamiltonian base class!");
     }
 
+    void Hamiltonian::Local_Fields(const vectorfield & /*spins*/, vectorfield & /*fields*/)
+    {
+        // Not Implemented!
+        spirit_throw(Exception_Classifier::Not_Implemented, Log_Level::Error,
+            "Tried to use  Hamiltonian::Local_Fields() of the Hamiltonian base class!");
+    }
+
+    scalar Hamiltonian::Energy_Difference_Single_Spin(int /*ispin*/, const Vector3 & /*spin_new*/, const vectorfield & /*spins*/, const vectorfield & /*fields*/)
+    {
+        // Not Implemented!
+        spirit_throw(Exception_Classifier::Not_Implemented, Log_Level::Error,
+            "Tried to use  Hamiltonian::Energy_Difference_Single_Spin() of the Hamiltonian base class!");
+    }
+
+    void Hamiltonian::Update_Local_Fields(int /*ispin*/, const Vector3 & /*spin_old*/, const vectorfield & /*spins*/, vectorfield & /*fields*/)
+    {
+        // Not Implemented!
+        spirit_throw(Exception_Classifier::Not_Implemented, Log_Level::Error,
+            "Tried to use  Hamiltonian::Update_Local_Fields() of the Hamiltonian base class!");
+    }
+
+    Vector3 Hamiltonian::Linear_Field_Single_Spin(int /*ispin*/, const vectorfield & /*spins*/, const vectorfield & /*fields*/)
+    {
+        // Not Implemented!
+        spirit_throw(Exception_Classifier::Not_Implemented, Log_Level::Error,
+            "Tried to use  Hamiltonian::Linear_Field_Single_Spin() of the Hamiltonian base class!");
+    }
+
     static const std::string name = "--";
     const std::string& Hamiltonian::Name()
     {
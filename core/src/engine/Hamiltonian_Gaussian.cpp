@@ -75,6 +75,14 @@ namespace Engine
         }
     }
 
+    bool Hamiltonian_Gaussian::Interaction_Graph(int nos, intfield & offsets, intfield & partners)
+    {
+        // Spins do not interact
+        offsets  = intfield(nos+1, 0);
+        partners = intfield(0);
+        return true;
+    }
+
     void Hamiltonian_Gaussian::Energy_Contributions_per_Spin(const vectorfield & spins, std::vector<std::pair<std::string, scalarfield>> & contributions)
     {
         int nos = spins.size();
@@ -105,7 +113,7 @@ namespace Engine
             // Distance between spin and gaussian center
             scalar l = 1 - this->center[i].dot(spins[ispin]); //Utility::Manifoldmath::Dist_Greatcircle(this->center[i], n);
             // Energy contribution
-            this->energy_contributions_per_spin[0].second[ispin] += this->amplitude[i] * std::exp(-std::pow(l, 2) / (2.0*std::pow(this->width[i], 2)));
+            Energy += this->amplitude[i] * std::exp(-std::pow(l, 2) / (2.0*std::pow(this->width[i], 2)));
         }
         return Energy;
     }
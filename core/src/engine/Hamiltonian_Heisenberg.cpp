@@ -5,8 +5,16 @@
 #include <engine/Neighbours.hpp>
 #include <data/Spin_System.hpp>
 #include <utility/Constants.hpp>
+#include <utility/Logging.hpp>
+#include <utility/Exception.hpp>
 
 #include <Eigen/Dense>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
 
 using namespace Data;
 using namespace Utility;
@@ -25,10 +33,11 @@ namespace Engine
         intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
         pairfield exchange_pairs, scalarfield exchange_magnitudes,
         pairfield dmi_pairs, scalarfield dmi_magnitudes, vectorfield dmi_normals,
-        scalar ddi_radius,
+        DDI_Method ddi_method, scalar ddi_radius,
         quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
         std::shared_ptr<Data::Geometry> geometry,
-        intfield boundary_conditions
+        intfield boundary_conditions,
+        std::string interaction_cache_file
     ) :
         Hamiltonian(boundary_conditions),
         geometry(geometry),
@@ -37,8 +46,9 @@ namespace Engine
         anisotropy_indices(anisotropy_indices), anisotropy_magnitudes(anisotropy_magnitudes), anisotropy_normals(anisotropy_normals),
         exchange_pairs_in(exchange_pairs), exchange_magnitudes_in(exchange_magnitudes), exchange_shell_magnitudes(0),
         dmi_pairs_in(dmi_pairs), dmi_magnitudes_in(dmi_magnitudes), dmi_normals_in(dmi_normals), dmi_shell_magnitudes(0), dmi_shell_chirality(0),
+        ddi_method(ddi_method), ddi_cutoff_radius(ddi_radius),
         quadruplets(quadruplets), quadruplet_magnitudes(quadruplet_magnitudes),
-        ddi_cutoff_radius(ddi_radius)
+        interaction_cache_file(interaction_cache_file)
     {
         // Generate interaction pairs, constants etc.
         this->Update_Interactions();
@@ -51,10 +61,11 @@ namespace Engine
         intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
         scalarfield exchange_shell_magnitudes,
         scalarfield dmi_shell_magnitudes, int dm_chirality,
-        scalar ddi_radius,
+        DDI_Method ddi_method, scalar ddi_radius,
         quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
         std::shared_ptr<Data::Geometry> geometry,
-        intfield boundary_conditions
+        intfield boundary_conditions,
+        std::string interaction_cache_file
     ) :
         Hamiltonian(boundary_conditions),
         geometry(geometry),
@@ -63,14 +74,41 @@ namespace Engine
         anisotropy_indices(anisotropy_indices), anisotropy_magnitudes(anisotropy_magnitudes), anisotropy_normals(anisotropy_normals),
         exchange_pairs_in(0), exchange_magnitudes_in(0), exchange_shell_magnitudes(exchange_shell_magnitudes),
         dmi_pairs_in(0), dmi_magnitudes_in(0), dmi_normals_in(0), dmi_shell_magnitudes(dmi_shell_magnitudes), dmi_shell_chirality(dm_chirality),
+        ddi_method(ddi_method), ddi_cutoff_radius(ddi_radius),
         quadruplets(quadruplets), quadruplet_magnitudes(quadruplet_magnitudes),
-        ddi_cutoff_radius(ddi_radius)
+        interaction_cache_file(interaction_cache_file)
     {
         // Generate interaction pairs, constants etc.
         this->Update_Interactions();
     }
 
     void Hamiltonian_Heisenberg::Update_Interactions()
+    {
+        if (this->interaction_cache_file == "")
+        {
+            this->Build_Interactions();
+        }
+        else
+        {
+            std::uint64_t key = this->Interaction_Cache_Key();
+            if (this->Read_Interaction_Cache(key))
+            {
+                // The transformed dipolar tensors were read, but the FFT plan and buffers are still needed
+                if (this->ddi_method == DDI_Method::FFT)
+                    this->Update_DDI_FFT(false);
+            }
+            else
+            {
+                this->Build_Interactions();
+                this->Write_Interaction_Cache(key);
+            }
+        }
+
+        // Update, which terms still contribute
+        this->Update_Energy_Contributions();
+    }
+
+    void Hamiltonian_Heisenberg::Build_Interactions()
     {
         #if defined(SPIRIT_USE_OPENMP)
         // When parallelising (cuda or openmp), we need all neighbours per spin
@@ -144,24 +182,419 @@ namespace Engine
             }
         }
 
+        this->Build_Anisotropy_Table();
+
+        // Per-spin neighbour tables for the pair kernels
+        vectorfield exchange_partner_normals(0);
+        this->Build_Neighbour_Table(this->exchange_pairs, this->exchange_magnitudes, vectorfield(0), use_redundant_neighbours,
+            this->exchange_offsets, this->exchange_partners, this->exchange_partner_magnitudes, exchange_partner_normals);
+        this->Build_Neighbour_Table(this->dmi_pairs, this->dmi_magnitudes, this->dmi_normals, use_redundant_neighbours,
+            this->dmi_offsets, this->dmi_partners, this->dmi_partner_magnitudes, this->dmi_partner_normals);
+        this->Build_Quadruplet_Table();
+
         // Dipole-dipole
-        this->ddi_pairs      = Engine::Neighbours::Get_Pairs_in_Radius(*this->geometry, this->ddi_cutoff_radius);
-        this->ddi_magnitudes = scalarfield(this->ddi_pairs.size());
-        this->ddi_normals    = vectorfield(this->ddi_pairs.size());
+        if (this->ddi_method == DDI_Method::FFT)
+        {
+            // The convolution replaces the pair list
+            this->ddi_pairs      = pairfield(0);
+            this->ddi_magnitudes = scalarfield(0);
+            this->ddi_normals    = vectorfield(0);
+            this->ddi_offsets    = intfield(geometry->nos+1, 0);
+            this->ddi_partners   = intfield(0);
+            this->ddi_partner_prefactors = scalarfield(0);
+            this->ddi_partner_normals    = vectorfield(0);
+            this->Update_DDI_FFT();
+        }
+        else
+        {
+            this->ddi_pairs      = Engine::Neighbours::Get_Pairs_in_Radius(*this->geometry, this->ddi_cutoff_radius);
+            this->ddi_magnitudes = scalarfield(this->ddi_pairs.size());
+            this->ddi_normals    = vectorfield(this->ddi_pairs.size());
 
-        scalar magnitude;
-        Vector3 normal;
+            for (unsigned int i = 0; i < this->ddi_pairs.size(); ++i)
+            {
+                Engine::Neighbours::DDI_from_Pair(
+                    *this->geometry,
+                    { this->ddi_pairs[i].i, this->ddi_pairs[i].j, this->ddi_pairs[i].translations },
+                    this->ddi_magnitudes[i], this->ddi_normals[i]);
+            }
+
+            // The pairs in the radius are redundant, so every spin owns its own partners
+            // The translations are in angstrom, so the |r|[m] becomes |r|[m]*10^-10
+            const scalar mult = mu_0 * std::pow(mu_B, 2) / ( 4*Pi * 1e-30 );
+            pairfield   table_pairs(0);
+            scalarfield table_prefactors(0);
+            vectorfield table_normals(0);
+            for (unsigned int i = 0; i < this->ddi_pairs.size(); ++i)
+            {
+                if (this->ddi_magnitudes[i] > 0.0)
+                {
+                    table_pairs.push_back(this->ddi_pairs[i]);
+                    table_prefactors.push_back(this->mu_s[ddi_pairs[i].i] * this->mu_s[ddi_pairs[i].j] * mult / std::pow(this->ddi_magnitudes[i], 3.0));
+                    table_normals.push_back(this->ddi_normals[i]);
+                }
+            }
+            this->Build_Neighbour_Table(table_pairs, table_prefactors, table_normals, true,
+                this->ddi_offsets, this->ddi_partners, this->ddi_partner_prefactors, this->ddi_partner_normals);
+            this->ddi_fft_kernel = FFT::cpxfield(0);
+        }
+    }
+
+    namespace
+    {
+        // Version of the binary format of the interaction cache, to be increased whenever its contents change
+        const std::uint32_t interaction_cache_version = 4;
+        const char interaction_cache_magic[8] = { 'S', 'P', 'I', 'R', 'I', 'T', 'I', 'C' };
+
+        // 64 bit FNV-1a hash of the raw bytes of values and fields
+        struct Hash_Archive
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+
+            void Bytes(const void * data, std::size_t size)
+            {
+                auto bytes = static_cast<const unsigned char *>(data);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+            }
+
+            template<typename T>
+            void operator()(const T & value)
+            {
+                this->Bytes(&value, sizeof(T));
+            }
+
+            template<typename T>
+            void operator()(const std::vector<T> & values)
+            {
+                std::uint64_t size = values.size();
+                this->Bytes(&size, sizeof(size));
+                this->Bytes(values.data(), size*sizeof(T));
+            }
+        };
+
+        // Writes fields as their size followed by their raw bytes
+        struct Write_Archive
+        {
+            std::ofstream stream;
+
+            Write_Archive(const std::string & file) : stream(file, std::ios::binary) {}
+
+            template<typename T>
+            void operator()(const std::vector<T> & values)
+            {
+                std::uint64_t size = values.size();
+                stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+                stream.write(reinterpret_cast<const char *>(values.data()), size*sizeof(T));
+            }
+        };
+
+        // Reads fields written by Write_Archive, refusing sizes beyond the end of the file
+        struct Read_Archive
+        {
+            std::ifstream stream;
+            std::uint64_t remaining;
+
+            Read_Archive(const std::string & file) : stream(file, std::ios::binary | std::ios::ate), remaining(0)
+            {
+                if (stream)
+                {
+                    remaining = stream.tellg();
+                    stream.seekg(0);
+                }
+            }
+
+            bool Read(void * data, std::uint64_t size)
+            {
+                if (!stream || size > remaining)
+                {
+                    stream.setstate(std::ios::failbit);
+                    return false;
+                }
+                stream.read(static_cast<char *>(data), size);
+                remaining -= size;
+                return bool(stream);
+            }
 
-        for (unsigned int i = 0; i < this->ddi_pairs.size(); ++i)
+            template<typename T>
+            void operator()(std::vector<T> & values)
+            {
+                std::uint64_t size = 0;
+                if (!this->Read(&size, sizeof(size)) || size > remaining / sizeof(T))
+                {
+                    stream.setstate(std::ios::failbit);
+                    return;
+                }
+                values.resize(size);
+                this->Read(values.data(), size*sizeof(T));
+            }
+        };
+    }
+
+    template<typename Archive>
+    void Hamiltonian_Heisenberg::Archive_Interactions(Archive & archive)
+    {
+        archive(this->anisotropy_basis_offsets);
+        archive(this->anisotropy_basis_terms);
+        archive(this->exchange_pairs);
+        archive(this->exchange_magnitudes);
+        archive(this->exchange_offsets);
+        archive(this->exchange_partners);
+        archive(this->exchange_partner_magnitudes);
+        archive(this->dmi_pairs);
+        archive(this->dmi_magnitudes);
+        archive(this->dmi_normals);
+        archive(this->dmi_offsets);
+        archive(this->dmi_partners);
+        archive(this->dmi_partner_magnitudes);
+        archive(this->dmi_partner_normals);
+        archive(this->ddi_pairs);
+        archive(this->ddi_magnitudes);
+        archive(this->ddi_normals);
+        archive(this->ddi_offsets);
+        archive(this->ddi_partners);
+        archive(this->ddi_partner_prefactors);
+        archive(this->ddi_partner_normals);
+        archive(this->ddi_fft_kernel);
+        archive(this->quadruplet_lattice_spins);
+        archive(this->quadruplet_lattice_magnitudes);
+        archive(this->quadruplet_offsets);
+        archive(this->quadruplet_memberships);
+    }
+
+    std::uint64_t Hamiltonian_Heisenberg::Interaction_Cache_Key()
+    {
+        Hash_Archive hash;
+
+        // Format of the tables
+        hash(interaction_cache_version);
+        hash(sizeof(scalar));
+        #if defined(SPIRIT_USE_OPENMP)
+        hash(true);
+        #else
+        hash(false);
+        #endif
+
+        // Geometry
+        hash(this->geometry->bravais_vectors);
+        hash(this->geometry->n_cells);
+        hash(this->geometry->cell_atoms);
+        hash(this->geometry->lattice_constant);
+        hash(this->geometry->atom_types);
+        hash(this->boundary_conditions);
+
+        // Parameters
+        hash(this->mu_s);
+        hash(this->anisotropy_indices);
+        hash(this->exchange_shell_magnitudes);
+        hash(this->exchange_pairs_in);
+        hash(this->exchange_magnitudes_in);
+        hash(this->dmi_shell_magnitudes);
+        hash(this->dmi_shell_chirality);
+        hash(this->dmi_pairs_in);
+        hash(this->dmi_magnitudes_in);
+        hash(this->dmi_normals_in);
+        hash(this->ddi_method);
+        hash(this->ddi_cutoff_radius);
+        hash(this->quadruplets);
+        hash(this->quadruplet_magnitudes);
+
+        return hash.hash;
+    }
+
+    bool Hamiltonian_Heisenberg::Read_Interaction_Cache(std::uint64_t key)
+    {
+        Read_Archive archive(this->interaction_cache_file);
+        if (!archive.stream)
+            return false;
+
+        char magic[8];
+        std::uint64_t file_key = 0;
+        if (!archive.Read(magic, sizeof(magic)) || !std::equal(magic, magic+8, interaction_cache_magic) ||
+            !archive.Read(&file_key, sizeof(file_key)) || file_key != key)
         {
-            Engine::Neighbours::DDI_from_Pair(
-                *this->geometry,
-                { this->ddi_pairs[i].i, this->ddi_pairs[i].j, this->ddi_pairs[i].translations },
-                this->ddi_magnitudes[i], this->ddi_normals[i]);
+            Log(Log_Level::Info, Log_Sender::All, fmt::format("Interaction cache \"{}\" does not match, rebuilding the interactions", this->interaction_cache_file));
+            return false;
         }
 
-        // Update, which terms still contribute
-        this->Update_Energy_Contributions();
+        this->Archive_Interactions(archive);
+        if (!archive.stream)
+        {
+            Log(Log_Level::Warning, Log_Sender::All, fmt::format("Interaction cache \"{}\" could not be read, rebuilding the interactions", this->interaction_cache_file));
+            return false;
+        }
+
+        Log(Log_Level::Info, Log_Sender::All, fmt::format("Read the interactions from cache \"{}\"", this->interaction_cache_file));
+        return true;
+    }
+
+    void Hamiltonian_Heisenberg::Write_Interaction_Cache(std::uint64_t key)
+    {
+        // Many processes may start from the same input, so the file is written under a unique
+        // name and then moved into place, so that nobody reads a partially written cache
+        std::random_device device;
+        std::string temporary_file = fmt::format("{}.{:x}.tmp", this->interaction_cache_file, device());
+
+        bool success = false;
+        {
+            Write_Archive archive(temporary_file);
+            archive.stream.write(interaction_cache_magic, sizeof(interaction_cache_magic));
+            archive.stream.write(reinterpret_cast<const char *>(&key), sizeof(key));
+            this->Archive_Interactions(archive);
+            success = bool(archive.stream);
+        }
+
+        if (success && std::rename(temporary_file.c_str(), this->interaction_cache_file.c_str()) != 0)
+        {
+            // Renaming onto an existing file may fail on some platforms
+            std::remove(this->interaction_cache_file.c_str());
+            success = std::rename(temporary_file.c_str(), this->interaction_cache_file.c_str()) == 0;
+        }
+
+        if (success)
+            Log(Log_Level::Info, Log_Sender::All, fmt::format("Wrote the interactions to cache \"{}\"", this->interaction_cache_file));
+        else
+        {
+            std::remove(temporary_file.c_str());
+            Log(Log_Level::Warning, Log_Sender::All, fmt::format("Could not write the interaction cache \"{}\"", this->interaction_cache_file));
+        }
+    }
+
+    void Hamiltonian_Heisenberg::Build_Anisotropy_Table()
+    {
+        const int N = geometry->n_cell_atoms;
+
+        // Count the axes of each basis atom
+        this->anisotropy_basis_offsets = intfield(N+1, 0);
+        for (unsigned int iani = 0; iani < anisotropy_indices.size(); ++iani)
+        {
+            int ibasis = anisotropy_indices[iani];
+            if (ibasis >= 0 && ibasis < N)
+                ++anisotropy_basis_offsets[ibasis+1];
+        }
+        for (int ibasis = 0; ibasis < N; ++ibasis)
+            anisotropy_basis_offsets[ibasis+1] += anisotropy_basis_offsets[ibasis];
+
+        // Fill in the indices of the axes, keeping their order
+        this->anisotropy_basis_terms = intfield(anisotropy_basis_offsets[N]);
+        intfield fill(anisotropy_basis_offsets.begin(), anisotropy_basis_offsets.end()-1);
+        for (unsigned int iani = 0; iani < anisotropy_indices.size(); ++iani)
+        {
+            int ibasis = anisotropy_indices[iani];
+            if (ibasis >= 0 && ibasis < N)
+                anisotropy_basis_terms[fill[ibasis]++] = iani;
+        }
+    }
+
+    void Hamiltonian_Heisenberg::Build_Neighbour_Table( const pairfield & pairs, const scalarfield & magnitudes, const vectorfield & normals, bool pairs_are_redundant,
+        intfield & offsets, intfield & partners, scalarfield & partner_magnitudes, vectorfield & partner_normals )
+    {
+        const int N   = geometry->n_cell_atoms;
+        const int nos = geometry->nos;
+        const bool use_normals = normals.size() > 0;
+
+        // Count the valid partners of each spin
+        intfield n_partners(nos, 0);
+        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        {
+            for (unsigned int i_pair = 0; i_pair < pairs.size(); ++i_pair)
+            {
+                int ispin = pairs[i_pair].i + icell*N;
+                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, N, geometry->atom_types, pairs[i_pair]);
+                if (jspin >= 0)
+                {
+                    ++n_partners[ispin];
+                    // Unique pairs are stored only once, so spin j needs the mirrored entry
+                    if (!pairs_are_redundant) ++n_partners[jspin];
+                }
+            }
+        }
+
+        // Offsets are the running sum of the partner counts
+        offsets = intfield(nos+1, 0);
+        for (int ispin = 0; ispin < nos; ++ispin)
+            offsets[ispin+1] = offsets[ispin] + n_partners[ispin];
+
+        partners           = intfield(offsets[nos]);
+        partner_magnitudes = scalarfield(offsets[nos]);
+        partner_normals    = vectorfield(use_normals ? offsets[nos] : 0);
+
+        // Fill in the partners
+        intfield cursor(offsets.begin(), offsets.end()-1);
+        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        {
+            for (unsigned int i_pair = 0; i_pair < pairs.size(); ++i_pair)
+            {
+                int ispin = pairs[i_pair].i + icell*N;
+                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, N, geometry->atom_types, pairs[i_pair]);
+                if (jspin >= 0)
+                {
+                    int idx = cursor[ispin]++;
+                    partners[idx]           = jspin;
+                    partner_magnitudes[idx] = magnitudes[i_pair];
+                    if (use_normals) partner_normals[idx] = normals[i_pair];
+                    if (!pairs_are_redundant)
+                    {
+                        idx = cursor[jspin]++;
+                        partners[idx]           = ispin;
+                        partner_magnitudes[idx] = magnitudes[i_pair];
+                        if (use_normals) partner_normals[idx] = -normals[i_pair];
+                    }
+                }
+            }
+        }
+    }
+
+    void Hamiltonian_Heisenberg::Build_Quadruplet_Table()
+    {
+        const int N   = geometry->n_cell_atoms;
+        const int nos = geometry->nos;
+
+        // Lattice quadruplets, using the same translations as the quadruplet kernels
+        this->quadruplet_lattice_spins      = intfield(0);
+        this->quadruplet_lattice_magnitudes = scalarfield(0);
+        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        {
+            auto translations = Vectormath::translations_from_idx(geometry->n_cells, N, icell*N);
+            for (unsigned int iquad = 0; iquad < quadruplets.size(); ++iquad)
+            {
+                int ispin = quadruplets[iquad].i + icell*N;
+                int jspin = quadruplets[iquad].j + Vectormath::idx_from_translations(geometry->n_cells, N, translations, quadruplets[iquad].d_j);
+                int kspin = quadruplets[iquad].k + Vectormath::idx_from_translations(geometry->n_cells, N, translations, quadruplets[iquad].d_k);
+                int lspin = quadruplets[iquad].l + Vectormath::idx_from_translations(geometry->n_cells, N, translations, quadruplets[iquad].d_l);
+
+                if ( check_atom_type(this->geometry->atom_types[ispin]) && check_atom_type(this->geometry->atom_types[jspin]) &&
+                     check_atom_type(this->geometry->atom_types[kspin]) && check_atom_type(this->geometry->atom_types[lspin]) )
+                {
+                    this->quadruplet_lattice_spins.insert(this->quadruplet_lattice_spins.end(), { ispin, jspin, kspin, lspin });
+                    this->quadruplet_lattice_magnitudes.push_back(quadruplet_magnitudes[iquad]);
+                }
+            }
+        }
+
+        // Memberships of each spin (a spin appearing twice in a quadruplet is listed once)
+        const int n_lattice_quadruplets = this->quadruplet_lattice_magnitudes.size();
+        auto is_repeated = [this](int idx)
+        {
+            for (int m = 4*(idx/4); m < idx; ++m)
+                if (this->quadruplet_lattice_spins[m] == this->quadruplet_lattice_spins[idx]) return true;
+            return false;
+        };
+        intfield n_memberships(nos, 0);
+        for (int idx = 0; idx < 4*n_lattice_quadruplets; ++idx)
+            if (!is_repeated(idx)) ++n_memberships[this->quadruplet_lattice_spins[idx]];
+
+        this->quadruplet_offsets = intfield(nos+1, 0);
+        for (int ispin = 0; ispin < nos; ++ispin)
+            this->quadruplet_offsets[ispin+1] = this->quadruplet_offsets[ispin] + n_memberships[ispin];
+
+        this->quadruplet_memberships = intfield(this->quadruplet_offsets[nos]);
+        intfield cursor(this->quadruplet_offsets.begin(), this->quadruplet_offsets.end()-1);
+        for (int idx = 0; idx < 4*n_lattice_quadruplets; ++idx)
+            if (!is_repeated(idx)) this->quadruplet_memberships[cursor[this->quadruplet_lattice_spins[idx]]++] = idx/4;
     }
 
     void Hamiltonian_Heisenberg::Update_Energy_Contributions()
@@ -197,7 +630,7 @@ namespace Engine
         }
         else this->idx_dmi = -1;
         // Dipole-Dipole
-        if (this->ddi_pairs.size() > 0)
+        if (this->ddi_method == DDI_Method::FFT || this->ddi_pairs.size() > 0)
         {
             this->energy_contributions_per_spin.push_back({"DD", scalarfield(0) });
             this->idx_ddi = this->energy_contributions_per_spin.size()-1;
@@ -279,75 +712,46 @@ namespace Engine
     void Hamiltonian_Heisenberg::E_Exchange(const vectorfield & spins, scalarfield & Energy)
     {
         #pragma omp parallel for
-        for (unsigned int icell = 0; icell < geometry->n_cells_total; ++icell)
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            for (unsigned int i_pair = 0; i_pair < exchange_pairs.size(); ++i_pair)
-            {
-                int ispin = exchange_pairs[i_pair].i + icell*geometry->n_cell_atoms;
-                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, exchange_pairs[i_pair]);
-                if (jspin >= 0)
-                {
-                    Energy[ispin] -= 0.5 * exchange_magnitudes[i_pair] * spins[ispin].dot(spins[jspin]);
-                    #ifndef _OPENMP
-                    Energy[jspin] -= 0.5 * exchange_magnitudes[i_pair] * spins[ispin].dot(spins[jspin]);
-                    #endif
-                }
-            }
+            for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+                Energy[ispin] -= 0.5 * exchange_partner_magnitudes[idx] * spins[ispin].dot(spins[exchange_partners[idx]]);
         }
     }
 
     void Hamiltonian_Heisenberg::E_DMI(const vectorfield & spins, scalarfield & Energy)
     {
         #pragma omp parallel for
-        for (unsigned int icell = 0; icell < geometry->n_cells_total; ++icell)
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            for (unsigned int i_pair = 0; i_pair < dmi_pairs.size(); ++i_pair)
-            {
-                int ispin = dmi_pairs[i_pair].i + icell*geometry->n_cell_atoms;
-                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[i_pair]);
-                if (jspin >= 0)
-                {
-                    Energy[ispin] -= 0.5 * dmi_magnitudes[i_pair] * dmi_normals[i_pair].dot(spins[ispin].cross(spins[jspin]));
-                    #ifndef _OPENMP
-                    Energy[jspin] -= 0.5 * dmi_magnitudes[i_pair] * dmi_normals[i_pair].dot(spins[ispin].cross(spins[jspin]));
-                    #endif
-                }
-            }
+            for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
+                Energy[ispin] -= 0.5 * dmi_partner_magnitudes[idx] * dmi_partner_normals[idx].dot(spins[ispin].cross(spins[dmi_partners[idx]]));
         }
     }
 
     void Hamiltonian_Heisenberg::E_DDI(const vectorfield & spins, scalarfield & Energy)
     {
-        // The translations are in angstr�m, so the |r|[m] becomes |r|[m]*10^-10
-        const scalar mult = mu_0 * std::pow(mu_B, 2) / ( 4*Pi * 1e-30 );
+        if (this->ddi_method == DDI_Method::FFT)
+        {
+            this->DDI_Field_FFT(spins, this->ddi_field);
 
-        scalar result = 0.0;
+            const int N = geometry->n_cell_atoms;
+            #pragma omp parallel for
+            for (int ispin = 0; ispin < geometry->nos; ++ispin)
+                Energy[ispin] -= 0.5 * this->mu_s[ispin % N] * spins[ispin].dot(this->ddi_field[ispin]);
+            return;
+        }
 
-        for (unsigned int i_pair = 0; i_pair < ddi_pairs.size(); ++i_pair)
+        // Each spin only accumulates its own partners, so no two threads write the same entry
+        #pragma omp parallel for
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            if (ddi_magnitudes[i_pair] > 0.0)
+            for (int idx = ddi_offsets[ispin]; idx < ddi_offsets[ispin+1]; ++idx)
             {
-                for (int da = 0; da < geometry->n_cells[0]; ++da)
-                {
-                    for (int db = 0; db < geometry->n_cells[1]; ++db)
-                    {
-                        for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
-                        {
-                            std::array<int, 3 > translations = { da, db, dc };
-                            int i = ddi_pairs[i_pair].i;
-                            int j = ddi_pairs[i_pair].j;
-                            int ispin = i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                            int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, ddi_pairs[i_pair]);
-                            if (jspin >= 0)
-                            {
-                                Energy[ispin] -= 0.5 * this->mu_s[i] * this->mu_s[j] * mult / std::pow(ddi_magnitudes[i_pair], 3.0) *
-                                    (3 * spins[ispin].dot(ddi_normals[i_pair]) * spins[ispin].dot(ddi_normals[i_pair]) - spins[ispin].dot(spins[ispin]));
-                                Energy[jspin] -= 0.5 * this->mu_s[i] * this->mu_s[j] * mult / std::pow(ddi_magnitudes[i_pair], 3.0) *
-                                    (3 * spins[ispin].dot(ddi_normals[i_pair]) * spins[ispin].dot(ddi_normals[i_pair]) - spins[ispin].dot(spins[ispin]));
-                            }
-                        }
-                    }
-                }
+                const Vector3 & s_j    = spins[ddi_partners[idx]];
+                const Vector3 & normal = ddi_partner_normals[idx];
+                Energy[ispin] -= 0.5 * ddi_partner_prefactors[idx] *
+                    (3 * spins[ispin].dot(normal) * s_j.dot(normal) - spins[ispin].dot(s_j));
             }
         }
     }// end DipoleDipole
@@ -355,57 +759,46 @@ namespace Engine
 
     void Hamiltonian_Heisenberg::E_Quadruplet(const vectorfield & spins, scalarfield & Energy)
     {
-        for (unsigned int iquad = 0; iquad < quadruplets.size(); ++iquad)
+        // Each spin only accumulates the quadruplets it is part of, so no two threads write the same entry
+        #pragma omp parallel for
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            for (int da = 0; da < geometry->n_cells[0]; ++da)
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
             {
-                for (int db = 0; db < geometry->n_cells[1]; ++db)
-                {
-                    for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
-                    {
-                        std::array<int, 3 > translations = { da, db, dc };
-                        int ispin = quadruplets[iquad].i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                        int jspin = quadruplets[iquad].j + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_j);
-                        int kspin = quadruplets[iquad].k + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_k);
-                        int lspin = quadruplets[iquad].l + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_l);
-                        
-                        if ( check_atom_type(this->geometry->atom_types[ispin]) && check_atom_type(this->geometry->atom_types[jspin]) &&
-                                check_atom_type(this->geometry->atom_types[kspin]) && check_atom_type(this->geometry->atom_types[lspin]) )
-                        {
-                            Energy[ispin] -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
-                            Energy[jspin] -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
-                            Energy[kspin] -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
-                            Energy[lspin] -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
-                        }
-                    }
-                }
+                int iquad = quadruplet_memberships[idx];
+                const int * q = &quadruplet_lattice_spins[4*iquad];
+                scalar E_quad = 0.25*quadruplet_lattice_magnitudes[iquad] * (spins[q[0]].dot(spins[q[1]])) * (spins[q[2]].dot(spins[q[3]]));
+                // Once per role of the spin in the quadruplet
+                for (int m = 0; m < 4; ++m)
+                    if (q[m] == ispin) Energy[ispin] -= E_quad;
             }
         }
     }
 
 
-    scalar Hamiltonian_Heisenberg::Energy_Single_Spin(int ispin_in, const vectorfield & spins)
+    scalar Hamiltonian_Heisenberg::Energy_Single_Spin(int ispin, const vectorfield & spins)
     {
-        int icell  = ispin_in / this->geometry->n_cell_atoms;
-        int ibasis = ispin_in - icell*this->geometry->n_cell_atoms;
+        // The share of spin ispin in the energy, i.e. the same terms as in Energy_Contributions_per_Spin.
+        // Only the interactions of this spin are visited, using the per-basis and per-spin tables.
+        const int N = geometry->n_cell_atoms;
+        const int ibasis = ispin % N;
+        const Vector3 & spin = spins[ispin];
         scalar Energy = 0;
 
-        // External field
-        if (this->idx_zeeman >= 0)
+        // Single spin interactions
+        if (check_atom_type(this->geometry->atom_types[ispin]))
         {
-            if (check_atom_type(this->geometry->atom_types[ispin_in]))
-                Energy -= this->mu_s[ibasis] * this->external_field_magnitude * this->external_field_normal.dot(spins[ispin_in]);
-        }
+            // External field
+            if (this->idx_zeeman >= 0)
+                Energy -= this->mu_s[ibasis] * this->external_field_magnitude * this->external_field_normal.dot(spin);
 
-        // Anisotropy
-        if (this->idx_anisotropy >= 0)
-        {
-            for (int iani = 0; iani < anisotropy_indices.size(); ++iani)
+            // Anisotropy
+            if (this->idx_anisotropy >= 0)
             {
-                if (anisotropy_indices[iani] == ibasis)
+                for (int idx = anisotropy_basis_offsets[ibasis]; idx < anisotropy_basis_offsets[ibasis+1]; ++idx)
                 {
-                    if (check_atom_type(this->geometry->atom_types[ispin_in]))
-                        Energy -= this->anisotropy_magnitudes[iani] * std::pow(anisotropy_normals[iani].dot(spins[ispin_in]), 2.0);
+                    int iani = anisotropy_basis_terms[idx];
+                    Energy -= this->anisotropy_magnitudes[iani] * std::pow(anisotropy_normals[iani].dot(spin), 2.0);
                 }
             }
         }
@@ -413,116 +806,368 @@ namespace Engine
         // Exchange
         if (this->idx_exchange >= 0)
         {
-            for (unsigned int ipair = 0; ipair < exchange_pairs.size(); ++ipair)
+            for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+                Energy -= 0.5 * exchange_partner_magnitudes[idx] * spin.dot(spins[exchange_partners[idx]]);
+        }
+
+        // DMI
+        if (this->idx_dmi >= 0)
+        {
+            for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
+                Energy -= 0.5 * dmi_partner_magnitudes[idx] * dmi_partner_normals[idx].dot(spin.cross(spins[dmi_partners[idx]]));
+        }
+
+        // DDI
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT)
+        {
+            // Direct summation of the same tensors as used in the convolution, which costs O(N)
+            if (check_atom_type(this->geometry->atom_types[ispin]))
             {
-                if (exchange_pairs[ipair].i == ibasis)
+                Vector3 field{0,0,0};
+                for (int jspin = 0; jspin < geometry->nos; ++jspin)
                 {
-                    int ispin = exchange_pairs[ipair].i + icell*geometry->n_cell_atoms;
-                    int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, exchange_pairs[ipair]);
-                    if (jspin >= 0)
-                    {
-                        Energy -= 0.5 * this->exchange_magnitudes[ipair] * spins[ispin].dot(spins[jspin]);
-                    }
-                    #ifndef _OPENMP
-                    jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, exchange_pairs[ipair], true);
-                    if (jspin >= 0)
-                    {
-                        Energy -= 0.5 * this->exchange_magnitudes[ipair] * spins[ispin].dot(spins[jspin]);
-                    }
-                    #endif
+                    if (check_atom_type(this->geometry->atom_types[jspin]))
+                        field += this->DDI_Tensor_FFT(ispin, jspin) * spins[jspin];
                 }
+                Energy -= 0.5 * this->mu_s[ibasis] * spin.dot(field);
+            }
+        }
+        else if (this->idx_ddi >= 0)
+        {
+            for (int idx = ddi_offsets[ispin]; idx < ddi_offsets[ispin+1]; ++idx)
+            {
+                const Vector3 & s_j    = spins[ddi_partners[idx]];
+                const Vector3 & normal = ddi_partner_normals[idx];
+                Energy -= 0.5 * ddi_partner_prefactors[idx] * (3 * spin.dot(normal) * s_j.dot(normal) - spin.dot(s_j));
             }
         }
 
-        // DMI
-        if (this->idx_dmi >= 0)
+        // Quadruplets
+        if (this->idx_quadruplet >= 0)
         {
-            for (unsigned int ipair = 0; ipair < dmi_pairs.size(); ++ipair)
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
             {
-                if (dmi_pairs[ipair].i == ibasis)
+                int iquad = quadruplet_memberships[idx];
+                const int * q = &quadruplet_lattice_spins[4*iquad];
+                scalar E_quad = 0.25*quadruplet_lattice_magnitudes[iquad] * (spins[q[0]].dot(spins[q[1]])) * (spins[q[2]].dot(spins[q[3]]));
+                // Once per role of the spin in the quadruplet
+                for (int m = 0; m < 4; ++m)
+                    if (q[m] == ispin) Energy -= E_quad;
+            }
+        }
+
+        return Energy;
+    }
+
+
+    Matrix3 Hamiltonian_Heisenberg::DDI_Tensor_Minimum_Image(int ibasis, int jbasis, std::array<int,3> translations)
+    {
+        // Map the translation into [-n/2, n/2] along periodic directions. For an even n, the
+        // translation n/2 has two images +-n/2, which both contribute with half the weight.
+        // This keeps the tensors symmetric, T_ij = T_ji, also between different basis atoms.
+        std::array<int,3> images[2] = { translations, translations };
+        int n_images[3] = { 1, 1, 1 };
+        for (int dim = 0; dim < 3; ++dim)
+        {
+            if (boundary_conditions[dim])
+            {
+                int n = geometry->n_cells[dim];
+                int t = ((translations[dim] % n) + n) % n;
+                if (2*t > n) t -= n;
+                images[0][dim] = t;
+                images[1][dim] = t;
+                if (2*t == n)
                 {
-                    int ispin = dmi_pairs[ipair].i + icell*geometry->n_cell_atoms;
-                    int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[ipair]);
-                    if (jspin >= 0)
-                    {
-                        Energy -= 0.5 * this->dmi_magnitudes[ipair] * this->dmi_normals[ipair].dot(spins[ispin].cross(spins[jspin]));
-                    }
-                    #ifndef _OPENMP
-                    jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[ipair], true);
-                    if (jspin >= 0)
-                    {
-                        Energy += 0.5 * this->dmi_magnitudes[ipair] * this->dmi_normals[ipair].dot(spins[ispin].cross(spins[jspin]));
-                    }
-                    #endif
+                    images[1][dim] = t - n;
+                    n_images[dim] = 2;
                 }
             }
         }
 
-        // DDI
-        if (this->idx_ddi >= 0)
+        Matrix3 tensor = Matrix3::Zero();
+        for (int a = 0; a < n_images[0]; ++a)
+        {
+            for (int b = 0; b < n_images[1]; ++b)
+            {
+                for (int c = 0; c < n_images[2]; ++c)
+                    tensor += this->DDI_Tensor(ibasis, jbasis, { images[a][0], images[b][1], images[c][2] });
+            }
+        }
+        return tensor / (n_images[0]*n_images[1]*n_images[2]);
+    }
+
+    Matrix3 Hamiltonian_Heisenberg::DDI_Tensor(int ibasis, int jbasis, std::array<int,3> translations)
+    {
+        // The translations are in angstrom, so the |r|[m] becomes |r|[m]*10^-10
+        const scalar mult = mu_0 * std::pow(mu_B, 2) / ( 4*Pi * 1e-30 );
+
+        scalar magnitude;
+        Vector3 normal;
+        Neighbours::DDI_from_Pair(*geometry, { ibasis, jbasis, translations }, magnitude, normal);
+
+        // No self-interaction and nothing beyond the (optional) cutoff
+        if (magnitude == 0 || (ddi_cutoff_radius > 0 && magnitude >= ddi_cutoff_radius))
+            return Matrix3::Zero();
+
+        return this->mu_s[jbasis] * mult / std::pow(magnitude, 3.0) * (3 * normal * normal.transpose() - Matrix3::Identity());
+    }
+
+    void Hamiltonian_Heisenberg::Update_DDI_FFT(bool transform_tensors)
+    {
+        const int N = geometry->n_cell_atoms;
+        const auto & n_cells = geometry->n_cells;
+
+        // Open directions are zero-padded to the next power of two which can hold all offsets
+        // -(n-1)...(n-1), so that the cyclic convolution does not wrap around and no Bluestein
+        // transform is needed. Periodic directions are used as they are.
+        std::array<int,3> n_cells_padded;
+        for (int dim = 0; dim < 3; ++dim)
         {
-            for (unsigned int ipair = 0; ipair < ddi_pairs.size(); ++ipair)
+            n_cells_padded[dim] = n_cells[dim];
+            if (!boundary_conditions[dim])
             {
-                if (ddi_pairs[ipair].i == ibasis)
+                n_cells_padded[dim] = 1;
+                while (n_cells_padded[dim] < 2*n_cells[dim]-1)
+                    n_cells_padded[dim] *= 2;
+            }
+        }
+
+        this->ddi_fft_plan   = FFT::FFT_Plan(n_cells_padded);
+        const int size = this->ddi_fft_plan.size;
+        this->ddi_fft_spins  = FFT::cpxfield(3*N*size);
+        this->ddi_fft_field  = FFT::cpxfield(3*N*size);
+        this->ddi_field      = vectorfield(geometry->nos);
+        if (!transform_tensors)
+            return;
+        this->ddi_fft_kernel = FFT::cpxfield(6*N*N*size);
+
+        const int alpha[6] = { 0, 0, 0, 1, 1, 2 };
+        const int beta[6]  = { 0, 1, 2, 1, 2, 2 };
+
+        #pragma omp parallel for
+        for (int idx = 0; idx < size; ++idx)
+        {
+            // Cell offset d = c_i - c_j of the convolution
+            std::array<int,3> d = { idx % n_cells_padded[0], (idx / n_cells_padded[0]) % n_cells_padded[1], idx / (n_cells_padded[0]*n_cells_padded[1]) };
+            bool valid = true;
+            for (int dim = 0; dim < 3; ++dim)
+            {
+                if (!boundary_conditions[dim] && d[dim] >= n_cells[dim])
                 {
-                    // The translations are in angstr�m, so the |r|[m] becomes |r|[m]*10^-10
-                    const scalar mult = 0.5 * this->mu_s[ddi_pairs[ipair].i] * this->mu_s[ddi_pairs[ipair].j]
-                        * Utility::Constants::mu_0 * std::pow(Utility::Constants::mu_B, 2) / ( 4*Utility::Constants::Pi * 1e-30 );
+                    d[dim] -= n_cells_padded[dim];
+                    // The offsets of the padding cannot occur between two spins of the lattice
+                    if (d[dim] <= -n_cells[dim]) valid = false;
+                }
+            }
 
-                    int ispin = ddi_pairs[ipair].i + icell*geometry->n_cell_atoms;
-                    int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, ddi_pairs[ipair]);
+            for (int ibasis = 0; ibasis < N; ++ibasis)
+            {
+                for (int jbasis = 0; jbasis < N; ++jbasis)
+                {
+                    Matrix3 tensor = Matrix3::Zero();
+                    if (valid)
+                        tensor = this->DDI_Tensor_Minimum_Image(ibasis, jbasis, { -d[0], -d[1], -d[2] });
+                    for (int comp = 0; comp < 6; ++comp)
+                        this->ddi_fft_kernel[((comp*N + ibasis)*N + jbasis)*size + idx] = tensor(alpha[comp], beta[comp]);
+                }
+            }
+        }
 
-                    if (jspin >= 0)
-                    {
-                        Energy -= mult / std::pow(this->ddi_magnitudes[ipair], 3.0) *
-                            (3 * spins[ispin].dot(this->ddi_normals[ipair]) * spins[ispin].dot(this->ddi_normals[ipair]) - spins[ispin].dot(spins[ispin]));
+        for (int block = 0; block < 6*N*N; ++block)
+            this->ddi_fft_plan.Forward(&this->ddi_fft_kernel[block*size]);
+    }
 
-                    }
-                    #ifndef _OPENMP
-                    jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[ipair], true);
-                    if (jspin >= 0)
+    Matrix3 Hamiltonian_Heisenberg::DDI_Tensor_FFT(int ispin, int jspin)
+    {
+        // The tensor of the cell translation c_j - c_i, with the same images as in the convolution
+        const int N = geometry->n_cell_atoms;
+        auto translations_i = Vectormath::translations_from_idx(geometry->n_cells, N, ispin);
+        auto translations_j = Vectormath::translations_from_idx(geometry->n_cells, N, jspin);
+        return this->DDI_Tensor_Minimum_Image(ispin % N, jspin % N,
+            { translations_j[0] - translations_i[0], translations_j[1] - translations_i[1], translations_j[2] - translations_i[2] });
+    }
+
+    void Hamiltonian_Heisenberg::DDI_Field_FFT(const vectorfield & spins, vectorfield & ddi_field)
+    {
+        const int N = geometry->n_cell_atoms;
+        const auto & n_cells = geometry->n_cells;
+        const auto & n_cells_padded = this->ddi_fft_plan.dims;
+        const int size = this->ddi_fft_plan.size;
+
+        // Index of the symmetric tensor component (alpha, beta)
+        const int comp[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+
+        // Place the spins on the padded lattice, leaving vacancies and padding at zero
+        std::fill(ddi_fft_spins.begin(), ddi_fft_spins.end(), FFT::FFT_cpx_type(0));
+        #pragma omp parallel for
+        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        {
+            int a = icell % n_cells[0];
+            int b = (icell / n_cells[0]) % n_cells[1];
+            int c = icell / (n_cells[0]*n_cells[1]);
+            int idx = a + n_cells_padded[0]*(b + n_cells_padded[1]*c);
+            for (int ibasis = 0; ibasis < N; ++ibasis)
+            {
+                int ispin = ibasis + N*icell;
+                if (check_atom_type(this->geometry->atom_types[ispin]))
+                {
+                    for (int dim = 0; dim < 3; ++dim)
+                        ddi_fft_spins[(dim*N + ibasis)*size + idx] = spins[ispin][dim];
+                }
+            }
+        }
+        for (int block = 0; block < 3*N; ++block)
+            this->ddi_fft_plan.Forward(&ddi_fft_spins[block*size]);
+
+        // The convolution is a product in reciprocal space
+        #pragma omp parallel for
+        for (int idx = 0; idx < size; ++idx)
+        {
+            for (int ibasis = 0; ibasis < N; ++ibasis)
+            {
+                for (int alpha = 0; alpha < 3; ++alpha)
+                {
+                    FFT::FFT_cpx_type h = 0;
+                    for (int jbasis = 0; jbasis < N; ++jbasis)
                     {
-                        Energy += mult / std::pow(this->ddi_magnitudes[ipair], 3.0) *
-                            (3 * spins[ispin].dot(this->ddi_normals[ipair]) * spins[ispin].dot(this->ddi_normals[ipair]) - spins[ispin].dot(spins[ispin]));
+                        for (int beta = 0; beta < 3; ++beta)
+                            h += ddi_fft_kernel[((comp[alpha][beta]*N + ibasis)*N + jbasis)*size + idx] * ddi_fft_spins[(beta*N + jbasis)*size + idx];
                     }
-                    #endif
+                    ddi_fft_field[(alpha*N + ibasis)*size + idx] = h;
                 }
             }
         }
+        for (int block = 0; block < 3*N; ++block)
+            this->ddi_fft_plan.Backward(&ddi_fft_field[block*size]);
 
-        // Quadruplets
-        if (this->idx_quadruplet >= 0) 
+        // Read the field back from the padded lattice
+        #pragma omp parallel for
+        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
         {
-            for (unsigned int iquad = 0; iquad < quadruplets.size(); ++iquad)
+            int a = icell % n_cells[0];
+            int b = (icell / n_cells[0]) % n_cells[1];
+            int c = icell / (n_cells[0]*n_cells[1]);
+            int idx = a + n_cells_padded[0]*(b + n_cells_padded[1]*c);
+            for (int ibasis = 0; ibasis < N; ++ibasis)
             {
-                auto translations = Vectormath::translations_from_idx(geometry->n_cells, geometry->n_cell_atoms, icell);
-                int ispin = quadruplets[iquad].i + icell*geometry->n_cell_atoms;
-                int jspin = quadruplets[iquad].j + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_j);
-                int kspin = quadruplets[iquad].k + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_k);
-                int lspin = quadruplets[iquad].l + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_l);
-                
-                if ( check_atom_type(this->geometry->atom_types[ispin]) && check_atom_type(this->geometry->atom_types[jspin]) &&
-                     check_atom_type(this->geometry->atom_types[kspin]) && check_atom_type(this->geometry->atom_types[lspin]) )
+                int ispin = ibasis + N*icell;
+                if (check_atom_type(this->geometry->atom_types[ispin]))
                 {
-                    Energy -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
+                    for (int dim = 0; dim < 3; ++dim)
+                        ddi_field[ispin][dim] = ddi_fft_field[(dim*N + ibasis)*size + idx].real();
                 }
+                else
+                    ddi_field[ispin] = Vector3::Zero();
+            }
+        }
+    }
+
+
+    void Hamiltonian_Heisenberg::Local_Fields(const vectorfield & spins, vectorfield & fields)
+    {
+        // The local fields are the negative gradient of the interactions between spins
+        Vectormath::fill(fields, {0,0,0});
+        this->Gradient_Exchange(spins, fields);
+        this->Gradient_DMI(spins, fields);
+        this->Gradient_DDI(spins, fields);
+        this->Gradient_Quadruplet(spins, fields);
+        Vectormath::scale(fields, -1);
+    }
+
+    scalar Hamiltonian_Heisenberg::Energy_Difference_Single_Spin(int ispin, const Vector3 & spin_new, const vectorfield & spins, const vectorfield & fields)
+    {
+        if (!check_atom_type(this->geometry->atom_types[ispin]))
+            return 0;
+
+        const int ibasis = ispin % geometry->n_cell_atoms;
+        const Vector3 & spin_old = spins[ispin];
+        const Vector3 spin_diff = spin_new - spin_old;
+
+        // All interactions between spins are linear in the spin
+        scalar Ediff = -spin_diff.dot(fields[ispin]);
+
+        // External field
+        if (this->idx_zeeman >= 0)
+            Ediff -= this->mu_s[ibasis] * this->external_field_magnitude * this->external_field_normal.dot(spin_diff);
+
+        // Anisotropy
+        for (int idx = anisotropy_basis_offsets[ibasis]; idx < anisotropy_basis_offsets[ibasis+1]; ++idx)
+        {
+            int iani = anisotropy_basis_terms[idx];
+            Ediff -= this->anisotropy_magnitudes[iani] *
+                (std::pow(anisotropy_normals[iani].dot(spin_new), 2.0) - std::pow(anisotropy_normals[iani].dot(spin_old), 2.0));
+        }
+
+        return Ediff;
+    }
+
+    Vector3 Hamiltonian_Heisenberg::Linear_Field_Single_Spin(int ispin, const vectorfield & /*spins*/, const vectorfield & fields)
+    {
+        if (!check_atom_type(this->geometry->atom_types[ispin]))
+            return Vector3{0,0,0};
+
+        // The interactions between spins and the external field
+        Vector3 field = fields[ispin];
+        if (this->idx_zeeman >= 0)
+            field += this->mu_s[ispin % geometry->n_cell_atoms] * this->external_field_magnitude * this->external_field_normal;
+        return field;
+    }
 
-                #ifndef _OPENMP
-                // TODO: mirrored quadruplet when unique quadruplets are used
-                // jspin = quadruplets[iquad].j + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_j, true);
-                // kspin = quadruplets[iquad].k + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_k, true);
-                // lspin = quadruplets[iquad].l + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_l, true);
-                
-                // if ( check_atom_type(this->geometry->atom_types[ispin]) && check_atom_type(this->geometry->atom_types[jspin]) &&
-                //      check_atom_type(this->geometry->atom_types[kspin]) && check_atom_type(this->geometry->atom_types[lspin]) )
-                // {
-                //     Energy -= 0.25*quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * (spins[kspin].dot(spins[lspin]));
-                // }
-                #endif
+    void Hamiltonian_Heisenberg::Update_Local_Fields(int ispin, const Vector3 & spin_old, const vectorfield & spins, vectorfield & fields)
+    {
+        const int N = geometry->n_cell_atoms;
+        const Vector3 spin_diff = spins[ispin] - spin_old;
+
+        // Exchange
+        for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+            fields[exchange_partners[idx]] += exchange_partner_magnitudes[idx] * spin_diff;
+
+        // DMI (the partner sees the inverted normal)
+        for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
+            fields[dmi_partners[idx]] += dmi_partner_magnitudes[idx] * dmi_partner_normals[idx].cross(spin_diff);
+
+        // DDI
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT)
+        {
+            // The long-range field of every spin changes, so each accepted step costs O(N)
+            for (int jspin = 0; jspin < geometry->nos; ++jspin)
+            {
+                if (check_atom_type(this->geometry->atom_types[jspin]))
+                    fields[jspin] += this->mu_s[jspin % N] * this->DDI_Tensor_FFT(jspin, ispin) * spin_diff;
+            }
+        }
+        else if (this->idx_ddi >= 0)
+        {
+            // The table is symmetric, so the partners of spin i are the spins which see it
+            for (int idx = ddi_offsets[ispin]; idx < ddi_offsets[ispin+1]; ++idx)
+            {
+                const Vector3 & normal = ddi_partner_normals[idx];
+                fields[ddi_partners[idx]] += ddi_partner_prefactors[idx] * (3 * normal * normal.dot(spin_diff) - spin_diff);
             }
         }
 
-        return Energy;
+        // Quadruplets: energy -K (s_i.s_j)(s_k.s_l), so the field of each member depends on the other three
+        for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
+        {
+            int iquad = quadruplet_memberships[idx];
+            const int * quad_spins = &quadruplet_lattice_spins[4*iquad];
+            std::array<Vector3, 4> s_new, s_old;
+            for (int m = 0; m < 4; ++m)
+            {
+                s_new[m] = spins[quad_spins[m]];
+                s_old[m] = quad_spins[m] == ispin ? spin_old : s_new[m];
+            }
+            const scalar K = quadruplet_lattice_magnitudes[iquad];
+            for (int m = 0; m < 4; ++m)
+            {
+                Vector3 field_diff;
+                if      (m == 0) field_diff = s_new[1] * s_new[2].dot(s_new[3]) - s_old[1] * s_old[2].dot(s_old[3]);
+                else if (m == 1) field_diff = s_new[0] * s_new[2].dot(s_new[3]) - s_old[0] * s_old[2].dot(s_old[3]);
+                else if (m == 2) field_diff = s_new[0].dot(s_new[1]) * s_new[3] - s_old[0].dot(s_old[1]) * s_old[3];
+                else             field_diff = s_new[0].dot(s_new[1]) * s_new[2] - s_old[0].dot(s_old[1]) * s_old[2];
+                fields[quad_spins[m]] += K * field_diff;
+            }
+        }
     }
 
 
@@ -548,6 +1193,76 @@ namespace Engine
         this->Gradient_Quadruplet(spins, gradient);
     }
 
+    scalar Hamiltonian_Heisenberg::Energy_and_Gradient(const vectorfield & spins, vectorfield & gradient)
+    {
+        // All terms of the energy are homogeneous in the spins, of first (Zeeman), second (anisotropy,
+        // pairs) or fourth (quadruplets) order. For a term of order p the share of a spin in the energy
+        // is s_i*dE/ds_i / p, so the energy follows from the gradient contributions of each spin.
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT)
+            this->DDI_Field_FFT(spins, this->ddi_field);
+
+        const int N = geometry->n_cell_atoms;
+        return Vectormath::block_sum(geometry->nos, scalar(0), [&](int ispin)
+        {
+            const int ibasis = ispin % N;
+            const Vector3 & spin = spins[ispin];
+            Vector3 gradient_1{0,0,0}, gradient_2{0,0,0}, gradient_4{0,0,0};
+
+            // Single spin interactions
+            if (check_atom_type(this->geometry->atom_types[ispin]))
+            {
+                // External field
+                if (this->idx_zeeman >= 0)
+                    gradient_1 -= this->mu_s[ibasis] * this->external_field_magnitude * this->external_field_normal;
+
+                // Anisotropy
+                for (int idx = anisotropy_basis_offsets[ibasis]; idx < anisotropy_basis_offsets[ibasis+1]; ++idx)
+                {
+                    int iani = anisotropy_basis_terms[idx];
+                    gradient_2 -= 2.0 * this->anisotropy_magnitudes[iani] * this->anisotropy_normals[iani] * anisotropy_normals[iani].dot(spin);
+                }
+            }
+
+            // Exchange
+            for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+                gradient_2 -= exchange_partner_magnitudes[idx] * spins[exchange_partners[idx]];
+
+            // DMI
+            for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
+                gradient_2 -= dmi_partner_magnitudes[idx] * spins[dmi_partners[idx]].cross(dmi_partner_normals[idx]);
+
+            // DDI
+            if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT)
+            {
+                gradient_2 -= this->mu_s[ibasis] * this->ddi_field[ispin];
+            }
+            else
+            {
+                for (int idx = ddi_offsets[ispin]; idx < ddi_offsets[ispin+1]; ++idx)
+                {
+                    const Vector3 & s_j    = spins[ddi_partners[idx]];
+                    const Vector3 & normal = ddi_partner_normals[idx];
+                    gradient_2 -= ddi_partner_prefactors[idx] * (3 * normal * s_j.dot(normal) - s_j);
+                }
+            }
+
+            // Quadruplets
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
+            {
+                int iquad = quadruplet_memberships[idx];
+                const int * q = &quadruplet_lattice_spins[4*iquad];
+                const scalar K = quadruplet_lattice_magnitudes[iquad];
+                if (q[0] == ispin) gradient_4 -= K * spins[q[1]] * (spins[q[2]].dot(spins[q[3]]));
+                if (q[1] == ispin) gradient_4 -= K * spins[q[0]] * (spins[q[2]].dot(spins[q[3]]));
+                if (q[2] == ispin) gradient_4 -= K * (spins[q[0]].dot(spins[q[1]])) * spins[q[3]];
+                if (q[3] == ispin) gradient_4 -= K * (spins[q[0]].dot(spins[q[1]])) * spins[q[2]];
+            }
+
+            gradient[ispin] = gradient_1 + gradient_2 + gradient_4;
+            return spin.dot(gradient_1 + 0.5*gradient_2 + 0.25*gradient_4);
+        });
+    }
+
     void Hamiltonian_Heisenberg::Gradient_Zeeman(vectorfield & gradient)
     {
         const int N = geometry->n_cell_atoms;
@@ -583,73 +1298,45 @@ namespace Engine
     void Hamiltonian_Heisenberg::Gradient_Exchange(const vectorfield & spins, vectorfield & gradient)
     {
         #pragma omp parallel for
-        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            for (unsigned int i_pair = 0; i_pair < exchange_pairs.size(); ++i_pair)
-            {
-                int ispin = exchange_pairs[i_pair].i + icell*geometry->n_cell_atoms;
-                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, exchange_pairs[i_pair]);
-                if (jspin >= 0)
-                {
-                    gradient[ispin] -= exchange_magnitudes[i_pair] * spins[jspin];
-                    #ifndef _OPENMP
-                    gradient[jspin] -= exchange_magnitudes[i_pair] * spins[ispin];
-                    #endif
-                }
-            }
+            for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+                gradient[ispin] -= exchange_partner_magnitudes[idx] * spins[exchange_partners[idx]];
         }
     }
 
     void Hamiltonian_Heisenberg::Gradient_DMI(const vectorfield & spins, vectorfield & gradient)
     {
         #pragma omp parallel for
-        for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            for (unsigned int i_pair = 0; i_pair < dmi_pairs.size(); ++i_pair)
-            {
-                int ispin = dmi_pairs[i_pair].i + icell*geometry->n_cell_atoms;
-                int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[i_pair]);
-                if (jspin >= 0)
-                {
-                    gradient[ispin] -= dmi_magnitudes[i_pair] * spins[jspin].cross(dmi_normals[i_pair]);
-                    #ifndef _OPENMP
-                    gradient[jspin] += dmi_magnitudes[i_pair] * spins[ispin].cross(dmi_normals[i_pair]);
-                    #endif
-                }
-            }
+            for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
+                gradient[ispin] -= dmi_partner_magnitudes[idx] * spins[dmi_partners[idx]].cross(dmi_partner_normals[idx]);
         }
     }
 
     void Hamiltonian_Heisenberg::Gradient_DDI(const vectorfield & spins, vectorfield & gradient)
     {
-        // The translations are in angstr�m, so the |r|[m] becomes |r|[m]*10^-10
-        const scalar mult = mu_0 * std::pow(mu_B, 2) / ( 4*Pi * 1e-30 );
-        
-        for (unsigned int i_pair = 0; i_pair < ddi_pairs.size(); ++i_pair)
+        if (this->ddi_method == DDI_Method::FFT)
+        {
+            this->DDI_Field_FFT(spins, this->ddi_field);
+
+            const int N = geometry->n_cell_atoms;
+            #pragma omp parallel for
+            for (int ispin = 0; ispin < geometry->nos; ++ispin)
+                gradient[ispin] -= this->mu_s[ispin % N] * this->ddi_field[ispin];
+            return;
+        }
+
+        // Each spin only accumulates its own partners, so no two threads write the same entry
+        #pragma omp parallel for
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            if (ddi_magnitudes[i_pair] > 0.0)
+            for (int idx = ddi_offsets[ispin]; idx < ddi_offsets[ispin+1]; ++idx)
             {
-                for (int da = 0; da < geometry->n_cells[0]; ++da)
-                {
-                    for (int db = 0; db < geometry->n_cells[1]; ++db)
-                    {
-                        for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
-                        {
-                            scalar skalar_contrib = mult / std::pow(ddi_magnitudes[i_pair], 3.0);
-                            std::array<int, 3 > translations = { da, db, dc };
-
-                            int i = ddi_pairs[i_pair].i;
-                            int j = ddi_pairs[i_pair].j;
-                            int ispin = i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);	
-                            int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, ddi_pairs[i_pair]);
-                            if (jspin >= 0)
-                            {
-                                gradient[ispin] -= this->mu_s[j] * skalar_contrib * (3 * ddi_normals[i_pair] * spins[jspin].dot(ddi_normals[i_pair]) - spins[jspin]);
-                                gradient[jspin] -= this->mu_s[i] * skalar_contrib * (3 * ddi_normals[i_pair] * spins[ispin].dot(ddi_normals[i_pair]) - spins[ispin]);
-                            }
-                        }
-                    }
-                }
+                const Vector3 & s_j    = spins[ddi_partners[idx]];
+                const Vector3 & normal = ddi_partner_normals[idx];
+                gradient[ispin] -= ddi_partner_prefactors[idx] * (3 * normal * s_j.dot(normal) - s_j);
             }
         }
     }//end Field_DipoleDipole
@@ -657,34 +1344,19 @@ namespace Engine
 
     void Hamiltonian_Heisenberg::Gradient_Quadruplet(const vectorfield & spins, vectorfield & gradient)
     {
-        for (unsigned int iquad = 0; iquad < quadruplets.size(); ++iquad)
+        // Each spin only accumulates the quadruplets it is part of, so no two threads write the same entry
+        #pragma omp parallel for
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
         {
-            int i = quadruplets[iquad].i;
-            int j = quadruplets[iquad].j;
-            int k = quadruplets[iquad].k;
-            int l = quadruplets[iquad].l;
-            for (int da = 0; da < geometry->n_cells[0]; ++da)
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
             {
-                for (int db = 0; db < geometry->n_cells[1]; ++db)
-                {
-                    for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
-                    {
-                        std::array<int, 3 > translations = { da, db, dc };
-                        int ispin = i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                        int jspin = j + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_j);
-                        int kspin = k + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_k);
-                        int lspin = l + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_l);
-                        
-                        if ( check_atom_type(this->geometry->atom_types[ispin]) && check_atom_type(this->geometry->atom_types[jspin]) &&
-                                check_atom_type(this->geometry->atom_types[kspin]) && check_atom_type(this->geometry->atom_types[lspin]) )
-                        {
-                            gradient[ispin] -= quadruplet_magnitudes[iquad] * spins[jspin] * (spins[kspin].dot(spins[lspin]));
-                            gradient[jspin] -= quadruplet_magnitudes[iquad] * spins[ispin] * (spins[kspin].dot(spins[lspin]));
-                            gradient[kspin] -= quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * spins[lspin];
-                            gradient[lspin] -= quadruplet_magnitudes[iquad] * (spins[ispin].dot(spins[jspin])) * spins[kspin];
-                        }
-                    }
-                }
+                int iquad = quadruplet_memberships[idx];
+                const int * q = &quadruplet_lattice_spins[4*iquad];
+                const scalar K = quadruplet_lattice_magnitudes[iquad];
+                if (q[0] == ispin) gradient[ispin] -= K * spins[q[1]] * (spins[q[2]].dot(spins[q[3]]));
+                if (q[1] == ispin) gradient[ispin] -= K * spins[q[0]] * (spins[q[2]].dot(spins[q[3]]));
+                if (q[2] == ispin) gradient[ispin] -= K * (spins[q[0]].dot(spins[q[1]])) * spins[q[3]];
+                if (q[3] == ispin) gradient[ispin] -= K * (spins[q[0]].dot(spins[q[1]])) * spins[q[2]];
             }
         }
     }
@@ -694,133 +1366,239 @@ namespace Engine
     {
         int nos = spins.size();
 
-        // Set to zero
-        hessian.setZero();
+        // Short-ranged interactions
+        std::vector<Eigen::Triplet<scalar>> triplets(0);
+        this->Hessian_Triplets(spins, triplets);
+        SpMatrixX hessian_sparse(3*nos, 3*nos);
+        hessian_sparse.setFromTriplets(triplets.begin(), triplets.end());
+        hessian = MatrixX(hessian_sparse);
 
-        // Single Spin elements
-        for (int da = 0; da < geometry->n_cells[0]; ++da)
+        // Without a cutoff, the FFT dipole-dipole interaction couples all spins
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT && this->ddi_cutoff_radius <= 0)
         {
-            for (int db = 0; db < geometry->n_cells[1]; ++db)
+            const int N = geometry->n_cell_atoms;
+            for (int ispin = 0; ispin < nos; ++ispin)
             {
-                for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
+                if (!check_atom_type(this->geometry->atom_types[ispin])) continue;
+                for (int jspin = 0; jspin < nos; ++jspin)
                 {
-                    std::array<int, 3 > translations = { da, db, dc };
-                    int icell = Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                    for (int alpha = 0; alpha < 3; ++alpha)
-                    {
-                        for ( int beta = 0; beta < 3; ++beta )
-                        {
-                            for (unsigned int i = 0; i < anisotropy_indices.size(); ++i)
-                            {
-                                if ( check_atom_type(this->geometry->atom_types[anisotropy_indices[i]]) )
-                                {
-                                    int idx_i = 3 * icell + anisotropy_indices[i] + alpha;
-                                    int idx_j = 3 * icell + anisotropy_indices[i] + beta;
-                                    // scalar x = -2.0*this->anisotropy_magnitudes[i] * std::pow(this->anisotropy_normals[i][alpha], 2);
-                                    hessian( idx_i, idx_j ) += -2.0 * this->anisotropy_magnitudes[i] * 
-                                                                    this->anisotropy_normals[i][alpha] * 
-                                                                    this->anisotropy_normals[i][beta];
-                                }
-                            }
-                        }
-                    }
+                    if (!check_atom_type(this->geometry->atom_types[jspin])) continue;
+                    hessian.block<3,3>(3*ispin, 3*jspin) -= this->mu_s[ispin % N] * this->DDI_Tensor_FFT(ispin, jspin);
                 }
             }
         }
+    }
 
-        // Spin Pair elements
-        // Exchange
-        for (int da = 0; da < geometry->n_cells[0]; ++da)
+    bool Hamiltonian_Heisenberg::Interaction_Graph(int nos, intfield & offsets, intfield & partners)
+    {
+        // The FFT dipole-dipole interaction couples all spins
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT)
+            return false;
+
+        offsets  = intfield(nos+1, 0);
+        partners = intfield(0);
+        intfield spin_partners(0);
+        for (int ispin = 0; ispin < nos; ++ispin)
+        {
+            // Union of the neighbour tables and the other members of the quadruplets
+            spin_partners.clear();
+            spin_partners.insert(spin_partners.end(), exchange_partners.begin() + exchange_offsets[ispin], exchange_partners.begin() + exchange_offsets[ispin+1]);
+            spin_partners.insert(spin_partners.end(), dmi_partners.begin() + dmi_offsets[ispin], dmi_partners.begin() + dmi_offsets[ispin+1]);
+            spin_partners.insert(spin_partners.end(), ddi_partners.begin() + ddi_offsets[ispin], ddi_partners.begin() + ddi_offsets[ispin+1]);
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
+            {
+                const int * q = &quadruplet_lattice_spins[4*quadruplet_memberships[idx]];
+                spin_partners.insert(spin_partners.end(), q, q+4);
+            }
+
+            std::sort(spin_partners.begin(), spin_partners.end());
+            for (unsigned int idx = 0; idx < spin_partners.size(); ++idx)
+            {
+                if (spin_partners[idx] != ispin && (idx == 0 || spin_partners[idx] != spin_partners[idx-1]))
+                    partners.push_back(spin_partners[idx]);
+            }
+            offsets[ispin+1] = partners.size();
+        }
+        return true;
+    }
+
+    bool Hamiltonian_Heisenberg::Exchange_Graph(int /*nos*/, intfield & offsets, intfield & partners, scalarfield & magnitudes)
+    {
+        if (this->idx_exchange < 0)
+            return false;
+
+        offsets    = this->exchange_offsets;
+        partners   = this->exchange_partners;
+        magnitudes = this->exchange_partner_magnitudes;
+        return true;
+    }
+
+    void Hamiltonian_Heisenberg::Sparse_Hessian(const vectorfield & spins, SpMatrixX & hessian)
+    {
+        int nos = spins.size();
+
+        // The FFT dipole-dipole interaction couples all spins, so its Hessian is dense
+        if (this->idx_ddi >= 0 && this->ddi_method == DDI_Method::FFT && this->ddi_cutoff_radius <= 0)
+            spirit_throw(Exception_Classifier::Not_Implemented, Log_Level::Error,
+                "The sparse Hessian is not available for the FFT dipole-dipole interaction without a cutoff radius");
+
+        std::vector<Eigen::Triplet<scalar>> triplets(0);
+        this->Hessian_Triplets(spins, triplets);
+        hessian.resize(3*nos, 3*nos);
+        hessian.setFromTriplets(triplets.begin(), triplets.end());
+    }
+
+    void Hamiltonian_Heisenberg::Hessian_Vector_Product(const vectorfield & spins, const vectorfield & vectors, vectorfield & product)
+    {
+        // Anisotropy, exchange, DMI and DDI are bilinear in the spins, so their Hessian applied
+        // to a vector field is their gradient kernel evaluated on that vector field
+        Vectormath::fill(product, {0,0,0});
+        this->Gradient_Anisotropy(vectors, product);
+        this->Gradient_Exchange(vectors, product);
+        this->Gradient_DMI(vectors, product);
+        this->Gradient_DDI(vectors, product);
+
+        // Quadruplets: energy -K (s_i.s_j)(s_k.s_l)
+        #pragma omp parallel for
+        for (int ispin = 0; ispin < geometry->nos; ++ispin)
+        {
+            for (int idx = quadruplet_offsets[ispin]; idx < quadruplet_offsets[ispin+1]; ++idx)
+            {
+                int iquad = quadruplet_memberships[idx];
+                const int * q = &quadruplet_lattice_spins[4*iquad];
+                const scalar K = quadruplet_lattice_magnitudes[iquad];
+                const Vector3 & s_i = spins[q[0]];
+                const Vector3 & s_j = spins[q[1]];
+                const Vector3 & s_k = spins[q[2]];
+                const Vector3 & s_l = spins[q[3]];
+                const Vector3 & v_i = vectors[q[0]];
+                const Vector3 & v_j = vectors[q[1]];
+                const Vector3 & v_k = vectors[q[2]];
+                const Vector3 & v_l = vectors[q[3]];
+
+                if (q[0] == ispin) product[ispin] -= K * ( v_j * s_k.dot(s_l) + s_j * (s_l.dot(v_k) + s_k.dot(v_l)) );
+                if (q[1] == ispin) product[ispin] -= K * ( v_i * s_k.dot(s_l) + s_i * (s_l.dot(v_k) + s_k.dot(v_l)) );
+                if (q[2] == ispin) product[ispin] -= K * ( v_l * s_i.dot(s_j) + s_l * (s_j.dot(v_i) + s_i.dot(v_j)) );
+                if (q[3] == ispin) product[ispin] -= K * ( v_k * s_i.dot(s_j) + s_k * (s_j.dot(v_i) + s_i.dot(v_j)) );
+            }
+        }
+    }
+
+    void Hamiltonian_Heisenberg::Hessian_Triplets(const vectorfield & spins, std::vector<Eigen::Triplet<scalar>> & triplets)
+    {
+        const int nos = spins.size();
+        const int N   = geometry->n_cell_atoms;
+
+        // Adds a 3x3 block (entries which are zero by construction are skipped)
+        auto add_block = [&triplets](int ispin, int jspin, const Matrix3 & block)
         {
-            for (int db = 0; db < geometry->n_cells[1]; ++db)
+            for (int alpha = 0; alpha < 3; ++alpha)
             {
-                for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
+                for (int beta = 0; beta < 3; ++beta)
                 {
-                    std::array<int, 3 > translations = { da, db, dc };
-                    for (unsigned int i_pair = 0; i_pair < this->exchange_pairs.size(); ++i_pair)
-                    {
-                        int ispin = exchange_pairs[i_pair].i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                        int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, exchange_pairs[i_pair]);
-                        if (jspin >= 0)
-                        {
-                            for (int alpha = 0; alpha < 3; ++alpha)
-                            {
-                                int i = 3 * ispin + alpha;
-                                int j = 3 * jspin + alpha;
-
-                                hessian(i, j) += -exchange_magnitudes[i_pair];
-                                #ifndef _OPENMP
-                                hessian(j, i) += -exchange_magnitudes[i_pair];
-                                #endif
-                            }
-                        }
-                    }
+                    if (block(alpha, beta) != 0)
+                        triplets.push_back({ 3*ispin + alpha, 3*jspin + beta, block(alpha, beta) });
                 }
             }
+        };
+
+        // Anisotropy
+        for (int ispin = 0; ispin < nos; ++ispin)
+        {
+            if (!check_atom_type(this->geometry->atom_types[ispin])) continue;
+            const int ibasis = ispin % N;
+            for (int idx = anisotropy_basis_offsets[ibasis]; idx < anisotropy_basis_offsets[ibasis+1]; ++idx)
+            {
+                int iani = anisotropy_basis_terms[idx];
+                add_block(ispin, ispin, -2.0 * this->anisotropy_magnitudes[iani] * this->anisotropy_normals[iani] * this->anisotropy_normals[iani].transpose());
+            }
+        }
+
+        // Exchange
+        for (int ispin = 0; ispin < nos; ++ispin)
+        {
+            for (int idx = exchange_offsets[ispin]; idx < exchange_offsets[ispin+1]; ++idx)
+                add_block(ispin, exchange_partners[idx], -exchange_partner_magnitudes[idx] * Matrix3::Identity());
         }
 
         // DMI
-        for (int da = 0; da < geometry->n_cells[0]; ++da)
+        for (int ispin = 0; ispin < nos; ++ispin)
         {
-            for (int db = 0; db < geometry->n_cells[1]; ++db)
+            for (int idx = dmi_offsets[ispin]; idx < dmi_offsets[ispin+1]; ++idx)
             {
-                for (int dc = 0; dc < geometry->n_cells[2]; ++dc)
+                const Vector3 & normal = dmi_partner_normals[idx];
+                Matrix3 cross_matrix;
+                cross_matrix <<          0, -normal[2],  normal[1],
+                                 normal[2],          0, -normal[0],
+                                -normal[1],  normal[0],          0;
+                add_block(ispin, dmi_partners[idx], dmi_partner_magnitudes[idx] * cross_matrix);
+            }
+        }
+
+        // Dipole-Dipole
+        if (this->idx_ddi >= 0)
+        {
+            // With the FFT method, only the pairs within the cutoff radius (if any) are sparse
+            pairfield   pairs      = this->ddi_pairs;
+            scalarfield magnitudes = this->ddi_magnitudes;
+            vectorfield normals    = this->ddi_normals;
+            if (this->ddi_method == DDI_Method::FFT)
+            {
+                pairs = pairfield(0);
+                if (this->ddi_cutoff_radius > 0)
+                    pairs = Neighbours::Get_Pairs_in_Radius(*this->geometry, this->ddi_cutoff_radius);
+                magnitudes = scalarfield(pairs.size());
+                normals    = vectorfield(pairs.size());
+                for (unsigned int ipair = 0; ipair < pairs.size(); ++ipair)
+                    Neighbours::DDI_from_Pair(*this->geometry, { pairs[ipair].i, pairs[ipair].j, pairs[ipair].translations },
+                        magnitudes[ipair], normals[ipair]);
+            }
+
+            // The translations are in angstrom, so the |r|[m] becomes |r|[m]*10^-10
+            const scalar mult = mu_0 * std::pow(mu_B, 2) / ( 4*Pi * 1e-30 );
+
+            // The pairs are redundant, so each spin only adds its own blocks
+            for (int ispin = 0; ispin < nos; ++ispin)
+            {
+                for (unsigned int ipair = 0; ipair < pairs.size(); ++ipair)
                 {
-                    std::array<int, 3 > translations = { da, db, dc };
-                    for (unsigned int i_pair = 0; i_pair < this->dmi_pairs.size(); ++i_pair)
+                    if (pairs[ipair].i == ispin % N && magnitudes[ipair] > 0.0)
                     {
-                        int ispin = dmi_pairs[i_pair].i + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations);
-                        int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, dmi_pairs[i_pair]);
+                        int jspin = idx_from_pair(ispin, boundary_conditions, geometry->n_cells, N, geometry->atom_types, pairs[ipair]);
                         if (jspin >= 0)
                         {
-                            int i = 3*ispin;
-                            int j = 3*jspin;
-
-                            hessian(i+2, j+1) +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][0];
-                            hessian(i+1, j+2) += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][0];
-                            hessian(i, j+2)   +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][1];
-                            hessian(i+2, j)   += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][1];
-                            hessian(i+1, j)   +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][2];
-                            hessian(i, j+1)   += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][2];
-
-                            #ifndef _OPENMP
-                            hessian(j+1, i+2) +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][0];
-                            hessian(j+2, i+1) += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][0];
-                            hessian(j+2, i)   +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][1];
-                            hessian(j, i+2)   += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][1];
-                            hessian(j, i+1)   +=  dmi_magnitudes[i_pair] * dmi_normals[i_pair][2];
-                            hessian(j+1, i)   += -dmi_magnitudes[i_pair] * dmi_normals[i_pair][2];
-                            #endif
+                            const Vector3 & normal = normals[ipair];
+                            add_block(ispin, jspin, -this->mu_s[pairs[ipair].i] * this->mu_s[pairs[ipair].j] * mult / std::pow(magnitudes[ipair], 3.0) *
+                                (3 * normal * normal.transpose() - Matrix3::Identity()));
                         }
                     }
                 }
             }
         }
 
-        //// Dipole-Dipole
-        //for (unsigned int i_pair = 0; i_pair < this->DD_indices.size(); ++i_pair)
-        //{
-        //	// indices
-        //	int idx_1 = DD_indices[i_pair][0];
-        //	int idx_2 = DD_indices[i_pair][1];
-        //	// prefactor
-        //	scalar prefactor = 0.0536814951168
-        //		* this->mu_s[idx_1] * this->mu_s[idx_2]
-        //		/ std::pow(DD_magnitude[i_pair], 3);
-        //	// components
-        //	for (int alpha = 0; alpha < 3; ++alpha)
-        //	{
-        //		for (int beta = 0; beta < 3; ++beta)
-        //		{
-        //			int idx_h = idx_1 + alpha*nos + 3 * nos*(idx_2 + beta*nos);
-        //			if (alpha == beta)
-        //				hessian[idx_h] += prefactor;
-        //			hessian[idx_h] += -3.0*prefactor*DD_normal[i_pair][alpha] * DD_normal[i_pair][beta];
-        //		}
-        //	}
-        //}
-
-        // Quadruplets
+        // Quadruplets: energy -K (s_i.s_j)(s_k.s_l)
+        for (unsigned int iquad = 0; iquad < quadruplet_lattice_magnitudes.size(); ++iquad)
+        {
+            const int * q = &quadruplet_lattice_spins[4*iquad];
+            const scalar K = quadruplet_lattice_magnitudes[iquad];
+            const Vector3 & s_i = spins[q[0]];
+            const Vector3 & s_j = spins[q[1]];
+            const Vector3 & s_k = spins[q[2]];
+            const Vector3 & s_l = spins[q[3]];
+
+            std::array<std::pair<std::array<int,2>, Matrix3>, 6> blocks{{
+                { {{0, 1}}, -K * s_k.dot(s_l) * Matrix3::Identity() },
+                { {{2, 3}}, -K * s_i.dot(s_j) * Matrix3::Identity() },
+                { {{0, 2}}, -K * s_j * s_l.transpose() },
+                { {{0, 3}}, -K * s_j * s_k.transpose() },
+                { {{1, 2}}, -K * s_i * s_l.transpose() },
+                { {{1, 3}}, -K * s_i * s_k.transpose() } }};
+            for (auto & block : blocks)
+            {
+                add_block(q[block.first[0]], q[block.first[1]], block.second);
+                add_block(q[block.first[1]], q[block.first[0]], block.second.transpose());
+            }
+        }
     }
 
     // Hamiltonian name as string
@@ -5,9 +5,13 @@
 #include <engine/Neighbours.hpp>
 #include <data/Spin_System.hpp>
 #include <utility/Constants.hpp>
+#include <utility/Logging.hpp>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <vector>
+
 using namespace Data;
 using namespace Utility;
 using Utility::Constants::mu_B;
@@ -25,10 +29,11 @@ namespace Engine
         intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
         pairfield exchange_pairs, scalarfield exchange_magnitudes,
         pairfield dmi_pairs, scalarfield dmi_magnitudes, vectorfield dmi_normals,
-        scalar ddi_radius,
+        DDI_Method ddi_method, scalar ddi_radius,
         quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
         std::shared_ptr<Data::Geometry> geometry,
-        intfield boundary_conditions
+        intfield boundary_conditions,
+        std::string interaction_cache_file
     ) :
         Hamiltonian(boundary_conditions),
         geometry(geometry),
@@ -38,7 +43,8 @@ namespace Engine
         exchange_pairs_in(exchange_pairs), exchange_magnitudes_in(exchange_magnitudes), exchange_shell_magnitudes(0),
         dmi_pairs_in(dmi_pairs), dmi_magnitudes_in(dmi_magnitudes), dmi_normals_in(dmi_normals), dmi_shell_magnitudes(0), dmi_shell_chirality(0),
         quadruplets(quadruplets), quadruplet_magnitudes(quadruplet_magnitudes),
-        ddi_cutoff_radius(ddi_radius)
+        ddi_method(ddi_method), ddi_cutoff_radius(ddi_radius),
+        interaction_cache_file(interaction_cache_file)
     {
         // Generate interaction pairs, constants etc.
         this->Update_Interactions();
@@ -51,10 +57,11 @@ namespace Engine
         intfield anisotropy_indices, scalarfield anisotropy_magnitudes, vectorfield anisotropy_normals,
         scalarfield exchange_shell_magnitudes,
         scalarfield dmi_shell_magnitudes, int dm_chirality,
-        scalar ddi_radius,
+        DDI_Method ddi_method, scalar ddi_radius,
         quadrupletfield quadruplets, scalarfield quadruplet_magnitudes,
         std::shared_ptr<Data::Geometry> geometry,
-        intfield boundary_conditions
+        intfield boundary_conditions,
+        std::string interaction_cache_file
     ) :
         Hamiltonian(boundary_conditions),
         geometry(geometry),
@@ -64,7 +71,8 @@ namespace Engine
         exchange_pairs_in(0), exchange_magnitudes_in(0), exchange_shell_magnitudes(exchange_shell_magnitudes),
         dmi_pairs_in(0), dmi_magnitudes_in(0), dmi_normals_in(0), dmi_shell_magnitudes(dmi_shell_magnitudes), dmi_shell_chirality(dm_chirality),
         quadruplets(quadruplets), quadruplet_magnitudes(quadruplet_magnitudes),
-        ddi_cutoff_radius(ddi_radius)
+        ddi_method(ddi_method), ddi_cutoff_radius(ddi_radius),
+        interaction_cache_file(interaction_cache_file)
     {
         // Generate interaction pairs, constants etc.
         this->Update_Interactions();
@@ -73,6 +81,9 @@ namespace Engine
 
     void Hamiltonian_Heisenberg::Update_Interactions()
     {
+        if (this->interaction_cache_file != "")
+            Log(Log_Level::Warning, Log_Sender::All, "The interaction cache is not available with CUDA, building the interactions");
+
         // When parallelising (cuda or openmp), we need all neighbours per spin
         const bool use_redundant_neighbours = true;
 
@@ -137,7 +148,14 @@ namespace Engine
             }
         }
 
+        this->Build_Anisotropy_Table();
+
         // Dipole-dipole
+        if (this->ddi_method == DDI_Method::FFT)
+        {
+            Log(Log_Level::Warning, Log_Sender::All, "The FFT dipole-dipole method is not available with CUDA, using the cutoff method");
+            this->ddi_method = DDI_Method::Cutoff;
+        }
         this->ddi_pairs      = Engine::Neighbours::Get_Pairs_in_Radius(*this->geometry, this->ddi_cutoff_radius);
         this->ddi_magnitudes = scalarfield(this->ddi_pairs.size());
         this->ddi_normals    = vectorfield(this->ddi_pairs.size());
@@ -154,6 +172,32 @@ namespace Engine
         }
     }
 
+    void Hamiltonian_Heisenberg::Build_Anisotropy_Table()
+    {
+        const int N = geometry->n_cell_atoms;
+
+        // Count the axes of each basis atom
+        this->anisotropy_basis_offsets = intfield(N+1, 0);
+        for (unsigned int iani = 0; iani < anisotropy_indices.size(); ++iani)
+        {
+            int ibasis = anisotropy_indices[iani];
+            if (ibasis >= 0 && ibasis < N)
+                ++anisotropy_basis_offsets[ibasis+1];
+        }
+        for (int ibasis = 0; ibasis < N; ++ibasis)
+            anisotropy_basis_offsets[ibasis+1] += anisotropy_basis_offsets[ibasis];
+
+        // Fill in the indices of the axes, keeping their order
+        this->anisotropy_basis_terms = intfield(anisotropy_basis_offsets[N]);
+        intfield fill(anisotropy_basis_offsets.begin(), anisotropy_basis_offsets.end()-1);
+        for (unsigned int iani = 0; iani < anisotropy_indices.size(); ++iani)
+        {
+            int ibasis = anisotropy_indices[iani];
+            if (ibasis >= 0 && ibasis < N)
+                anisotropy_basis_terms[fill[ibasis]++] = iani;
+        }
+    }
+
     void Hamiltonian_Heisenberg::Update_Energy_Contributions()
     {
         this->energy_contributions_per_spin = std::vector<std::pair<std::string, scalarfield>>(0);
@@ -416,12 +460,12 @@ namespace Engine
         // Anisotropy
         if (this->idx_anisotropy >= 0)
         {
-            for (int iani = 0; iani < anisotropy_indices.size(); ++iani)
+            if (check_atom_type(this->geometry->atom_types[ispin_in]))
             {
-                if (anisotropy_indices[iani] == ibasis)
+                for (int idx = anisotropy_basis_offsets[ibasis]; idx < anisotropy_basis_offsets[ibasis+1]; ++idx)
                 {
-                    if (check_atom_type(this->geometry->atom_types[ispin_in]))
-                        Energy -= this->anisotropy_magnitudes[iani] * std::pow(anisotropy_normals[iani].dot(spins[ispin_in]), 2.0);
+                    int iani = anisotropy_basis_terms[idx];
+                    Energy -= this->anisotropy_magnitudes[iani] * std::pow(anisotropy_normals[iani].dot(spins[ispin_in]), 2.0);
                 }
             }
         }
@@ -506,6 +550,28 @@ namespace Engine
     }
 
 
+    // The local field cache is not yet available on the GPU
+    void Hamiltonian_Heisenberg::Local_Fields(const vectorfield & spins, vectorfield & fields)
+    {
+        Hamiltonian::Local_Fields(spins, fields);
+    }
+
+    scalar Hamiltonian_Heisenberg::Energy_Difference_Single_Spin(int ispin, const Vector3 & spin_new, const vectorfield & spins, const vectorfield & fields)
+    {
+        return Hamiltonian::Energy_Difference_Single_Spin(ispin, spin_new, spins, fields);
+    }
+
+    void Hamiltonian_Heisenberg::Update_Local_Fields(int ispin, const Vector3 & spin_old, const vectorfield & spins, vectorfield & fields)
+    {
+        Hamiltonian::Update_Local_Fields(ispin, spin_old, spins, fields);
+    }
+
+    Vector3 Hamiltonian_Heisenberg::Linear_Field_Single_Spin(int ispin, const vectorfield & spins, const vectorfield & fields)
+    {
+        return Hamiltonian::Linear_Field_Single_Spin(ispin, spins, fields);
+    }
+
+
     void Hamiltonian_Heisenberg::Gradient(const vectorfield & spins, vectorfield & gradient)
     {
         // Set to zero
@@ -839,6 +905,91 @@ namespace Engine
         // Quadruplets
     }
 
+    bool Hamiltonian_Heisenberg::Interaction_Graph(int nos, intfield & offsets, intfield & partners)
+    {
+        // The dipole-dipole interaction always uses the cutoff method with CUDA, so the interactions are
+        // given by the pairs and quadruplets. Each interaction is added in both directions.
+        std::vector<intfield> spin_partners(nos, intfield(0));
+        auto add_pairs = [&] (const pairfield & pairs)
+        {
+            for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+            {
+                for (unsigned int ipair = 0; ipair < pairs.size(); ++ipair)
+                {
+                    int ispin = pairs[ipair].i + icell*geometry->n_cell_atoms;
+                    int jspin = Vectormath::idx_from_pair(ispin, boundary_conditions, geometry->n_cells, geometry->n_cell_atoms, geometry->atom_types, pairs[ipair]);
+                    if (jspin >= 0)
+                    {
+                        spin_partners[ispin].push_back(jspin);
+                        spin_partners[jspin].push_back(ispin);
+                    }
+                }
+            }
+        };
+        if (this->idx_exchange >= 0) add_pairs(exchange_pairs);
+        if (this->idx_dmi >= 0)      add_pairs(dmi_pairs);
+        if (this->idx_ddi >= 0)      add_pairs(ddi_pairs);
+
+        // Quadruplets, indexed as in Energy_Single_Spin
+        if (this->idx_quadruplet >= 0)
+        {
+            for (int icell = 0; icell < geometry->n_cells_total; ++icell)
+            {
+                auto translations = Vectormath::translations_from_idx(geometry->n_cells, geometry->n_cell_atoms, icell);
+                for (unsigned int iquad = 0; iquad < quadruplets.size(); ++iquad)
+                {
+                    int q[4] = { quadruplets[iquad].i + icell*geometry->n_cell_atoms,
+                        quadruplets[iquad].j + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_j),
+                        quadruplets[iquad].k + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_k),
+                        quadruplets[iquad].l + Vectormath::idx_from_translations(geometry->n_cells, geometry->n_cell_atoms, translations, quadruplets[iquad].d_l) };
+                    for (int a = 0; a < 4; ++a)
+                    {
+                        for (int b = 0; b < 4; ++b)
+                        {
+                            if (q[a] >= 0 && q[a] < nos && q[b] >= 0 && q[b] < nos)
+                                spin_partners[q[a]].push_back(q[b]);
+                        }
+                    }
+                }
+            }
+        }
+
+        offsets  = intfield(nos+1, 0);
+        partners = intfield(0);
+        for (int ispin = 0; ispin < nos; ++ispin)
+        {
+            auto& p = spin_partners[ispin];
+            std::sort(p.begin(), p.end());
+            for (unsigned int idx = 0; idx < p.size(); ++idx)
+            {
+                if (p[idx] != ispin && (idx == 0 || p[idx] != p[idx-1]))
+                    partners.push_back(p[idx]);
+            }
+            offsets[ispin+1] = partners.size();
+        }
+        return true;
+    }
+
+    bool Hamiltonian_Heisenberg::Exchange_Graph(int nos, intfield & offsets, intfield & partners, scalarfield & magnitudes)
+    {
+        return Hamiltonian::Exchange_Graph(nos, offsets, partners, magnitudes);
+    }
+
+    void Hamiltonian_Heisenberg::Sparse_Hessian(const vectorfield & spins, SpMatrixX & hessian)
+    {
+        Hamiltonian::Sparse_Hessian(spins, hessian);
+    }
+
+    void Hamiltonian_Heisenberg::Hessian_Vector_Product(const vectorfield & spins, const vectorfield & vectors, vectorfield & product)
+    {
+        Hamiltonian::Hessian_Vector_Product(spins, vectors, product);
+    }
+
+    scalar Hamiltonian_Heisenberg::Energy_and_Gradient(const vectorfield & spins, vectorfield & gradient)
+    {
+        return Hamiltonian::Energy_and_Gradient(spins, gradient);
+    }
+
     // Hamiltonian name as string
     static const std::string name = "Heisenberg";
     const std::string& Hamiltonian_Heisenberg::Name() { return name; }
@@ -87,10 +87,8 @@ namespace Engine
 
 		scalar dist_geodesic(const vectorfield & v1, const vectorfield & v2)
 		{
-			scalar dist = 0;
-            #pragma omp parallel for reduction(+:dist)
-			for (unsigned int i = 0; i < v1.size(); ++i)
-				dist += pow(dist_greatcircle(v1[i], v2[i]), 2);
+			scalar dist = Vectormath::block_sum(v1.size(), scalar(0),
+				[&](int i) { return pow(dist_greatcircle(v1[i], v2[i]), 2); });
 			return sqrt(dist);
 		}
 
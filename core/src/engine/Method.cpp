@@ -57,6 +57,9 @@ namespace Engine
         //---- Log messages
         this->Message_Start();
 
+        //---- The observables may be outdated, e.g. if the spins were changed from outside
+        for (auto& system : this->systems) system->InvalidateObservables();
+
         //---- Initial save
         this->Save_Current(this->starttime, this->iteration, true, false);
 
@@ -75,6 +78,8 @@ namespace Engine
             this->Hook_Pre_Iteration();
             // Do one single Iteration
             this->Iteration();
+            // The spins have changed, the observables are calculated again when they are needed
+            for (auto& system : this->systems) system->InvalidateObservables();
             // Post-iteration hook
             this->Hook_Post_Iteration();
 
@@ -57,8 +57,11 @@ namespace Engine
         this->Initialize();
 
         // Calculate Data for the border images, which will not be updated
-        this->chain->images[0]->UpdateEffectiveField();// hamiltonian->Effective_Field(image, this->chain->images[0]->effective_field);
-        this->chain->images[this->noi-1]->UpdateEffectiveField();//hamiltonian->Effective_Field(image, this->chain->images[0]->effective_field);
+        for (int img : {0, this->noi-1})
+        {
+            this->chain->images[img]->InvalidateObservables();
+            this->chain->images[img]->UpdateEffectiveField();
+        }
     }
 
     template <Solver solver>
@@ -76,22 +79,36 @@ namespace Engine
         // We assume here that we receive a vector of configurations that corresponds to the vector of systems we gave the Solver.
         //		The Solver shuld respect this, but there is no way to enforce it.
         // Get Energy and Gradient of configurations
-        for (int img = 0; img < chain->noi; ++img)
+        //      The distances to the previous images are stored in Rx and summed up afterwards
+        this->For_Each_Image(0, chain->noi, [&](int img)
         {
             auto& image = *configurations[img];
+            auto& system = *this->chain->images[img];
 
-            // Calculate the Energy of the image
-            energies[img] = this->chain->images[img]->hamiltonian->Energy(image);
+            // Calculate the Energy of the image and, except for the fixed end points, the gradient
+            // in the same pass. We keep the effective field so that it can be e.g. displayed,
+            // while the gradient force is manipulated (e.g. projected).
+            if (img == 0 || img == chain->noi - 1)
+            {
+                energies[img] = system.hamiltonian->Energy(image);
+            }
+            else
+            {
+                energies[img] = system.hamiltonian->Energy_and_Gradient(image, system.effective_field);
+                Vectormath::scale(system.effective_field, -1);
+            }
             if (img > 0)
+                Rx[img] = Manifoldmath::dist_geodesic(image, *configurations[img-1]);
+        });
+        for (int img = 1; img < chain->noi; ++img)
+        {
+            if (Rx[img] < 1e-10)
             {
-                Rx[img] = Rx[img-1] + Manifoldmath::dist_geodesic(image, *configurations[img-1]);
-                if (Rx[img] - Rx[img-1] < 1e-10)
-                {
-                    Log(Log_Level::Error, Log_Sender::GNEB, std::string("The geodesic distance between two images is zero! Stopping..."), -1, this->idx_chain);
-                    this->chain->iteration_allowed = false;
-                    return;
-                }
+                Log(Log_Level::Error, Log_Sender::GNEB, std::string("The geodesic distance between two images is zero! Stopping..."), -1, this->idx_chain);
+                this->chain->iteration_allowed = false;
+                return;
             }
+            Rx[img] += Rx[img-1];
         }
 
         // Calculate relevant tangent to magnetisation sphere, considering also the energies of images
@@ -99,19 +116,12 @@ namespace Engine
 
         // Get the total force on the image chain
         // Loop over images to calculate the total force on each Image
-        for (int img = 1; img < chain->noi - 1; ++img)
+        this->For_Each_Image(1, chain->noi - 1, [&](int img)
         {
             auto& image = *configurations[img];
-            // We do it the following way so that the effective field can be e.g. displayed,
-            //		while the gradient force is manipulated (e.g. projected)
-            this->chain->images[img]->UpdateEffectiveField();
-            // F_gradient[img] = this->chain->images[img]->effective_field;
-            Vectormath::set_c_a(1, this->chain->images[img]->effective_field, F_gradient[img]);
-            // // this->chain->images[img]->hamiltonian->Effective_Field(image, this->chain->images[img]->effective_field);
 
             // The gradient force (unprojected) is simply the effective field
-            // this->chain->images[img]->hamiltonian->Gradient(image, F_gradient[img]);
-            // Vectormath::scale(F_gradient[img], -1);
+            Vectormath::set_c_a(1, this->chain->images[img]->effective_field, F_gradient[img]);
 
             // Project the gradient force into the tangent space of the image
             Manifoldmath::project_tangential(F_gradient[img], image);
@@ -161,7 +171,7 @@ namespace Engine
 
             // Copy out
             Vectormath::set_c_a(1, F_total[img], forces[img]);
-        }// end for img=1..noi-1
+        });// end for img=1..noi-1
     }// end Calculate
 
 
@@ -171,7 +181,7 @@ namespace Engine
         using namespace Utility;
 
         // Calculate the cross product with the spin configuration to get direct minimization
-        for (unsigned int i = 1; i < configurations.size()-1; ++i)
+        this->For_Each_Image(1, configurations.size()-1, [&](int i)
         {
             auto& image = *configurations[i];
             auto& force = forces[i];
@@ -188,7 +198,7 @@ namespace Engine
             #ifdef SPIRIT_ENABLE_PINNING
             Vectormath::set_c_a(1, force_virtual, force_virtual, parameters.pinning->mask_unpinned);
             #endif // SPIRIT_ENABLE_PINNING
-        }
+        });
     }
 
     template <Solver solver>
@@ -219,23 +229,23 @@ namespace Engine
         std::fill(this->force_max_abs_component_all.begin(), this->force_max_abs_component_all.end(), 0);
         
         
-        for (int img = 1; img < chain->noi - 1; ++img)
+        this->For_Each_Image(1, chain->noi - 1, [&](int img)
         {
-            scalar fmax = this->Force_on_Image_MaxAbsComponent(*(this->systems[img]->spins), F_total[img]);
             // Set maximum per image
-            if (fmax > this->force_max_abs_component_all[img]) this->force_max_abs_component_all[img] = fmax;
-            // Set maximum overall
-            if (fmax > this->force_max_abs_component) this->force_max_abs_component = fmax;
+            this->force_max_abs_component_all[img] = this->Force_on_Image_MaxAbsComponent(*(this->systems[img]->spins), F_total[img]);
 
             // Set the effective fields
             Manifoldmath::project_tangential(this->forces[img], *this->systems[img]->spins);
             // Vectormath::set_c_a(1, this->forces[img], this->systems[img]->effective_field);
-        }
+        });
+        // Set maximum overall
+        for (int img = 1; img < chain->noi - 1; ++img)
+            this->force_max_abs_component = std::max(this->force_max_abs_component, this->force_max_abs_component_all[img]);
 
         // --- Chain Data Update
         // Calculate the inclinations at the data points
         std::vector<scalar> dE_dRx(chain->noi, 0);
-        for (int i = 0; i < chain->noi; ++i)
+        this->For_Each_Image(0, chain->noi, [&](int i)
         {
             // dy/dx
             dE_dRx[i] = Vectormath::dot(this->chain->images[i]->effective_field, this->tangents[i]);
@@ -243,14 +253,12 @@ namespace Engine
             // {
             // 	dE_dRx[i] += this->chain->images[i]->effective_field[j].dot(this->tangents[i][j]);
             // }
-        }
+        });
         // Interpolate data points
         auto interp = Utility::Cubic_Hermite_Spline::Interpolate(this->Rx, this->energies, dE_dRx, chain->gneb_parameters->n_E_interpolations);
         // Update the chain
         //		Rx
         chain->Rx = this->Rx;
-        //		E
-        for (int img = 1; img < chain->noi; ++img) chain->images[img]->E = this->energies[img];
         //		Rx interpolated
         chain->Rx_interpolated = interp[0];
         //		E interpolated
@@ -340,7 +348,9 @@ namespace Engine
                 std::string energiesFileInterpolated = preEnergiesFile + "-interpolated" + suffix + ".txt";
                 // std::string energiesFilePerSpin = preEnergiesFile + "PerSpin" + suffix + ".txt";
 
-                // Energies
+                // Energies (with the contributions, which are not calculated during the iterations)
+                for (auto& image : this->chain->images)
+                    image->UpdateEnergy();
                 IO::Write_Chain_Energies(*this->chain, iteration, energiesFile, normalize, readability);
 
                 // Interpolated Energies
@@ -406,4 +416,5 @@ namespace Engine
     template class Method_GNEB<Solver::Depondt>;
     template class Method_GNEB<Solver::NCG>;
     template class Method_GNEB<Solver::VP>;
+    template class Method_GNEB<Solver::BFGS>;
 }
@@ -7,6 +7,9 @@
 #include <io/OVF_File.hpp>
 #include <utility/Logging.hpp>
 
+#include <Eigen/Dense>
+
+#include <algorithm>
 #include <iostream>
 #include <ctime>
 #include <math.h>
@@ -17,6 +20,107 @@ using namespace Utility;
 
 namespace Engine
 {
+    namespace
+    {
+        // Optional terms of the LLG equation
+        enum class STT_Term     { None, Monolayer, Gradient };
+        enum class Thermal_Term { None, Homogeneous, Gradient };
+
+        // Inputs of the fused right-hand side of the LLG equation
+        struct LLG_RHS
+        {
+            scalar dtg, damping;
+            // Spin transfer torque: prefactors of the parallel and the cross product term,
+            // and the polarisation (monolayer) or the directional gradient of the spins
+            scalar stt_parallel, stt_cross;
+            Vector3 stt_polarisation;
+            const vectorfield * stt_gradient;
+            // Thermal noise: prefactor, generator and draw, and the linear temperature profile
+            scalar epsilon;
+            const Random::Philox * prng;
+            std::uint64_t draw;
+            Vector3 temperature_direction;
+            scalar temperature_inclination, temperature_offset;
+            const vectorfield * positions;
+            // Pinning mask (may be null)
+            const intfield * mask;
+        };
+
+        // Precession, damping, spin transfer torque, thermal noise and pinning in a single pass
+        // over the spins. The optional terms are template parameters, so inactive ones cost nothing.
+        // The terms are summed in the same order as the separate Vectormath calls used to be.
+        template<STT_Term stt, Thermal_Term thermal>
+        void LLG_RHS_Kernel(const LLG_RHS & rhs, const vectorfield & spins, const vectorfield & force, vectorfield & force_virtual)
+        {
+            const int nos = spins.size();
+            #pragma omp parallel for
+            for (int i = 0; i < nos; ++i)
+            {
+                const Vector3 & spin = spins[i];
+
+                // Precession and damping
+                Vector3 f = rhs.dtg * force[i];
+                f += (rhs.dtg * rhs.damping) * spin.cross(force[i]);
+
+                // Spin transfer torque
+                if (stt == STT_Term::Monolayer)
+                {
+                    f += rhs.stt_parallel * rhs.stt_polarisation;
+                    f += rhs.stt_cross * rhs.stt_polarisation.cross(spin);
+                }
+                else if (stt == STT_Term::Gradient)
+                {
+                    const Vector3 & grad = (*rhs.stt_gradient)[i];
+                    f += rhs.stt_parallel * grad;
+                    f += rhs.stt_cross * grad.cross(spin);
+                }
+
+                // Temperature
+                if (thermal != Thermal_Term::None)
+                {
+                    Vector3 xi;
+                    Vectormath::get_random_vector_unitsphere(*rhs.prng, rhs.draw, i, xi);
+                    scalar epsilon = rhs.epsilon;
+                    if (thermal == Thermal_Term::Gradient)
+                    {
+                        scalar temperature = rhs.temperature_inclination * rhs.temperature_direction.dot((*rhs.positions)[i]);
+                        temperature = std::min(std::max(scalar(0), temperature + rhs.temperature_offset), scalar(1e30));
+                        epsilon = temperature * rhs.epsilon;
+                    }
+                    f += epsilon * xi;
+                    f += (epsilon * rhs.damping) * spin.cross(xi);
+                }
+
+                // Pinning
+                if (rhs.mask)
+                    f = (*rhs.mask)[i] * f;
+
+                force_virtual[i] = f;
+            }
+        }
+
+        template<STT_Term stt>
+        void LLG_RHS_Kernel(Thermal_Term thermal, const LLG_RHS & rhs, const vectorfield & spins, const vectorfield & force, vectorfield & force_virtual)
+        {
+            if (thermal == Thermal_Term::None)
+                LLG_RHS_Kernel<stt, Thermal_Term::None>(rhs, spins, force, force_virtual);
+            else if (thermal == Thermal_Term::Homogeneous)
+                LLG_RHS_Kernel<stt, Thermal_Term::Homogeneous>(rhs, spins, force, force_virtual);
+            else
+                LLG_RHS_Kernel<stt, Thermal_Term::Gradient>(rhs, spins, force, force_virtual);
+        }
+
+        void LLG_RHS_Kernel(STT_Term stt, Thermal_Term thermal, const LLG_RHS & rhs, const vectorfield & spins, const vectorfield & force, vectorfield & force_virtual)
+        {
+            if (stt == STT_Term::None)
+                LLG_RHS_Kernel<STT_Term::None>(thermal, rhs, spins, force, force_virtual);
+            else if (stt == STT_Term::Monolayer)
+                LLG_RHS_Kernel<STT_Term::Monolayer>(thermal, rhs, spins, force, force_virtual);
+            else
+                LLG_RHS_Kernel<STT_Term::Gradient>(thermal, rhs, spins, force, force_virtual);
+        }
+    }
+
     template <Solver solver>
     Method_LLG<solver>::Method_LLG(std::shared_ptr<Data::Spin_System> system, int idx_img, int idx_chain) :
         Method_Solver<solver>(system->llg_parameters, idx_img, idx_chain), picoseconds_passed(0)
@@ -32,9 +136,11 @@ namespace Engine
         this->forces    = std::vector<vectorfield>(this->noi, vectorfield(this->nos));
         this->forces_virtual    = std::vector<vectorfield>(this->noi, vectorfield(this->nos));
         this->Gradient = std::vector<vectorfield>(this->noi, vectorfield(this->nos));
-        this->xi = vectorfield(this->nos, {0,0,0});
+        this->gradient_from_energy = std::vector<bool>(this->noi, false);
+        this->gradient_changes = std::vector<std::uint64_t>(this->noi, 0);
+        this->gradient_energies = std::vector<scalar>(this->noi, 0);
+        this->gradient_at_spins = std::vector<bool>(this->noi, false);
         this->s_c_grad = vectorfield(this->nos, {0,0,0});
-        this->temperature_distribution = scalarfield(this->nos, 0);
         
         // We assume it is not converged before the first iteration
         this->force_converged = std::vector<bool>(this->noi, false);
@@ -70,8 +176,16 @@ namespace Engine
         // Loop over images to calculate the total force on each Image
         for (unsigned int img = 0; img < this->systems.size(); ++img)
         {
-            // Minus the gradient is the total Force here
-            this->systems[img]->hamiltonian->Gradient(*configurations[img], Gradient[img]);
+            // Minus the gradient is the total Force here. It does not need to be calculated again
+            // if it was calculated together with the energy after the last step and the spins of
+            // the system have not been changed since. It is re-used only once, as the solver may
+            // change the spins in place before the observables are invalidated.
+            bool reuse = this->gradient_from_energy[img] && configurations[img] == this->systems[img]->spins &&
+                         this->gradient_changes[img] == this->systems[img]->Changes();
+            if (!reuse)
+                this->systems[img]->hamiltonian->Gradient(*configurations[img], Gradient[img]);
+            this->gradient_from_energy[img] = false;
+            this->gradient_at_spins[img] = false;
             #ifdef SPIRIT_ENABLE_PINNING
                 Vectormath::set_c_a(1, Gradient[img], Gradient[img], this->parameters->pinning->mask_unpinned);
             #endif // SPIRIT_ENABLE_PINNING
@@ -81,6 +195,30 @@ namespace Engine
         }
     }
 
+    template <Solver solver>
+    bool Method_LLG<solver>::Calculate_Energy_and_Force(const std::vector<std::shared_ptr<vectorfield>> & configurations, std::vector<scalar> & energies, std::vector<vectorfield> & forces)
+    {
+        for (unsigned int img = 0; img < this->systems.size(); ++img)
+        {
+            // The energy and gradient are re-used under the same conditions as in Calculate_Force
+            bool reuse = this->gradient_from_energy[img] && configurations[img] == this->systems[img]->spins &&
+                         this->gradient_changes[img] == this->systems[img]->Changes();
+            if (!reuse)
+                this->gradient_energies[img] = this->systems[img]->hamiltonian->Energy_and_Gradient(*configurations[img], Gradient[img]);
+            this->gradient_from_energy[img] = false;
+            // If these are the spins of the system at the end of the iteration, the energy and gradient
+            // are kept for the observables and the next force calculation (see Hook_Post_Iteration)
+            this->gradient_at_spins[img] = configurations[img] == this->systems[img]->spins;
+            #ifdef SPIRIT_ENABLE_PINNING
+                Vectormath::set_c_a(1, Gradient[img], Gradient[img], this->parameters->pinning->mask_unpinned);
+            #endif // SPIRIT_ENABLE_PINNING
+
+            energies[img] = this->gradient_energies[img];
+            Vectormath::set_c_a(-1, Gradient[img], forces[img]);
+        }
+        return true;
+    }
+
     template <Solver solver>
     void Method_LLG<solver>::Calculate_Force_Virtual(const std::vector<std::shared_ptr<vectorfield>> & configurations, const std::vector<vectorfield> & forces, std::vector<vectorfield> & forces_virtual)
     {
@@ -110,18 +248,29 @@ namespace Engine
             //////////
 
             // Direct minimisation
-            if (parameters.direct_minimization || solver == Solver::VP)
+            if (parameters.direct_minimization || solver == Solver::VP || solver == Solver::BFGS)
             {
                 dtg = parameters.dt * Constants::gamma / Constants::mu_B;
                 Vectormath::set_c_cross( dtg, image, force, force_virtual);
+
+                // Apply Pinning
+                #ifdef SPIRIT_ENABLE_PINNING
+                    Vectormath::set_c_a(1, force_virtual, force_virtual, parameters.pinning->mask_unpinned);
+                #endif // SPIRIT_ENABLE_PINNING
             }
-            // Dynamics simulation
+            // Dynamics simulation: all terms are evaluated in a single pass over the spins
             else
             {
-                Vectormath::set_c_a( dtg, force, force_virtual);
-                Vectormath::add_c_cross( dtg * damping, image, force, force_virtual);
+                LLG_RHS rhs;
+                rhs.dtg     = dtg;
+                rhs.damping = damping;
+                rhs.mask    = nullptr;
+                #ifdef SPIRIT_ENABLE_PINNING
+                    rhs.mask = &parameters.pinning->mask_unpinned;
+                #endif // SPIRIT_ENABLE_PINNING
 
                 // STT
+                STT_Term stt = STT_Term::None;
                 if (a_j > 0)
                 {
                     if (parameters.stt_use_gradient)
@@ -130,56 +279,54 @@ namespace Engine
                         auto& boundary_conditions = this->systems[0]->hamiltonian->boundary_conditions;
                         // Gradient approximation for in-plane currents
                         Vectormath::directional_gradient(image, geometry, boundary_conditions, je, s_c_grad); // s_c_grad = (j_e*grad)*S
-                        Vectormath::add_c_a    ( dtg * a_j * ( damping - beta ), s_c_grad, force_virtual); // TODO: a_j durch b_j ersetzen 
-                        Vectormath::add_c_cross( dtg * a_j * ( 1 + beta * damping ), s_c_grad, image, force_virtual); // TODO: a_j durch b_j ersetzen 
+                        stt = STT_Term::Gradient;
+                        rhs.stt_gradient = &s_c_grad;
+                        rhs.stt_parallel = dtg * a_j * ( damping - beta );     // TODO: a_j durch b_j ersetzen 
+                        rhs.stt_cross    = dtg * a_j * ( 1 + beta * damping ); // TODO: a_j durch b_j ersetzen 
                         // Gradient in current richtung, daher => *(-1)
                     }
                     else
                     {
                         // Monolayer approximation
-                        Vectormath::add_c_a    ( -dtg * a_j * ( damping - beta ), s_c_vec, force_virtual);
-                        Vectormath::add_c_cross( -dtg * a_j * ( 1 + beta * damping ), s_c_vec, image, force_virtual);
+                        stt = STT_Term::Monolayer;
+                        rhs.stt_polarisation = s_c_vec;
+                        rhs.stt_parallel = -dtg * a_j * ( damping - beta );
+                        rhs.stt_cross    = -dtg * a_j * ( 1 + beta * damping );
                     }
                 }
 
                 // Temperature
+                Thermal_Term thermal = Thermal_Term::None;
                 if (parameters.temperature > 0 || parameters.temperature_gradient_inclination != 0)
                 {
-                    // Generate random directions
-                    Vectormath::get_random_vectorfield_unitsphere(parameters.prng, this->xi);
+                    // Random directions are drawn per spin from the counter-based generator
+                    rhs.prng = &parameters.philox;
+                    rhs.draw = parameters.philox.draw++;
 
-                    // If we have a temperature gradient, we use the distribution (scalarfield)
+                    // If we have a temperature gradient, each spin gets its temperature from a linear profile
                     if (parameters.temperature_gradient_inclination != 0)
                     {
-                        // Calculate distribution
-                        Vectormath::get_gradient_distribution(
-                            *this->systems[i]->geometry,
-                            parameters.temperature_gradient_direction,
-                            parameters.temperature,
-                            parameters.temperature_gradient_inclination,
-                            temperature_distribution, 0, 1e30);
-
-                        scalar epsilon = sqrtdtg * Utility::Constants::k_B;
-                        Vectormath::scale(temperature_distribution, epsilon);
-
-                        Vectormath::add_c_a(temperature_distribution, this->xi, force_virtual);
-
-                        Vectormath::scale(temperature_distribution, damping);
-                        Vectormath::add_c_cross(temperature_distribution, image, this->xi, force_virtual);
+                        auto& geometry = *this->systems[i]->geometry;
+                        thermal = Thermal_Term::Gradient;
+                        rhs.temperature_direction   = parameters.temperature_gradient_direction.normalized();
+                        rhs.temperature_inclination = parameters.temperature_gradient_inclination;
+                        // Start the profile at the lower bound of the geometry along the gradient
+                        scalar bmin = geometry.bounds_min.dot(rhs.temperature_direction);
+                        scalar bmax = geometry.bounds_max.dot(rhs.temperature_direction);
+                        rhs.temperature_offset = parameters.temperature - rhs.temperature_inclination*std::min(bmin, bmax);
+                        rhs.positions = &geometry.positions;
+                        rhs.epsilon = sqrtdtg * Utility::Constants::k_B;
                     }
                     // If we only have homogeneous temperature we do it more efficiently
                     else if (parameters.temperature > 0)
                     {
-                        scalar epsilon = sqrtdtg * Utility::Constants::k_B * parameters.temperature;
-                        Vectormath::add_c_a    (epsilon, this->xi, force_virtual);
-                        Vectormath::add_c_cross(epsilon * damping, image, this->xi, force_virtual);
+                        thermal = Thermal_Term::Homogeneous;
+                        rhs.epsilon = sqrtdtg * Utility::Constants::k_B * parameters.temperature;
                     }
                 }
+
+                LLG_RHS_Kernel(stt, thermal, rhs, image, force, force_virtual);
             }
-            // Apply Pinning
-            #ifdef SPIRIT_ENABLE_PINNING
-                Vectormath::set_c_a(1, force_virtual, force_virtual, parameters.pinning->mask_unpinned);
-            #endif // SPIRIT_ENABLE_PINNING
         }
     }
 
@@ -207,8 +354,11 @@ namespace Engine
     template <Solver solver>
     void Method_LLG<solver>::Hook_Post_Iteration()
     {
-        // Increment the time counter (picoseconds)
-        this->picoseconds_passed += this->systems[0]->llg_parameters->dt;
+        // Increment the time counter (picoseconds) by the size of the step
+        if (solver == Solver::RK45)
+            this->picoseconds_passed += this->rk_dt_taken;
+        else
+            this->picoseconds_passed += this->systems[0]->llg_parameters->dt;
 
         // --- Convergence Parameter Update
         // Loop over images to calculate the maximum force components
@@ -222,16 +372,24 @@ namespace Engine
         }
 
         // --- Image Data Update
-        // Update the system's Energy
-        // ToDo: copy instead of recalculating
-        this->systems[0]->UpdateEnergy();
-
-        // ToDo: How to update eff_field without numerical overhead?
-        // systems[0]->effective_field = Gradient[0];
-        // Vectormath::scale(systems[0]->effective_field, -1);
-        Manifoldmath::project_tangential(this->forces[0], *this->systems[0]->spins);
-        Vectormath::set_c_a(1, this->forces[0], this->systems[0]->effective_field);
-        // systems[0]->UpdateEffectiveField();
+        // The energy and effective field of the systems are calculated on demand (e.g. when the data
+        // is saved or requested by a UI), unless the energy is requested as a by-product of the gradient
+        // of the new spins or the solver has already calculated both for the new spins. They are then
+        // re-used in the next force calculation.
+        for (int img = 0; img < this->noi; ++img)
+        {
+            auto& system = *this->systems[img];
+            if (system.llg_parameters->energy_from_gradient && !this->gradient_at_spins[img])
+            {
+                this->gradient_energies[img] = system.hamiltonian->Energy_and_Gradient(*system.spins, this->Gradient[img]);
+                this->gradient_at_spins[img] = true;
+            }
+            if (!this->gradient_at_spins[img]) continue;
+            system.SetEnergy(this->gradient_energies[img]);
+            this->gradient_from_energy[img] = true;
+            this->gradient_changes[img] = system.Changes();
+            this->gradient_at_spins[img] = false;
+        }
 
         // TODO: In order to update Rx with the neighbouring images etc., we need the state -> how to do this?
 
@@ -403,4 +561,6 @@ namespace Engine
     template class Method_LLG<Solver::Depondt>;
     template class Method_LLG<Solver::NCG>;
     template class Method_LLG<Solver::VP>;
+    template class Method_LLG<Solver::BFGS>;
+    template class Method_LLG<Solver::RK45>;
 }
@@ -8,6 +8,7 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <iostream>
 #include <ctime>
 #include <math.h>
@@ -16,7 +17,41 @@ using namespace Utility;
 
 namespace Engine
 {
-    Method_MC::Method_MC(std::shared_ptr<Data::Spin_System> system, int idx_img, int idx_chain) :
+    namespace
+    {
+        // Number of iterations after which the running energy of the MC is calculated anew
+        const int n_iterations_energy_refresh = 100;
+
+        // Orthonormal basis whose third column is the unit vector axis
+        Matrix3 Local_Basis(const Vector3 & axis)
+        {
+            Vector3 e_z{0, 0, 1};
+            Matrix3 local_basis;
+            if (std::abs(axis.z()) < 1-1e-10)
+            {
+                local_basis.col(2) = axis;
+                local_basis.col(0) = (local_basis.col(2).cross(e_z)).normalized();
+                local_basis.col(1) = local_basis.col(2).cross(local_basis.col(0));
+            }
+            else
+            {
+                scalar sign = axis.z() > 0 ? 1 : -1;
+                local_basis = Vector3{1, sign, sign}.asDiagonal();
+            }
+            return local_basis;
+        }
+
+        // Orientation with polar angle theta and azimuthal angle phi in a local basis
+        Vector3 Local_Spin(const Matrix3 & local_basis, scalar costheta, scalar phi)
+        {
+            scalar sintheta = std::sqrt(std::max(scalar(0), 1 - costheta*costheta));
+            return local_basis * Vector3{ sintheta * std::cos(phi),
+                                          sintheta * std::sin(phi),
+                                          costheta };
+        }
+    }
+
+    Method_MC::Method_MC(std::shared_ptr<Data::Spin_System> system, int idx_img, int idx_chain, int stream) :
         Method(system->mc_parameters, idx_img, idx_chain)
     {
         // Currently we only support a single image being iterated at once:
@@ -39,47 +74,179 @@ namespace Engine
 
         this->parameters_mc = system->mc_parameters;
 
+        // The key of the random number generator of another stream combines the seed with the stream
+        if (stream == 0)
+            this->philox = this->parameters_mc->philox;
+        else
+            this->philox = Random::Philox(std::uint32_t(this->parameters_mc->rng_seed) | (std::uint64_t(stream) << 32));
+
         // Starting cone angle
         this->cone_angle = Constants::Pi * this->parameters_mc->metropolis_cone_angle / 180.0;
         this->n_rejected = 0;
         this->acceptance_ratio_current = this->parameters_mc->acceptance_ratio_target;
+
+        this->sample_energy = 0;
+        this->sample_magnetization = Vector3{ 0, 0, 0 };
+
+        #ifndef SPIRIT_USE_CUDA
+        bool local_fields_available = this->systems[0]->hamiltonian->Name() == "Heisenberg";
+        #else
+        bool local_fields_available = false;
+        #endif
+
+        // Heat bath steps are made in the linear field of the spin, which requires the local fields
+        this->use_heat_bath = false;
+        if (this->parameters_mc->algorithm == Data::MC_Algorithm::Heat_Bath)
+        {
+            if (local_fields_available)
+                this->use_heat_bath = true;
+            else
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("The {} Hamiltonian does not provide local fields, the MC uses Metropolis instead of heat bath steps",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+        }
+
+        // Wolff cluster updates grow the clusters along the exchange bonds and use the local fields to
+        // calculate the energy differences of the other interactions
+        this->use_wolff = false;
+        if (this->parameters_mc->algorithm == Data::MC_Algorithm::Wolff)
+        {
+            if (local_fields_available && this->systems[0]->hamiltonian->Exchange_Graph(this->nos,
+                    this->exchange_offsets, this->exchange_partners, this->exchange_magnitudes))
+            {
+                this->use_wolff = true;
+                this->in_cluster = intfield(this->nos, 0);
+                this->cluster_spins = intfield(0);
+            }
+            else
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("The {} Hamiltonian does not provide local fields and an exchange graph, the MC uses Metropolis instead of Wolff cluster updates",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+        }
+
+        // Parallel sweep: spins of one colour neither interact nor share a partner, so that their moves
+        // are independent and each move can update the local fields of its partners (which it uses)
+        this->use_parallel_sweep = false;
+        if (this->parameters_mc->parallel_sweep)
+        {
+            intfield colours(0);
+            int n_colours = 0;
+            if (local_fields_available)
+                n_colours = this->systems[0]->hamiltonian->Interaction_Colouring(this->nos, 2, colours);
+            if (n_colours > 0)
+            {
+                this->use_parallel_sweep = true;
+                this->colour_spins = std::vector<intfield>(n_colours);
+                for (int ispin = 0; ispin < this->nos; ++ispin)
+                    this->colour_spins[colours[ispin]].push_back(ispin);
+            }
+            else
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("The {} Hamiltonian does not provide local fields and its interaction graph "
+                    "(e.g. due to the FFT dipole-dipole interaction), the MC sweep is serial",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+        }
+
+        // The energy (and the local fields) are calculated at the first iteration
+        this->energy_current = 0;
+        this->iterations_since_energy = 0;
+        this->cached_spins = nullptr;
+        this->cached_changes = 0;
+
+        // Local field cache
+        this->use_local_fields = false;
+        if (this->parameters_mc->local_field_cache || this->use_parallel_sweep || this->use_heat_bath || this->use_wolff)
+        {
+            if (local_fields_available)
+            {
+                this->use_local_fields = true;
+                this->local_fields = vectorfield(this->nos, {0,0,0});
+            }
+            else
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("The {} Hamiltonian does not provide local fields, the MC local field cache is not used",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+        }
+
+        // A step of a spin only changes the single spin energies of the spin and its partners
+        bool interaction_graph_available = this->systems[0]->hamiltonian->Interaction_Graph(this->nos,
+            this->interaction_offsets, this->interaction_partners);
+        if (!interaction_graph_available)
+        {
+            // Every spin interacts with every other spin, so the energy difference of a step is given by the full
+            // local field of the spin, -ds.h_i. Keeping the local fields up to date costs O(N) per accepted step.
+            if (local_fields_available)
+            {
+                if (!this->use_local_fields)
+                {
+                    this->use_local_fields = true;
+                    this->local_fields = vectorfield(this->nos, {0,0,0});
+                }
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("Every spin interacts with every other spin in the {} Hamiltonian "
+                    "(e.g. due to the FFT dipole-dipole interaction), so each accepted MC step costs O(N). Use ddi_method cutoff for MC.",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+            }
+            else
+                Log(Log_Level::Warning, Log_Sender::MC, fmt::format("The {} Hamiltonian provides neither local fields nor an interaction graph, "
+                    "so each MC step calculates the total energy, i.e. a sweep costs N energy evaluations",
+                    this->systems[0]->hamiltonian->Name()), this->idx_image, this->idx_chain);
+        }
+        this->use_interaction_graph = !this->use_local_fields && interaction_graph_available;
     }
 
-    // This implementation is mostly serial as parallelization is nontrivial
-    //      if the range of neighbours for each atom is not pre-defined.
+    // The serial implementation is used unless the interaction graph of the Hamiltonian is known,
+    //      as parallelization is nontrivial if the range of neighbours for each atom is not pre-defined.
     void Method_MC::Iteration()
     {
         int nos = this->systems[0]->spins->size();
 
         // Temporaries
         auto& spins_old       = *this->systems[0]->spins;
-        auto  spins_new       = spins_old;
+
+        // The spins may have been changed from outside since the last iteration
+        bool spins_changed = this->cached_spins != &spins_old || this->cached_changes != this->systems[0]->Changes();
+        if (this->use_local_fields && spins_changed)
+            this->systems[0]->hamiltonian->Local_Fields(spins_old, this->local_fields);
+        if (spins_changed || this->iterations_since_energy >= n_iterations_energy_refresh)
+        {
+            this->energy_current = this->systems[0]->hamiltonian->Energy(spins_old);
+            this->iterations_since_energy = 0;
+        }
+        this->cached_spins = &spins_old;
+        ++this->iterations_since_energy;
 
         // Generate randomly displaced spin configuration according to cone radius
         // Vectormath::get_random_vectorfield_unitsphere(this->parameters_mc->prng, random_unit_vectors);
 
-        // TODO: add switch between Metropolis and heat bath
-        // One Metropolis step
-        Metropolis(spins_old, spins_new);
-        Vectormath::set_c_a(1, spins_new, spins_old);
+        // One sweep of Metropolis or heat bath steps, or the equivalent in cluster updates
+        if (this->use_wolff)
+        {
+            // The spins are updated in place
+            Wolff(spins_old);
+        }
+        else if (this->use_parallel_sweep)
+        {
+            // The spins are updated in place
+            Sweep_Parallel(spins_old);
+        }
+        else
+        {
+            // The spins are updated in place
+            Sweep(spins_old);
+        }
+
+        // Sample of the observables, with the energy kept up to date by the sweep
+        auto mag = Vectormath::Magnetization(spins_old);
+        this->sample_energy = this->energy_current;
+        this->sample_magnetization = Vector3{ mag[0], mag[1], mag[2] };
+        this->systems[0]->mc_observables.Add(this->sample_energy, this->sample_magnetization);
     }
 
-    // Simple metropolis step
-    void Method_MC::Metropolis(const vectorfield & spins_old, vectorfield & spins_new)
+    void Method_MC::Adapt_Cone_Angle()
     {
-        this->n_rejected = 0;
-        int nos = spins_new.size();
-        auto distribution = std::uniform_real_distribution<scalar>(0, 1);
-        auto distribution_idx = std::uniform_int_distribution<>(0, nos-1);
-        scalar kB_T = Constants::k_B * this->parameters_mc->temperature;
-
         scalar diff = 0.01;
 
-        // Cone angle feedback algorithm
-        if (this->parameters_mc->metropolis_step_cone && this->parameters_mc->metropolis_cone_adaptive)
-        {
-            this->acceptance_ratio_current = 1 - (scalar)this->n_rejected / (scalar)nos;
+        this->acceptance_ratio_current = 1 - (scalar)this->n_rejected / (scalar)this->nos;
 
+        // Cone angle feedback algorithm, using the rejections of the last iteration
+        if (this->parameters_mc->metropolis_step_cone && this->parameters_mc->metropolis_cone_adaptive && !this->use_heat_bath && !this->use_wolff)
+        {
             if( (this->acceptance_ratio_current < this->parameters_mc->acceptance_ratio_target) && (this->cone_angle > diff) )
             {
                 this->cone_angle -= diff;
@@ -90,119 +257,319 @@ namespace Engine
             }
             this->parameters_mc->metropolis_cone_angle = this->cone_angle * 180.0 / Constants::Pi;
         }
+        this->n_rejected = 0;
+    }
+
+    Vector3 Method_MC::Trial_Spin(const Vector3 & spin_current, scalar random_theta, scalar random_phi, scalar cos_cone_angle) const
+    {
+        // Random distribution of phi between 0 and 360 degrees
+        scalar phi = 2*Constants::Pi * random_phi;
+
+        // Sample a cone around the spin, with a rotation angle between 0 and cone_angle degrees
+        if (this->parameters_mc->metropolis_step_cone)
+            return Local_Spin(Local_Basis(spin_current), 1 - (1 - cos_cone_angle) * random_theta, phi);
+        // Sample the entire unit sphere, with a rotation angle between 0 and 180 degrees
+        else
+            return Local_Spin(Matrix3::Identity(), 2*random_theta - 1, phi);
+    }
+
+    // Heat bath, see Y. Miyatake et al, J Phys C: Solid State Phys 19, 2539 (1986)
+    Vector3 Method_MC::Heat_Bath_Spin(const Vector3 & spin_current, const Vector3 & field, scalar random_theta, scalar random_phi) const
+    {
+        scalar field_norm = field.norm();
+
+        // Without thermal fluctuations the spin aligns with the field
+        if (this->parameters_mc->temperature < 1e-12)
+            return field_norm > 0 ? Vector3(field / field_norm) : spin_current;
+
+        // The distribution of the angle theta to the field is p(cos(theta)) ~ exp(x cos(theta)),
+        // which is sampled by inversion of its cumulative distribution
+        scalar x = field_norm / (Constants::k_B * this->parameters_mc->temperature);
+        scalar costheta;
+        if (x < 1e-10)
+            costheta = 2*random_theta - 1;
+        else
+        {
+            scalar arg = random_theta + (1 - random_theta) * std::exp(-2*x);
+            costheta = arg > 0 ? std::max(scalar(-1), 1 + std::log(arg) / x) : -1;
+        }
+
+        // Random distribution of phi between 0 and 360 degrees
+        scalar phi = 2*Constants::Pi * random_phi;
+
+        if (x < 1e-10)
+            return Local_Spin(Matrix3::Identity(), costheta, phi);
+        else
+            return Local_Spin(Local_Basis(field / field_norm), costheta, phi);
+    }
+
+    bool Method_MC::Metropolis_Accept(scalar Ediff, scalar random) const
+    {
+        // Metropolis criterion: reject the step if energy rose
+        if (Ediff > 1e-14)
+        {
+            if (this->parameters_mc->temperature < 1e-12)
+                return false;
+
+            // Exponential factor
+            scalar kB_T = Constants::k_B * this->parameters_mc->temperature;
+            scalar exp_ediff = std::exp( -Ediff/kB_T );
+
+            // Only reject if random number is larger than exponential
+            if (exp_ediff < random)
+                return false;
+        }
+        return true;
+    }
+
+    bool Method_MC::Local_Field_Step(int ispin, scalar random_theta, scalar random_phi, scalar random_accept, scalar cos_cone_angle,
+        vectorfield & spins, scalar & energy_change)
+    {
+        auto& hamiltonian = *this->systems[0]->hamiltonian;
+        const Vector3 spin_current = spins[ispin];
+
+        Vector3 spin_trial;
+        scalar Ediff, Ediff_accept;
+        if (this->use_heat_bath)
+        {
+            // The trial spin is drawn from the Boltzmann distribution in the linear field, which the remaining
+            // (e.g. anisotropy) terms correct by a Metropolis criterion on their energy difference
+            Vector3 field = hamiltonian.Linear_Field_Single_Spin(ispin, spins, this->local_fields);
+            spin_trial = this->Heat_Bath_Spin(spin_current, field, random_theta, random_phi);
+            Ediff = hamiltonian.Energy_Difference_Single_Spin(ispin, spin_trial, spins, this->local_fields);
+            Ediff_accept = Ediff + (spin_trial - spin_current).dot(field);
+        }
+        else
+        {
+            // Energy difference of configurations with and without displacement, O(1) from the cached local fields
+            spin_trial = this->Trial_Spin(spin_current, random_theta, random_phi, cos_cone_angle);
+            Ediff = hamiltonian.Energy_Difference_Single_Spin(ispin, spin_trial, spins, this->local_fields);
+            Ediff_accept = Ediff;
+        }
+
+        if (!this->Metropolis_Accept(Ediff_accept, random_accept))
+            return false;
+
+        // Apply the step and update the fields of the neighbours
+        spins[ispin] = spin_trial;
+        hamiltonian.Update_Local_Fields(ispin, spin_current, spins, this->local_fields);
+        energy_change += Ediff;
+        return true;
+    }
 
-        // One Metropolis step for each spin
-        Vector3 e_z{0, 0, 1};
-        scalar costheta, sintheta, phi;
-        Matrix3 local_basis;
+    scalar Method_MC::Energy_Neighbourhood(int ispin, const vectorfield & spins) const
+    {
+        auto& hamiltonian = *this->systems[0]->hamiltonian;
+        scalar energy = 0;
+        for (int idx = this->interaction_offsets[ispin]-1; idx < this->interaction_offsets[ispin+1]; ++idx)
+            energy += hamiltonian.Energy_Single_Spin((idx < this->interaction_offsets[ispin]) ? ispin : this->interaction_partners[idx], spins);
+        return energy;
+    }
+
+    // Simple sweep of single spin steps
+    void Method_MC::Sweep(vectorfield & spins)
+    {
+        int nos = spins.size();
+        auto& hamiltonian = *this->systems[0]->hamiltonian;
+        // The random numbers of trial idx are drawn from the counters (draw, 2*idx) and (draw, 2*idx+1)
+        auto& prng = this->philox;
+        const std::uint64_t draw = this->parameters_mc->philox.draw++;
+
+        this->Adapt_Cone_Angle();
         scalar cos_cone_angle = std::cos(cone_angle);
 
         // Loop over NOS samples (on average every spin should be hit once per Metropolis step)
         for (int idx=0; idx < nos; ++idx)
         {
+            auto random_1 = prng.Uniform(draw, 2*std::uint64_t(idx));
+            auto random_2 = prng.Uniform(draw, 2*std::uint64_t(idx)+1);
+
             int ispin;
             if (this->parameters_mc->metropolis_random_sample)
                 // Better statistics, but additional calculation of random number
-                ispin = distribution_idx(this->parameters_mc->prng);
+                ispin = std::min(int(random_1[0]*nos), nos-1);
             else
                 // Faster, but worse statistics
                 ispin = idx;
 
-            // Sample a cone
-            if (this->parameters_mc->metropolis_step_cone)
+            // With the local field cache, the step is made from the current state of the spin
+            if (this->use_local_fields)
             {
-                // Calculate local basis for the spin
-                if (spins_old[ispin].z() < 1-1e-10)
-                {
-                    local_basis.col(2) = spins_old[ispin];
-                    local_basis.col(0) = (local_basis.col(2).cross(e_z)).normalized();
-                    local_basis.col(1) = local_basis.col(2).cross(local_basis.col(0));
-                }
-                else
-                {
-                    local_basis = Matrix3::Identity();
-                }
-
-                // Rotation angle between 0 and cone_angle degrees
-                costheta = 1 - (1 - cos_cone_angle) * distribution(this->parameters_mc->prng);
-
-                sintheta = std::sqrt(1 - costheta*costheta);
-
-                // Random distribution of phi between 0 and 360 degrees
-                phi = 2*Constants::Pi * distribution(this->parameters_mc->prng);
+                if (!this->Local_Field_Step(ispin, random_1[1], random_2[0], random_2[1], cos_cone_angle, spins, this->energy_current))
+                    ++this->n_rejected;
+                continue;
+            }
 
-                // New spin orientation in local basis
-                Vector3 local_spin_new{ sintheta * std::cos(phi),
-                                        sintheta * std::sin(phi),
-                                        costheta };
+            const Vector3 spin_current = spins[ispin];
+            const Vector3 spin_trial = this->Trial_Spin(spin_current, random_1[1], random_2[0], cos_cone_angle);
 
-                // New spin orientation in regular basis
-                spins_new[ispin] = local_basis * local_spin_new;
+            // Energy difference of configurations with and without displacement. The single spin energy is only
+            // the share of the spin in the pair terms, so those of its partners have to be included.
+            scalar Ediff;
+            if (this->use_interaction_graph)
+            {
+                scalar Eold = this->Energy_Neighbourhood(ispin, spins);
+                spins[ispin] = spin_trial;
+                Ediff = this->Energy_Neighbourhood(ispin, spins) - Eold;
             }
-            // Sample the entire unit sphere
             else
             {
-                // Rotation angle between 0 and 180 degrees
-                costheta = distribution(this->parameters_mc->prng);
+                spins[ispin] = spin_trial;
+                Ediff = hamiltonian.Energy(spins) - this->energy_current;
+            }
+
+            if (!this->Metropolis_Accept(Ediff, random_2[1]))
+            {
+                // Restore the spin
+                spins[ispin] = spin_current;
+                // Counter for the number of rejections
+                ++this->n_rejected;
+            }
+            else
+                this->energy_current += Ediff;
+        }
+    }
 
-                sintheta = std::sqrt(1 - costheta*costheta);
+    // Parallel sweep over each colour of the interaction graph
+    void Method_MC::Sweep_Parallel(vectorfield & spins)
+    {
+        // The random numbers of spin ispin are drawn from the counters (draw, 2*ispin) and (draw, 2*ispin+1),
+        // so that the result does not depend on the number of threads
+        auto& prng = this->philox;
+        const std::uint64_t draw = this->parameters_mc->philox.draw++;
 
-                // Random distribution of phi between 0 and 360 degrees
-                phi = 2*Constants::Pi * distribution(this->parameters_mc->prng);
+        this->Adapt_Cone_Angle();
+        scalar cos_cone_angle = std::cos(cone_angle);
 
-                // New spin orientation in local basis
-                spins_new[ispin] = Vector3{ sintheta * std::cos(phi),
-                                            sintheta * std::sin(phi),
-                                            costheta };
-            }
+        // Each spin is visited once. The spins of one colour do not interact, so their local fields
+        // only depend on the (fixed) spins of the other colours and their moves are independent.
+        int n_rejected = 0;
+        scalar energy_change = 0;
+        for (auto& spins_colour : this->colour_spins)
+        {
+            int n_spins_colour = spins_colour.size();
+            #pragma omp parallel for reduction(+:n_rejected,energy_change)
+            for (int idx = 0; idx < n_spins_colour; ++idx)
+            {
+                int ispin = spins_colour[idx];
+                auto random_1 = prng.Uniform(draw, 2*std::uint64_t(ispin));
+                auto random_2 = prng.Uniform(draw, 2*std::uint64_t(ispin)+1);
 
-            // Energy difference of configurations with and without displacement
-            scalar Eold  = this->systems[0]->hamiltonian->Energy_Single_Spin(ispin, spins_old);
-            scalar Enew  = this->systems[0]->hamiltonian->Energy_Single_Spin(ispin, spins_new);
-            scalar Ediff = Enew-Eold;
+                // An accepted step updates the fields of the partners, which are distinct for the spins of one colour
+                if (!this->Local_Field_Step(ispin, random_1[1], random_2[0], random_2[1], cos_cone_angle, spins, energy_change))
+                    ++n_rejected;
+            }
+        }
+        this->n_rejected = n_rejected;
+        this->energy_current += energy_change;
+    }
 
-            // Metropolis criterion: reject the step if energy rose
-            if (Ediff > 1e-14)
+    // Wolff cluster updates with the embedding of Ising spins along a random direction r, see U. Wolff, Phys Rev Lett 62, 361 (1989).
+    // The bonds of the exchange energies -J_ij s_i.s_j are activated with the probabilities 1 - exp(min(0, -2 beta J_ij (r.s_i)(r.s_j))),
+    // which satisfies detailed balance for the exchange. The energy difference of the other interactions decides by the
+    // Metropolis criterion whether the reflection of the entire cluster is kept.
+    void Method_MC::Wolff(vectorfield & spins)
+    {
+        // The random numbers are drawn from the counters (draw, index), with the index incremented for each use
+        auto& prng = this->philox;
+        const std::uint64_t draw = this->parameters_mc->philox.draw++;
+        std::uint64_t index = 0;
+        auto& hamiltonian = *this->systems[0]->hamiltonian;
+
+        this->Adapt_Cone_Angle();
+        scalar temperature = this->parameters_mc->temperature;
+        scalar beta = 1 / (Constants::k_B * temperature);
+        const int nos = spins.size();
+
+        // Reflect spin ispin about the plane with the given normal, keeping the energy difference and the local fields
+        scalar Ediff;
+        auto reflect = [&](int ispin, const Vector3 & normal)
+        {
+            const Vector3 spin_old = spins[ispin];
+            const Vector3 spin_new = spin_old - 2 * normal.dot(spin_old) * normal;
+            Ediff += hamiltonian.Energy_Difference_Single_Spin(ispin, spin_new, spins, this->local_fields);
+            spins[ispin] = spin_new;
+            hamiltonian.Update_Local_Fields(ispin, spin_old, spins, this->local_fields);
+        };
+
+        int n_flipped = 0;
+        while (n_flipped < nos)
+        {
+            auto random_1 = prng.Uniform(draw, index++);
+            auto random_2 = prng.Uniform(draw, index++);
+
+            // Random normal of the plane, uniformly on the unit sphere, and random seed spin of the cluster
+            const Vector3 normal = Local_Spin(Matrix3::Identity(), 2*random_1[0] - 1, 2*Constants::Pi * random_1[1]);
+            int iseed = std::min(int(random_2[0]*nos), nos-1);
+
+            // Grow the cluster, reflecting each spin as it is added. The bonds are activated according to the
+            // projections before the reflection, i.e. -normal.s_i for the reflected spins of the cluster.
+            Ediff = 0;
+            this->cluster_spins.clear();
+            this->cluster_spins.push_back(iseed);
+            this->in_cluster[iseed] = 1;
+            reflect(iseed, normal);
+            for (unsigned int icluster = 0; icluster < this->cluster_spins.size(); ++icluster)
             {
-                if (this->parameters_mc->temperature < 1e-12)
+                int ispin = this->cluster_spins[icluster];
+                scalar projection_i = -normal.dot(spins[ispin]);
+                for (int idx = this->exchange_offsets[ispin]; idx < this->exchange_offsets[ispin+1]; ++idx)
                 {
-                    // Restore the spin
-                    spins_new[ispin] = spins_old[ispin];
-                    // Counter for the number of rejections
-                    ++this->n_rejected;
+                    int jspin = this->exchange_partners[idx];
+                    if (this->in_cluster[jspin])
+                        continue;
+
+                    scalar x = 2 * this->exchange_magnitudes[idx] * projection_i * normal.dot(spins[jspin]);
+                    if (x <= 0)
+                        continue;
+                    if (temperature >= 1e-12 && prng.Uniform(draw, index++)[0] >= 1 - std::exp(-beta * x))
+                        continue;
+
+                    this->cluster_spins.push_back(jspin);
+                    this->in_cluster[jspin] = 1;
+                    reflect(jspin, normal);
                 }
-                else
+            }
+            int cluster_size = this->cluster_spins.size();
+            n_flipped += cluster_size;
+
+            // The exchange energy only changes across the boundary of the cluster
+            scalar Ediff_exchange = 0;
+            for (int ispin : this->cluster_spins)
+            {
+                for (int idx = this->exchange_offsets[ispin]; idx < this->exchange_offsets[ispin+1]; ++idx)
                 {
-                    // Exponential factor
-                    scalar exp_ediff    = std::exp( -Ediff/kB_T );
-                    // Metropolis random number
-                    scalar x_metropolis = distribution(this->parameters_mc->prng);
-
-                    // Only reject if random number is larger than exponential
-                    if (exp_ediff < x_metropolis)
-                    {
-                        // Restore the spin
-                        spins_new[ispin] = spins_old[ispin];
-                        // Counter for the number of rejections
-                        ++this->n_rejected;
-                    }
+                    int jspin = this->exchange_partners[idx];
+                    if (!this->in_cluster[jspin])
+                        Ediff_exchange -= 2 * this->exchange_magnitudes[idx] * normal.dot(spins[ispin]) * normal.dot(spins[jspin]);
                 }
             }
+
+            // Metropolis criterion for the energy difference of the other interactions, otherwise reflect the cluster back
+            if (!this->Metropolis_Accept(Ediff - Ediff_exchange, random_2[1]))
+            {
+                for (int icluster = cluster_size-1; icluster >= 0; --icluster)
+                    reflect(this->cluster_spins[icluster], normal);
+                this->n_rejected += cluster_size;
+            }
+            else
+                this->energy_current += Ediff;
+
+            for (int ispin : this->cluster_spins)
+                this->in_cluster[ispin] = 0;
         }
     }
 
-    // TODO:
-    // Implement heat bath algorithm, see Y. Miyatake et al, J Phys C: Solid State Phys 19, 2539 (1986)
-    // void Method_MC::HeatBath(const vectorfield & spins_old, vectorfield & spins_new)
-    // {
-    // }
-
     void Method_MC::Hook_Pre_Iteration()
     {
     }
 
     void Method_MC::Hook_Post_Iteration()
     {
+        // The energy of the new spins was sampled, so it does not need to be calculated again on demand
+        this->systems[0]->SetEnergy(this->sample_energy);
+        // The local fields and the energy were updated with the spins, which the iteration has marked as changed
+        this->cached_changes = this->systems[0]->Changes();
     }
 
     void Method_MC::Initialize()
@@ -221,7 +588,8 @@ namespace Engine
         block.push_back(fmt::format("------------  Started  {} Calculation  ------------", this->Name()));
         block.push_back(fmt::format("    Going to iterate {} steps", this->n_log));
         block.push_back(fmt::format("                with {} iterations per step", this->n_iterations_log));
-        if (this->parameters_mc->metropolis_step_cone)
+        block.push_back(fmt::format("   Algorithm: {}", this->use_wolff ? "Wolff clusters" : this->use_heat_bath ? "heat bath" : "Metropolis"));
+        if (this->parameters_mc->metropolis_step_cone && !this->use_heat_bath && !this->use_wolff)
         {
             block.push_back(fmt::format("   Target acceptance {}", this->parameters_mc->acceptance_ratio_target));
             block.push_back(fmt::format("   Cone angle (deg): {}", this->cone_angle*180/Constants::Pi));
@@ -236,7 +604,7 @@ namespace Engine
         auto t_current = system_clock::now();
 
         // Update the system's energy
-        this->systems[0]->UpdateEnergy();
+        this->systems[0]->UpdateEnergy(false);
 
         // Send log message
         std::vector<std::string> block(0);
@@ -245,7 +613,7 @@ namespace Engine
         block.push_back(fmt::format("    Iteration                 {} / {}", this->iteration, this->n_iterations));
         block.push_back(fmt::format("    Time since last step:     {}", Timing::DateTimePassed(t_current - this->t_last)));
         block.push_back(fmt::format("    Iterations / sec:         {}", this->n_iterations_log / Timing::SecondsPassed(t_current - this->t_last)));
-        if (this->parameters_mc->metropolis_step_cone)
+        if (this->parameters_mc->metropolis_step_cone && !this->use_heat_bath && !this->use_wolff)
         {
             block.push_back(fmt::format("    Current acceptance ratio: {} (target {})", this->acceptance_ratio_current, this->parameters_mc->acceptance_ratio_target));
             block.push_back(fmt::format("    Current cone angle (deg): {}", this->cone_angle*180/Constants::Pi));
@@ -270,7 +638,7 @@ namespace Engine
             reason = "The maximum walltime has been reached";
 
         // Update the system's energy
-        this->systems[0]->UpdateEnergy();
+        this->systems[0]->UpdateEnergy(false);
 
         //---- Log messages
         std::vector<std::string> block;
@@ -281,7 +649,7 @@ namespace Engine
         block.push_back(fmt::format("    Step              {} / {}", step, n_log));
         block.push_back(fmt::format("    Iteration         {} / {}", this->iteration, n_iterations));
         block.push_back(fmt::format("    Iterations / sec: {}", this->iteration / Timing::SecondsPassed(t_end - this->t_start)));
-        if (this->parameters_mc->metropolis_step_cone)
+        if (this->parameters_mc->metropolis_step_cone && !this->use_heat_bath && !this->use_wolff)
         {
             block.push_back(fmt::format("    Acceptance ratio: {} (target {})", this->acceptance_ratio_current, this->parameters_mc->acceptance_ratio_target));
             block.push_back(fmt::format("    Cone angle (deg): {}", this->cone_angle*180/Constants::Pi));
@@ -294,6 +662,27 @@ namespace Engine
 
     void Method_MC::Save_Current(std::string starttime, int iteration, bool initial, bool final)
     {
+        // The thermal averages are written once, at the end
+        if (this->parameters->output_any && this->parameters->output_final && final)
+        {
+            std::string fileTag;
+            if (this->parameters->output_file_tag == "<time>")
+                fileTag = starttime + "_";
+            else if (this->parameters->output_file_tag != "")
+                fileTag = this->parameters->output_file_tag + "_";
+            else
+                fileTag = "";
+
+            try
+            {
+                auto s_img = fmt::format("{:0>2}", this->idx_image);
+                IO::Write_MC_Observables(*this->systems[0], this->parameters->output_folder + "/" + fileTag + "Image-" + s_img + "_MC_Observables.txt");
+            }
+            catch( ... )
+            {
+                spirit_handle_exception_core( "MC output failed" );
+            }
+        }
     }
 
     // Method name as string
@@ -0,0 +1,232 @@
+#include <Spirit_Defines.h>
+#include <engine/Method_PT.hpp>
+#include <data/Spin_System_Chain.hpp>
+#include <utility/Constants.hpp>
+#include <utility/Logging.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <math.h>
+
+using namespace Utility;
+
+namespace Engine
+{
+    Method_PT::Method_PT(std::shared_ptr<Data::Spin_System_Chain> chain, int idx_chain) :
+        Method(chain->images[0]->mc_parameters, -1, idx_chain), chain(chain)
+    {
+        this->systems = chain->images;
+        this->SenderName = Log_Sender::MC;
+
+        this->noi = this->systems.size();
+        this->nos = this->systems[0]->nos;
+
+        this->force_max_abs_component = 0;
+
+        // History
+        this->history = std::map<std::string, std::vector<scalar>>{
+            {"max_torque_component", {this->force_max_abs_component}} };
+
+        // The replicas. Images inserted into a chain are copies with the same seed, so each replica draws
+        // from the stream of its index, in order for the replicas to draw independent numbers.
+        for (int img = 0; img < this->noi; ++img)
+            this->replicas.push_back(std::shared_ptr<Method_MC>(new Method_MC(chain->images[img], img, idx_chain, img)));
+        this->energies       = std::vector<scalar>(this->noi, 0);
+        this->magnetizations = std::vector<scalar>(this->noi, 0);
+
+        // The statistics are collected anew in each run
+        this->chain->pt_exchanges_attempted = std::vector<int>(this->noi-1, 0);
+        this->chain->pt_exchanges_accepted  = std::vector<int>(this->noi-1, 0);
+        this->chain->pt_energy_mean         = std::vector<scalar>(this->noi, 0);
+        this->chain->pt_magnetization_mean  = std::vector<scalar>(this->noi, 0);
+    }
+
+    void Method_PT::Iteration()
+    {
+        // The replicas are independent and swept in parallel. Each draws its random numbers from the
+        // counter-based generator of its image, so that the result does not depend on the number of threads.
+        #pragma omp parallel for
+        for (int img = 0; img < this->noi; ++img)
+        {
+            this->replicas[img]->Iteration();
+            this->energies[img]       = this->replicas[img]->sample_energy;
+            this->magnetizations[img] = this->replicas[img]->sample_magnetization.norm();
+        }
+
+        // Exchanges of the even and odd pairs of neighbouring images alternate between iterations
+        for (int i = this->iteration % 2; i < this->noi-1; i += 2)
+            this->Exchange(i);
+
+        // Running means at the temperature of each image
+        scalar n_samples = this->iteration + 1;
+        for (int img = 0; img < this->noi; ++img)
+        {
+            this->chain->pt_energy_mean[img]        += (this->energies[img] - this->chain->pt_energy_mean[img]) / n_samples;
+            this->chain->pt_magnetization_mean[img] += (this->magnetizations[img] - this->chain->pt_magnetization_mean[img]) / n_samples;
+        }
+    }
+
+    void Method_PT::Exchange(int i)
+    {
+        auto& image_1 = *this->chain->images[i];
+        auto& image_2 = *this->chain->images[i+1];
+
+        // Metropolis criterion for the exchange: min(1, exp((beta_1-beta_2)*(E_1-E_2))).
+        // At zero temperature beta is infinite, which yields the limits of the criterion. Replicas at the
+        // same temperature or with the same energy are always exchanged, which also avoids inf-inf and 0*inf.
+        scalar temperature_1 = image_1.mc_parameters->temperature;
+        scalar temperature_2 = image_2.mc_parameters->temperature;
+        scalar delta = 0;
+        if (temperature_1 != temperature_2 && this->energies[i] != this->energies[i+1])
+        {
+            scalar beta_1 = 1 / (Constants::k_B * temperature_1);
+            scalar beta_2 = 1 / (Constants::k_B * temperature_2);
+            delta = (beta_1 - beta_2) * (this->energies[i] - this->energies[i+1]);
+        }
+
+        // The random number is drawn from the stream of the replica of the first image
+        auto& prng = this->replicas[i]->philox;
+        scalar random = prng.Uniform(image_1.mc_parameters->philox.draw++, 0)[0];
+
+        ++this->chain->pt_exchanges_attempted[i];
+        if (delta >= 0 || random < std::exp(delta))
+        {
+            // The configurations are exchanged by swapping the pointers to the spins
+            std::swap(image_1.spins, image_2.spins);
+            std::swap(this->energies[i], this->energies[i+1]);
+            std::swap(this->magnetizations[i], this->magnetizations[i+1]);
+            ++this->chain->pt_exchanges_accepted[i];
+        }
+    }
+
+    std::vector<scalar> Method_PT::Exchange_Ratios()
+    {
+        std::vector<scalar> ratios(this->noi-1, 0);
+        for (int i = 0; i < this->noi-1; ++i)
+        {
+            if (this->chain->pt_exchanges_attempted[i] > 0)
+                ratios[i] = (scalar)this->chain->pt_exchanges_accepted[i] / (scalar)this->chain->pt_exchanges_attempted[i];
+        }
+        return ratios;
+    }
+
+    void Method_PT::Hook_Pre_Iteration()
+    {
+    }
+
+    void Method_PT::Hook_Post_Iteration()
+    {
+        // The energies of the new spins of the images were sampled, so they do not need to be calculated again on demand
+        // The local fields and energies of the replicas were updated with the spins, unless the spins were exchanged
+        for (int img = 0; img < this->noi; ++img)
+        {
+            this->chain->images[img]->SetEnergy(this->energies[img]);
+            this->replicas[img]->cached_changes = this->chain->images[img]->Changes();
+        }
+    }
+
+    void Method_PT::Finalize()
+    {
+        this->chain->iteration_allowed = false;
+    }
+
+    bool Method_PT::Iterations_Allowed()
+    {
+        return this->chain->iteration_allowed;
+    }
+
+    void Method_PT::Lock()
+    {
+        this->chain->Lock();
+    }
+
+    void Method_PT::Unlock()
+    {
+        this->chain->Unlock();
+    }
+
+    void Method_PT::Message_Start()
+    {
+        std::string temperatures = "";
+        for (auto& image : this->chain->images)
+            temperatures += fmt::format(" {}", image->mc_parameters->temperature);
+
+        //---- Log messages
+        std::vector<std::string> block(0);
+        block.push_back(fmt::format("------------  Started  {} Calculation  ------------", this->Name()));
+        block.push_back(fmt::format("    Going to iterate {} steps", this->n_log));
+        block.push_back(fmt::format("                with {} iterations per step", this->n_iterations_log));
+        block.push_back(fmt::format("    Number of replicas: {}", this->noi));
+        block.push_back(fmt::format("    Temperatures (K):  {}", temperatures));
+        block.push_back("-----------------------------------------------------");
+        Log.SendBlock(Log_Level::All, this->SenderName, block, this->idx_image, this->idx_chain);
+    }
+
+    void Method_PT::Message_Step()
+    {
+        // Update time of current step
+        auto t_current = system_clock::now();
+
+        std::string ratios = "";
+        for (auto ratio : this->Exchange_Ratios())
+            ratios += fmt::format(" {:.3f}", ratio);
+
+        // Send log message
+        std::vector<std::string> block(0);
+        block.push_back(fmt::format("----- {} Calculation: {}", this->Name(), Timing::DateTimePassed(t_current - this->t_start)));
+        block.push_back(fmt::format("    Step                      {} / {} (step size {})", this->step, this->n_log, this->n_iterations_log));
+        block.push_back(fmt::format("    Iteration                 {} / {}", this->iteration, this->n_iterations));
+        block.push_back(fmt::format("    Time since last step:     {}", Timing::DateTimePassed(t_current - this->t_last)));
+        block.push_back(fmt::format("    Iterations / sec:         {}", this->n_iterations_log / Timing::SecondsPassed(t_current - this->t_last)));
+        block.push_back(fmt::format("    Exchange ratios:         {}", ratios));
+        Log.SendBlock(Log_Level::All, this->SenderName, block, this->idx_image, this->idx_chain);
+
+        // Update time of last step
+        this->t_last = t_current;
+    }
+
+    void Method_PT::Message_End()
+    {
+        //---- End timings
+        auto t_end = system_clock::now();
+
+        //---- Termination reason
+        std::string reason = "";
+        if (this->StopFile_Present())
+            reason = "A STOP file has been found";
+        else if (this->Walltime_Expired(t_end - this->t_start))
+            reason = "The maximum walltime has been reached";
+
+        std::string ratios = "";
+        for (auto ratio : this->Exchange_Ratios())
+            ratios += fmt::format(" {:.3f}", ratio);
+        std::string energies = "";
+        for (auto energy : this->chain->pt_energy_mean)
+            energies += fmt::format(" {:.10f}", energy);
+
+        //---- Log messages
+        std::vector<std::string> block;
+        block.push_back(fmt::format("------------ Terminated {} Calculation ------------", this->Name()));
+        if (reason.length() > 0)
+            block.push_back(fmt::format("----- Reason:   {}", reason));
+        block.push_back(fmt::format("----- Duration:       {}", Timing::DateTimePassed(t_end - this->t_start)));
+        block.push_back(fmt::format("    Step              {} / {}", step, n_log));
+        block.push_back(fmt::format("    Iteration         {} / {}", this->iteration, n_iterations));
+        block.push_back(fmt::format("    Iterations / sec: {}", this->iteration / Timing::SecondsPassed(t_end - this->t_start)));
+        block.push_back(fmt::format("    Exchange ratios: {}", ratios));
+        block.push_back(fmt::format("    Mean energies:   {}", energies));
+        block.push_back("-----------------------------------------------------");
+        Log.SendBlock(Log_Level::All, this->SenderName, block, this->idx_image, this->idx_chain);
+    }
+
+    void Method_PT::Save_Current(std::string starttime, int iteration, bool initial, bool final)
+    {
+        // The thermal averages at the temperature of each image
+        for (auto& replica : this->replicas)
+            replica->Save_Current(starttime, iteration, initial, final);
+    }
+
+    // Method name as string
+    std::string Method_PT::Name() { return "PT"; }
+}
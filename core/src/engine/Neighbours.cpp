@@ -2,70 +2,220 @@
 
 #include <Eigen/Dense>
 
+#include <algorithm>
+#include <array>
+
 namespace Engine
 {
     namespace Neighbours
     {
+        namespace
+        {
+            // A pair of basis atoms with the translation of the second one and their distance
+            struct Lattice_Pair
+            {
+                int iatom, jatom;
+                std::array<int,3> translations;
+                scalar distance;
+            };
+
+            // The pairs are returned ordered by first atom, descending translations and second atom
+            bool Pair_Order(const Lattice_Pair & p1, const Lattice_Pair & p2)
+            {
+                if (p1.iatom != p2.iatom) return p1.iatom < p2.iatom;
+                for (int dim = 0; dim < 3; ++dim)
+                    if (p1.translations[dim] != p2.translations[dim]) return p1.translations[dim] > p2.translations[dim];
+                return p1.jatom < p2.jatom;
+            }
+
+            /*
+                All pairs of basis atoms (at the positions x) with translations |t_dim| <= tmax[dim] for which
+                |x_j + t_0*a + t_1*b + t_2*c - x_i| < radius.
+                Instead of scanning the whole translation box, the translations are bounded in turn by the
+                sphere: the range of t_0 follows from the reciprocal vector of a, for each t_0 the range of t_1
+                follows from the disc in which the plane of b and c cuts the sphere and for each (t_0,t_1) the
+                range of t_2 is the solution of a quadratic equation. The work therefore scales with the number
+                of pairs found. The pairs of the (atom, atom, t_0) slabs are searched in parallel.
+            */
+            std::vector<Lattice_Pair> Get_Pairs_in_Sphere(const std::vector<Vector3> & x, const Vector3 & a, const Vector3 & b, const Vector3 & c,
+                std::array<int,3> tmax, scalar radius)
+            {
+                const int n_atoms = x.size();
+                // Rounding tolerance of the bounds, the distances are checked exactly below
+                const scalar slack = 1e-8;
+
+                // Degenerate bravais vectors cannot be inverted, in which case the whole box is scanned
+                Vector3 bc = b.cross(c);
+                scalar volume = a.dot(bc);
+                bool degenerate = std::abs(volume) <= 1e-12 * a.norm() * b.norm() * c.norm() || volume == 0;
+                Vector3 a_reciprocal{0,0,0}, b_reciprocal{0,0,0}, normal{0,0,0};
+                if (!degenerate)
+                {
+                    // Reciprocal vector of a, unit normal of the plane of b and c and the reciprocal vector of b within it
+                    a_reciprocal = bc / volume;
+                    normal = bc.normalized();
+                    Vector3 c_normal = c.cross(normal);
+                    b_reciprocal = c_normal / b.dot(c_normal);
+                }
+
+                auto clamp_range = [slack](scalar lower, scalar upper, int t, int & tmin_out, int & tmax_out)
+                {
+                    tmin_out = std::max(-t, (int)std::max(scalar(-t-1), std::ceil(lower - slack)));
+                    tmax_out = std::min( t, (int)std::min(scalar( t+1), std::floor(upper + slack)));
+                };
+
+                // The slabs of constant t_0 to be searched
+                std::vector<std::array<int,3>> slabs(0);
+                for (int iatom = 0; iatom < n_atoms; ++iatom)
+                {
+                    for (int jatom = 0; jatom < n_atoms; ++jatom)
+                    {
+                        int t0_min = -tmax[0], t0_max = tmax[0];
+                        if (!degenerate)
+                        {
+                            scalar center = -(x[jatom] - x[iatom]).dot(a_reciprocal);
+                            scalar extent = radius * a_reciprocal.norm();
+                            clamp_range(center - extent, center + extent, tmax[0], t0_min, t0_max);
+                        }
+                        for (int t0 = t0_min; t0 <= t0_max; ++t0)
+                            slabs.push_back({iatom, jatom, t0});
+                    }
+                }
+
+                std::vector<std::vector<Lattice_Pair>> slab_pairs(slabs.size());
+                #pragma omp parallel for schedule(dynamic)
+                for (int islab = 0; islab < (int)slabs.size(); ++islab)
+                {
+                    int iatom = slabs[islab][0], jatom = slabs[islab][1], t0 = slabs[islab][2];
+                    Vector3 offset = x[jatom] - x[iatom] + t0*a;
+
+                    // Range of t_1 within the disc cut out of the sphere by the plane of b and c
+                    int t1_min = -tmax[1], t1_max = tmax[1];
+                    if (!degenerate)
+                    {
+                        scalar height = offset.dot(normal);
+                        if (std::abs(height) > radius * (1 + slack)) continue;
+                        scalar disc_radius = std::sqrt(std::max(scalar(0), radius*radius - height*height)) + slack * radius;
+                        scalar center = -offset.dot(b_reciprocal);
+                        scalar extent = disc_radius * b_reciprocal.norm();
+                        clamp_range(center - extent, center + extent, tmax[1], t1_min, t1_max);
+                    }
+
+                    for (int t1 = t1_min; t1 <= t1_max; ++t1)
+                    {
+                        Vector3 offset_1 = offset + t1*b;
+
+                        // Range of t_2 from |offset_1 + t_2*c|^2 < radius^2
+                        int t2_min = -tmax[2], t2_max = tmax[2];
+                        scalar c2 = c.squaredNorm();
+                        if (!degenerate && c2 > 0)
+                        {
+                            scalar p = offset_1.dot(c) / c2;
+                            scalar q = (offset_1.squaredNorm() - radius*radius) / c2;
+                            scalar discriminant = p*p - q;
+                            if (discriminant < -slack) continue;
+                            scalar root = std::sqrt(std::max(scalar(0), discriminant)) + slack;
+                            clamp_range(-p - root, -p + root, tmax[2], t2_min, t2_max);
+                        }
+
+                        for (int t2 = t2_min; t2 <= t2_max; ++t2)
+                        {
+                            scalar distance = (offset_1 + t2*c).norm();
+                            if (distance < radius * (1 + slack))
+                                slab_pairs[islab].push_back({iatom, jatom, {t0, t1, t2}, distance});
+                        }
+                    }
+                }
+
+                std::vector<Lattice_Pair> pairs(0);
+                for (auto & p : slab_pairs)
+                    pairs.insert(pairs.end(), p.begin(), p.end());
+                std::sort(pairs.begin(), pairs.end(), Pair_Order);
+                return pairs;
+            }
+
+            // Positions of the basis atoms in units of length
+            std::vector<Vector3> Basis_Positions(const Data::Geometry & geometry)
+            {
+                auto x = std::vector<Vector3>(geometry.n_cell_atoms);
+                for (int iatom = 0; iatom < geometry.n_cell_atoms; ++iatom)
+                    x[iatom] =  geometry.cell_atoms[iatom][0] * geometry.bravais_vectors[0]
+                              + geometry.cell_atoms[iatom][1] * geometry.bravais_vectors[1]
+                              + geometry.cell_atoms[iatom][2] * geometry.bravais_vectors[2];
+                return x;
+            }
+
+            // The translations which fit into the lattice without wrapping onto themselves
+            std::array<int,3> Shell_Translations(const Data::Geometry & geometry)
+            {
+                std::array<int,3> tmax{{0,0,0}};
+                for (int dim = 0; dim < 3; ++dim)
+                {
+                    if (geometry.bravais_vectors[dim].norm() > 0)
+                        tmax[dim] = std::max(0, geometry.n_cells[dim]-1);
+                }
+                return tmax;
+            }
+
+            // The exact distance of a pair, evaluated in the same way for the search and the classification into shells
+            scalar Pair_Distance(const std::vector<Vector3> & x, const Data::Geometry & geometry, const Lattice_Pair & pair)
+            {
+                const auto & t = pair.translations;
+                Vector3 x1 = x[pair.jatom] + t[0]*geometry.bravais_vectors[0] + t[1]*geometry.bravais_vectors[1] + t[2]*geometry.bravais_vectors[2];
+                return (x[pair.iatom] - x1).norm();
+            }
+        }
+
         std::vector<scalar> Get_Shell_Radius(const Data::Geometry & geometry, const int n_shells)
         {
             const scalar shell_width = 1e-3;
-            auto shell_radius = std::vector<scalar>(n_shells);
-
-            Vector3 a = geometry.bravais_vectors[0];
-            Vector3 b = geometry.bravais_vectors[1];
-            Vector3 c = geometry.bravais_vectors[2];
-
-            // The n_shells + 2 is a value that is big enough by experience to 
-            // produce enough needed shells, but is small enough to run sufficiently fast
-            int tMax = n_shells + 2;
-            int imax = std::min(tMax, geometry.n_cells[0]-1),
-                jmax = std::min(tMax, geometry.n_cells[1]-1),
-                kmax = std::min(tMax, geometry.n_cells[2]-1);
-
-            // Abort condidions for all 3 vectors
-            if (a.norm() == 0.0) imax = 0;
-            if (b.norm() == 0.0) jmax = 0;
-            if (c.norm() == 0.0) kmax = 0;
-
-            int i, j, k, iatom, jatom, ishell;
-            scalar current_radius=0, dx, min_distance=0;
-            Vector3 x0={0,0,0}, x1={0,0,0};
-            for (ishell = 0; ishell < n_shells; ++ishell)
+            auto shell_radius = std::vector<scalar>(n_shells, 0);
+            if (n_shells <= 0) return shell_radius;
+
+            auto x    = Basis_Positions(geometry);
+            auto tmax = Shell_Translations(geometry);
+            const Vector3 & a = geometry.bravais_vectors[0];
+            const Vector3 & b = geometry.bravais_vectors[1];
+            const Vector3 & c = geometry.bravais_vectors[2];
+
+            // No pair is further apart than the size of the translation box plus the basis cell
+            scalar basis_size = 0;
+            for (int iatom = 0; iatom < geometry.n_cell_atoms; ++iatom)
+                for (int jatom = 0; jatom < geometry.n_cell_atoms; ++jatom)
+                    basis_size = std::max(basis_size, (x[jatom] - x[iatom]).norm());
+            scalar max_radius = tmax[0]*a.norm() + tmax[1]*b.norm() + tmax[2]*c.norm() + basis_size + shell_width;
+
+            // Grow the search radius until it contains enough shells
+            scalar radius = 0;
+            for (int dim = 0; dim < 3; ++dim)
+                if (geometry.bravais_vectors[dim].norm() > 0 && (radius == 0 || geometry.bravais_vectors[dim].norm() < radius))
+                    radius = geometry.bravais_vectors[dim].norm();
+            if (radius == 0) radius = max_radius;
+
+            while (true)
             {
-                min_distance = current_radius;
-                current_radius = 1e10;
-                for (iatom = 0; iatom < geometry.n_cell_atoms; ++iatom)
+                auto pairs = Get_Pairs_in_Sphere(x, a, b, c, tmax, radius);
+                scalarfield distances(0);
+                for (auto & pair : pairs)
+                    distances.push_back(Pair_Distance(x, geometry, pair));
+                std::sort(distances.begin(), distances.end());
+
+                // Each shell starts at the smallest distance beyond the previous shell
+                int n_found = 0;
+                scalar current_radius = 0;
+                for (scalar dx : distances)
                 {
-                    x0 =  geometry.cell_atoms[iatom][0] * a
-                        + geometry.cell_atoms[iatom][1] * b
-                        + geometry.cell_atoms[iatom][2] * c;
-                    // Note: due to symmetry we only need to check half the space
-                    for (i = imax; i >= 0; --i)
+                    if (dx >= radius) break;
+                    if (dx - current_radius > shell_width)
                     {
-                        for (j = jmax; j >= -jmax; --j)
-                        {
-                            for (k = kmax; k >= -kmax; --k)
-                            {
-                                for (jatom = 0; jatom < geometry.n_cell_atoms; ++jatom)
-                                {
-                                    if ( !( iatom==jatom && i==0 && j==0 && k==0 ) )
-                                    {
-                                        x1 =  geometry.cell_atoms[jatom][0] * a
-                                            + geometry.cell_atoms[jatom][1] * b
-                                            + geometry.cell_atoms[jatom][2] * c
-                                            + i*a + j*b + k*c;
-                                        dx = (x0-x1).norm();
-                                        if (dx - min_distance > shell_width && dx < current_radius)
-                                        {
-                                            current_radius = dx;
-                                            shell_radius[ishell] = dx;
-                                        }
-                                    }
-                                }//endfor jatom
-                            }//endfor k
-                        }//endfor j
-                    }//endfor i
-                }//endfor iatom
+                        current_radius = dx;
+                        if (n_found < n_shells) shell_radius[n_found] = dx;
+                        ++n_found;
+                    }
+                }
+
+                if (n_found >= n_shells || radius >= max_radius) break;
+                radius = std::min(2*radius, max_radius);
             }
 
             return shell_radius;
@@ -75,82 +225,40 @@ namespace Engine
         {
             const scalar shell_width = 1e-3;
             auto shell_radius = Get_Shell_Radius(geometry, n_shells);
-            
-            Vector3 a = geometry.bravais_vectors[0];
-            Vector3 b = geometry.bravais_vectors[1];
-            Vector3 c = geometry.bravais_vectors[2];
-
-            // The n_shells + 2 is a value that is big enough by experience to 
-            // produce enough needed shells, but is small enough to run sufficiently fast
-            int tMax = n_shells + 2;
-            int imax = std::min(tMax, geometry.n_cells[0]-1),
-                jmax = std::min(tMax, geometry.n_cells[1]-1),
-                kmax = std::min(tMax, geometry.n_cells[2]-1);
-            int imin, jmin, kmin, jatommin;
-            // If redundant neighbours should not be used, we restrict the search to half of the space
-            if( use_redundant_neighbours )
-            {
-                imin=-imax; jmin=-jmax; kmin=-kmax;
-            }
-            else
+            if (n_shells <= 0) return;
+
+            auto x    = Basis_Positions(geometry);
+            auto tmax = Shell_Translations(geometry);
+
+            scalar radius = *std::max_element(shell_radius.begin(), shell_radius.end()) + shell_width;
+            auto pairs = Get_Pairs_in_Sphere(x, geometry.bravais_vectors[0], geometry.bravais_vectors[1], geometry.bravais_vectors[2], tmax, radius);
+
+            // Sort the pairs into the shells, ordered by first atom and shell
+            std::vector<std::vector<std::pair<Pair,int>>> atom_neighbours(geometry.n_cell_atoms);
+            for (int ishell = 0; ishell < n_shells; ++ishell)
             {
-                imin=0; jmin=-jmax; kmin=-kmax;
-            }
+                for (auto & pair : pairs)
+                {
+                    const auto & t = pair.translations;
+                    // Without redundant neighbours, only half of the space is used
+                    if (!use_redundant_neighbours && !( t[0] >= 0 && pair.jatom >= pair.iatom &&
+                        ( pair.jatom > pair.iatom || t[0] > 0 || (t[0] == 0 && t[1] > 0) || (t[0] == 0 && t[1] == 0 && t[2] > 0) ) ))
+                        continue;
 
-            // Abort condidions for all 3 vectors
-            if (a.norm() == 0.0) imax = 0;
-            if (b.norm() == 0.0) jmax = 0;
-            if (c.norm() == 0.0) kmax = 0;
+                    scalar dx = Pair_Distance(x, geometry, pair);
+                    if (dx > 0 && std::abs(dx - shell_radius[ishell]) < shell_width)
+                        atom_neighbours[pair.iatom].push_back({ Pair{pair.iatom, pair.jatom, {t[0], t[1], t[2]}}, ishell });
+                }
+            }
 
-            int i, j, k, iatom, jatom, ishell;
-            scalar dx, radius;
-            Vector3 x0={0,0,0}, x1={0,0,0};
-            for (iatom = 0; iatom < geometry.n_cell_atoms; ++iatom)
+            for (auto & neighbours_of_atom : atom_neighbours)
             {
-                if( use_redundant_neighbours )
-                    jatommin=0;
-                else
-                    jatommin=iatom;
-
-                x0 =  geometry.cell_atoms[iatom][0] * a
-                    + geometry.cell_atoms[iatom][1] * b
-                    + geometry.cell_atoms[iatom][2] * c;
-                for (ishell = 0; ishell < n_shells; ++ishell)
+                for (auto & neigh : neighbours_of_atom)
                 {
-                    radius = shell_radius[ishell];
-                    for (i = imax; i >= imin; --i)
-                    {
-                        for (j = jmax; j >= jmin; --j)
-                        {
-                            for (k = kmax; k >= kmin; --k)
-                            {
-                                for (jatom = jatommin; jatom < geometry.n_cell_atoms; ++jatom)
-                                {
-                                    if ((jatom > iatom) || (i>0 || (i==0 && j>0) || (i==0 && j==0 && k>0)) || use_redundant_neighbours)
-                                    {
-                                        x1 =  geometry.cell_atoms[jatom][0] * a
-                                            + geometry.cell_atoms[jatom][1] * b
-                                            + geometry.cell_atoms[jatom][2] * c
-                                            + i*a + j*b + k*c;
-                                        dx = (x0-x1).norm();
-                                        if (std::abs(dx - radius) < shell_width)
-                                        {
-                                            Pair neigh;
-                                            neigh.i = iatom;
-                                            neigh.j = jatom;
-                                            neigh.translations[0] = i;
-                                            neigh.translations[1] = j;
-                                            neigh.translations[2] = k;
-                                            neighbours.push_back( neigh );
-                                            shells.push_back(ishell);
-                                        }
-                                    }
-                                }//endfor jatom
-                            }//endfor k
-                        }//endfor j
-                    }//endfor i
-                }//endfor ishell
-            }//endfor iatom
+                    neighbours.push_back( neigh.first );
+                    shells.push_back( neigh.second );
+                }
+            }
         }
 
 
@@ -164,52 +272,22 @@ namespace Engine
                 Vector3 b = geometry.bravais_vectors[1];
                 Vector3 c = geometry.bravais_vectors[2];
 
+                // Translations up to the size of the lattice along all extended directions
                 Vector3 bounds_diff = geometry.bounds_max - geometry.bounds_min;
-                Vector3 ratio = {
-                    bounds_diff[0]/std::max(1, geometry.n_cells[0]),
-                    bounds_diff[1]/std::max(1, geometry.n_cells[1]),
-                    bounds_diff[2]/std::max(1, geometry.n_cells[2]) };
-
-                // This should give enough translations to contain all DDI pairs
-                int imax = 0, jmax = 0, kmax = 0;
-                if ( bounds_diff[0] > 0 )
-                    imax = std::min(geometry.n_cells[0], (int)(1.1 * radius * geometry.n_cells[0] / bounds_diff[0]));
-                if ( bounds_diff[1] > 0 )
-                    jmax = std::min(geometry.n_cells[1], (int)(1.1 * radius * geometry.n_cells[1] / bounds_diff[1]));
-                if ( bounds_diff[2] > 0 )
-                    kmax = std::min(geometry.n_cells[2], (int)(1.1 * radius * geometry.n_cells[2] / bounds_diff[2]));
-
-                int i,j,k;
-                scalar dx;
-                Vector3 x0={0,0,0}, x1={0,0,0};
-
-                // Abort condidions for all 3 vectors
-                if (a.norm() == 0.0) imax = 0;
-                if (b.norm() == 0.0) jmax = 0;
-                if (c.norm() == 0.0) kmax = 0;
+                std::array<int,3> tmax{{0,0,0}};
+                for (int dim = 0; dim < 3; ++dim)
+                {
+                    if (bounds_diff[dim] > 0 && geometry.bravais_vectors[dim].norm() > 0)
+                        tmax[dim] = geometry.n_cells[dim];
+                }
 
-                for (int iatom = 0; iatom < geometry.n_cell_atoms; ++iatom)
+                for (auto & pair : Get_Pairs_in_Sphere(geometry.cell_atoms, a, b, c, tmax, radius))
                 {
-                    x0 = geometry.cell_atoms[iatom];
-                    for (i = imax; i >= -imax; --i)
-                    {
-                        for (j = jmax; j >= -jmax; --j)
-                        {
-                            for (k = kmax; k >= -kmax; --k)
-                            {
-                                for (int jatom = 0; jatom < geometry.n_cell_atoms; ++jatom)
-                                {
-                                    x1 = geometry.cell_atoms[jatom] + i*a + j*b + k*c;
-                                    dx = (x0-x1).norm();
-                                    if (dx < radius)
-                                    {
-                                        pairs.push_back( {iatom, jatom, {i, j, k} } );
-                                    }
-                                }//endfor jatom
-                            }//endfor k
-                        }//endfor j
-                    }//endfor i
-                }//endfor iatom
+                    Vector3 x1 = geometry.cell_atoms[pair.jatom] + pair.translations[0]*a + pair.translations[1]*b + pair.translations[2]*c;
+                    scalar dx = (geometry.cell_atoms[pair.iatom] - x1).norm();
+                    if (dx < radius)
+                        pairs.push_back( {pair.iatom, pair.jatom, {pair.translations[0], pair.translations[1], pair.translations[2]}} );
+                }
             }
 
             return pairs;
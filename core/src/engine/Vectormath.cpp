@@ -18,7 +18,73 @@ namespace Engine
 {
     namespace Vectormath
     {
-        
+        #ifdef SPIRIT_USE_SIMD
+        // The vectorfields are stored as arrays of structures (x,y,z,x,y,z,...), which does not
+        // vectorise well for per-spin operations such as cross products and norms. The kernels
+        // below therefore transpose blocks of spins into small structure-of-arrays tiles, do
+        // the arithmetic across the spins of a tile and transpose the result back.
+        // Purely component-wise operations work on the flat array of scalars instead.
+        namespace
+        {
+            // Number of spins per tile (a multiple of the SIMD width for any scalar type)
+            constexpr int simd_tile = 16;
+
+            // The scalars of a vectorfield as one flat array
+            inline const scalar * flat_data(const vectorfield & vf)
+            {
+                return reinterpret_cast<const scalar *>(vf.data());
+            }
+            inline scalar * flat_data(vectorfield & vf)
+            {
+                return reinterpret_cast<scalar *>(vf.data());
+            }
+
+            struct SoA_Tile
+            {
+                alignas(64) scalar x[simd_tile];
+                alignas(64) scalar y[simd_tile];
+                alignas(64) scalar z[simd_tile];
+            };
+
+            inline void tile_load(const vectorfield & vf, int offset, int n, SoA_Tile & tile)
+            {
+                const scalar * data = flat_data(vf) + 3*offset;
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    tile.x[i] = data[3*i];
+                    tile.y[i] = data[3*i+1];
+                    tile.z[i] = data[3*i+2];
+                }
+            }
+
+            inline void tile_store(const SoA_Tile & tile, int offset, int n, vectorfield & vf)
+            {
+                scalar * data = flat_data(vf) + 3*offset;
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    data[3*i]   = tile.x[i];
+                    data[3*i+1] = tile.y[i];
+                    data[3*i+2] = tile.z[i];
+                }
+            }
+
+            // Call kernel(offset, n) for the tiles of a field of the given size
+            template<typename Kernel>
+            inline void for_each_tile(int size, Kernel kernel)
+            {
+                const int n_tiles = (size + simd_tile - 1) / simd_tile;
+                #pragma omp parallel for
+                for (int itile = 0; itile < n_tiles; ++itile)
+                {
+                    const int offset = itile * simd_tile;
+                    kernel(offset, std::min(simd_tile, size - offset));
+                }
+            }
+        }
+        #endif
+
         void rotate(const Vector3 & v, const Vector3 & axis, const scalar & angle, Vector3 & v_out)
         {
             v_out = v * std::cos(angle) + axis.cross(v) * std::sin(angle) + 
@@ -29,8 +95,28 @@ namespace Engine
         void rotate( const vectorfield & v, const vectorfield & axis, const scalarfield & angle, 
                      vectorfield & v_out )
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(v_out.size(), [&](int offset, int n)
+            {
+                SoA_Tile tv, ta;
+                tile_load(v, offset, n, tv);
+                tile_load(axis, offset, n, ta);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    scalar c = std::cos(angle[offset+i]), s = std::sin(angle[offset+i]);
+                    scalar ad = (ta.x[i]*tv.x[i] + ta.y[i]*tv.y[i] + ta.z[i]*tv.z[i]) * (1 - c);
+                    scalar x = tv.x[i]*c + (ta.y[i]*tv.z[i] - ta.z[i]*tv.y[i])*s + ta.x[i]*ad;
+                    scalar y = tv.y[i]*c + (ta.z[i]*tv.x[i] - ta.x[i]*tv.z[i])*s + ta.y[i]*ad;
+                    scalar z = tv.z[i]*c + (ta.x[i]*tv.y[i] - ta.y[i]*tv.x[i])*s + ta.z[i]*ad;
+                    tv.x[i] = x; tv.y[i] = y; tv.z[i] = z;
+                }
+                tile_store(tv, offset, n, v_out);
+            });
+            #else
             for( unsigned int i=0; i<v_out.size(); i++)
                 rotate( v[i], axis[i], angle[i], v_out[i] );
+            #endif
         }
         
         Vector3 decompose(const Vector3 & v, const std::vector<Vector3> & basis)
@@ -173,6 +259,27 @@ namespace Engine
         // Utility function for the SIB Solver
         void transform(const vectorfield & spins, const vectorfield & force, vectorfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(spins.size(), [&](int offset, int n)
+            {
+                SoA_Tile s, a;
+                tile_load(spins, offset, n, s);
+                tile_load(force, offset, n, a);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    scalar Ax = 0.5*a.x[i], Ay = 0.5*a.y[i], Az = 0.5*a.z[i];
+                    scalar detAi = 1.0 / (1 + Ax*Ax + Ay*Ay + Az*Az);
+                    scalar a2x = s.x[i] - (s.y[i]*Az - s.z[i]*Ay);
+                    scalar a2y = s.y[i] - (s.z[i]*Ax - s.x[i]*Az);
+                    scalar a2z = s.z[i] - (s.x[i]*Ay - s.y[i]*Ax);
+                    s.x[i] = (a2x * (Ax * Ax + 1 ) + a2y * (Ax * Ay - Az) + a2z * (Ax * Az + Ay)) * detAi;
+                    s.y[i] = (a2x * (Ay * Ax + Az) + a2y * (Ay * Ay + 1 ) + a2z * (Ay * Az - Ax)) * detAi;
+                    s.z[i] = (a2x * (Az * Ax - Ay) + a2y * (Az * Ay + Ax) + a2z * (Az * Az + 1 )) * detAi;
+                }
+                tile_store(s, offset, n, out);
+            });
+            #else
             #pragma omp parallel for
             for (unsigned int i = 0; i < spins.size(); ++i)
             {
@@ -188,6 +295,7 @@ namespace Engine
                 out[i][1] = (a2[0] * (A[1] * A[0] + A[2]) + a2[1] * (A[1] * A[1] + 1   ) + a2[2] * (A[1] * A[2] - A[0])) * detAi;
                 out[i][2] = (a2[0] * (A[2] * A[0] - A[1]) + a2[1] * (A[2] * A[1] + A[0]) + a2[2] * (A[2] * A[2] + 1   )) * detAi;
             }
+            #endif
         }
 
         void get_random_vector(std::uniform_real_distribution<scalar> & distribution, std::mt19937 & prng, Vector3 & vec)
@@ -232,6 +340,39 @@ namespace Engine
             }
         }
 
+        void get_random_vectorfield(Random::Philox & prng, vectorfield & xi)
+        {
+            const std::uint64_t draw = prng.draw++;
+            #pragma omp parallel for
+            for (unsigned int i = 0; i < xi.size(); ++i)
+            {
+                auto r1 = prng.Uniform(draw, 2*std::uint64_t(i));
+                auto r2 = prng.Uniform(draw, 2*std::uint64_t(i)+1);
+                xi[i] = { 2*r1[0]-1, 2*r1[1]-1, 2*r2[0]-1 };
+            }
+        }
+
+        void get_random_vectorfield_unitsphere(Random::Philox & prng, vectorfield & xi)
+        {
+            const std::uint64_t draw = prng.draw++;
+            #pragma omp parallel for
+            for (unsigned int i = 0; i < xi.size(); ++i)
+                get_random_vector_unitsphere(prng, draw, i, xi[i]);
+        }
+
+        void get_random_vector_unitsphere(const Random::Philox & prng, std::uint64_t draw, std::uint64_t index, Vector3 & vec)
+        {
+            auto r = prng.Uniform(draw, index);
+            scalar v_z = 2*r[0]-1;
+            scalar phi = 2*r[1]-1;
+
+            scalar r_xy = std::sqrt(1 - v_z*v_z);
+
+            vec[0] = r_xy * std::cos(2*Pi*phi);
+            vec[1] = r_xy * std::sin(2*Pi*phi);
+            vec[2] = v_z;
+        }
+
         void get_gradient_distribution(const Data::Geometry & geometry, Vector3 gradient_direction, scalar gradient_start, scalar gradient_inclination, scalarfield & distribution, scalar range_min, scalar range_max)
         {
             // Ensure a normalized direction vector
@@ -399,11 +540,7 @@ namespace Engine
 
         scalar sum(const scalarfield & sf)
         {
-            scalar ret = 0;
-            #pragma omp parallel for reduction(+:ret)
-            for (unsigned int i = 0; i<sf.size(); ++i)
-                ret += sf[i];
-            return ret;
+            return block_sum(sf.size(), scalar(0), [&](int i) { return sf[i]; });
         }
 
         scalar mean(const scalarfield & sf)
@@ -434,15 +571,43 @@ namespace Engine
 
         void normalize_vectors(vectorfield & vf)
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(vf.size(), [&](int offset, int n)
+            {
+                SoA_Tile t;
+                tile_load(vf, offset, n, t);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    // Like Eigen, leave zero vectors untouched
+                    scalar n2 = t.x[i]*t.x[i] + t.y[i]*t.y[i] + t.z[i]*t.z[i];
+                    scalar norm = n2 > 0 ? std::sqrt(n2) : 1;
+                    t.x[i] /= norm; t.y[i] /= norm; t.z[i] /= norm;
+                }
+                tile_store(t, offset, n, vf);
+            });
+            #else
             #pragma omp parallel for
             for (unsigned int i=0; i<vf.size(); ++i)
                 vf[i].normalize();
+            #endif
         }
         
         void norm( const vectorfield & vf, scalarfield & norm )
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(vf.size(), [&](int offset, int n)
+            {
+                SoA_Tile t;
+                tile_load(vf, offset, n, t);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                    norm[offset+i] = std::sqrt(t.x[i]*t.x[i] + t.y[i]*t.y[i] + t.z[i]*t.z[i]);
+            });
+            #else
             for (unsigned int i=0; i<vf.size(); ++i)
                 norm[i] = vf[i].norm();
+            #endif
         }
         
         std::pair<scalar, scalar> minmax_component(const vectorfield & v1)
@@ -477,18 +642,22 @@ namespace Engine
 
         void scale(vectorfield & vf, const scalar & sc)
         {
+            #ifdef SPIRIT_USE_SIMD
+            scalar * data = flat_data(vf);
+            const int size = 3*vf.size();
+            #pragma omp parallel for simd
+            for (int i=0; i<size; ++i)
+                data[i] *= sc;
+            #else
             #pragma omp parallel for
             for (unsigned int i=0; i<vf.size(); ++i)
                 vf[i] *= sc;
+            #endif
         }
 
         Vector3 sum(const vectorfield & vf)
         {
-            Vector3 ret = { 0,0,0 };
-            #pragma omp parallel for reduction(+:ret)
-            for (unsigned int i = 0; i<vf.size(); ++i)
-                ret += vf[i];
-            return ret;
+            return block_sum(vf.size(), Vector3{ 0,0,0 }, [&](int i) -> const Vector3 & { return vf[i]; });
         }
 
         Vector3 mean(const vectorfield & vf)
@@ -507,20 +676,44 @@ namespace Engine
         // computes the inner product of two vectorfields v1 and v2
         scalar dot(const vectorfield & v1, const vectorfield & v2)
         {
-            scalar ret = 0;
-            #pragma omp parallel for reduction(+:ret)
-            for (unsigned int i = 0; i<v1.size(); ++i)
-                ret += v1[i].dot(v2[i]);
-            return ret;
+            #ifdef SPIRIT_USE_SIMD
+            // Blocks of tiles, so that the result does not depend on the number of threads
+            const scalar * d1 = flat_data(v1);
+            const scalar * d2 = flat_data(v2);
+            const int size = 3*v1.size();
+            return block_sum((size + 3*simd_tile - 1) / (3*simd_tile), scalar(0), [&](int itile)
+            {
+                scalar ret = 0;
+                const int end = std::min(size, 3*simd_tile*(itile + 1));
+                #pragma omp simd reduction(+:ret)
+                for (int i = 3*simd_tile*itile; i < end; ++i)
+                    ret += d1[i] * d2[i];
+                return ret;
+            });
+            #else
+            return block_sum(v1.size(), scalar(0), [&](int i) { return v1[i].dot(v2[i]); });
+            #endif
         }
 
         // computes the inner products of vectors in vf1 and vf2
         // vf1 and vf2 are vectorfields
         void dot(const vectorfield & vf1, const vectorfield & vf2, scalarfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(vf1.size(), [&](int offset, int n)
+            {
+                SoA_Tile a, b;
+                tile_load(vf1, offset, n, a);
+                tile_load(vf2, offset, n, b);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                    out[offset+i] = a.x[i]*b.x[i] + a.y[i]*b.y[i] + a.z[i]*b.z[i];
+            });
+            #else
             #pragma omp parallel for
             for (unsigned int i=0; i<vf1.size(); ++i)
                 out[i] = vf1[i].dot(vf2[i]);
+            #endif
         }
 
         // computes the product of scalars in s1 and s2
@@ -552,9 +745,18 @@ namespace Engine
         // out[i] += c*a[i]
         void add_c_a(const scalar & c, const vectorfield & vf, vectorfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            const scalar * in = flat_data(vf);
+            scalar * data = flat_data(out);
+            const int size = 3*out.size();
+            #pragma omp parallel for simd
+            for (int i = 0; i < size; ++i)
+                data[i] += c*in[i];
+            #else
             #pragma omp parallel for
             for(unsigned int idx = 0; idx < out.size(); ++idx)
                 out[idx] += c*vf[idx];
+            #endif
         }
         void add_c_a(const scalar & c, const vectorfield & vf, vectorfield & out, const intfield & mask)
         {
@@ -588,9 +790,18 @@ namespace Engine
         // out[i] = c*a[i]
         void set_c_a(const scalar & c, const vectorfield & vf, vectorfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            const scalar * in = flat_data(vf);
+            scalar * data = flat_data(out);
+            const int size = 3*out.size();
+            #pragma omp parallel for simd
+            for (int i = 0; i < size; ++i)
+                data[i] = c*in[i];
+            #else
             #pragma omp parallel for
             for(unsigned int idx = 0; idx < out.size(); ++idx)
                 out[idx] = c*vf[idx];
+            #endif
         }
         // out[i] = c*a[i]
         void set_c_a(const scalar & c, const vectorfield & vf, vectorfield & out, const intfield & mask)
@@ -648,9 +859,27 @@ namespace Engine
         // out[i] += c * a[i] x b[i]
         void add_c_cross(const scalar & c, const vectorfield & a, const vectorfield & b, vectorfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(out.size(), [&](int offset, int n)
+            {
+                SoA_Tile ta, tb, to;
+                tile_load(a, offset, n, ta);
+                tile_load(b, offset, n, tb);
+                tile_load(out, offset, n, to);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    to.x[i] += c*(ta.y[i]*tb.z[i] - ta.z[i]*tb.y[i]);
+                    to.y[i] += c*(ta.z[i]*tb.x[i] - ta.x[i]*tb.z[i]);
+                    to.z[i] += c*(ta.x[i]*tb.y[i] - ta.y[i]*tb.x[i]);
+                }
+                tile_store(to, offset, n, out);
+            });
+            #else
             #pragma omp parallel for
             for(unsigned int idx = 0; idx < out.size(); ++idx)
                 out[idx] += c*a[idx].cross(b[idx]);
+            #endif
         }
         // out[i] += c[i] * a[i] x b[i]
         void add_c_cross(const scalarfield & c, const vectorfield & a, const vectorfield & b, vectorfield & out)
@@ -670,9 +899,27 @@ namespace Engine
         // out[i] = c * a[i] x b[i]
         void set_c_cross(const scalar & c, const vectorfield & a, const vectorfield & b, vectorfield & out)
         {
+            #ifdef SPIRIT_USE_SIMD
+            for_each_tile(out.size(), [&](int offset, int n)
+            {
+                SoA_Tile ta, tb;
+                tile_load(a, offset, n, ta);
+                tile_load(b, offset, n, tb);
+                #pragma omp simd
+                for (int i = 0; i < n; ++i)
+                {
+                    scalar x = c*(ta.y[i]*tb.z[i] - ta.z[i]*tb.y[i]);
+                    scalar y = c*(ta.z[i]*tb.x[i] - ta.x[i]*tb.z[i]);
+                    scalar z = c*(ta.x[i]*tb.y[i] - ta.y[i]*tb.x[i]);
+                    ta.x[i] = x; ta.y[i] = y; ta.z[i] = z;
+                }
+                tile_store(ta, offset, n, out);
+            });
+            #else
             #pragma omp parallel for
             for(unsigned int idx = 0; idx < out.size(); ++idx)
                 out[idx] = c*a[idx].cross(b[idx]);
+            #endif
         }
     }
 }
@@ -483,6 +483,39 @@ namespace Engine
             }
         }
 
+        void get_random_vectorfield(Random::Philox & prng, vectorfield & xi)
+        {
+            const std::uint64_t draw = prng.draw++;
+            // The generator is not available on the device, so these are drawn on the host
+            for (unsigned int i = 0; i < xi.size(); ++i)
+            {
+                auto r1 = prng.Uniform(draw, 2*std::uint64_t(i));
+                auto r2 = prng.Uniform(draw, 2*std::uint64_t(i)+1);
+                xi[i] = { 2*r1[0]-1, 2*r1[1]-1, 2*r2[0]-1 };
+            }
+        }
+
+        void get_random_vectorfield_unitsphere(Random::Philox & prng, vectorfield & xi)
+        {
+            const std::uint64_t draw = prng.draw++;
+            // The generator is not available on the device, so these are drawn on the host
+            for (unsigned int i = 0; i < xi.size(); ++i)
+                get_random_vector_unitsphere(prng, draw, i, xi[i]);
+        }
+
+        void get_random_vector_unitsphere(const Random::Philox & prng, std::uint64_t draw, std::uint64_t index, Vector3 & vec)
+        {
+            auto r = prng.Uniform(draw, index);
+            scalar v_z = 2*r[0]-1;
+            scalar phi = 2*r[1]-1;
+
+            scalar r_xy = std::sqrt(1 - v_z*v_z);
+
+            vec[0] = r_xy * std::cos(2*Pi*phi);
+            vec[1] = r_xy * std::sin(2*Pi*phi);
+            vec[2] = v_z;
+        }
+
         void get_gradient_distribution(const Data::Geometry & geometry, Vector3 gradient_direction, scalar gradient_start, scalar gradient_inclination, scalarfield & distribution, scalar range_min, scalar range_max)
         {
             // Starting value
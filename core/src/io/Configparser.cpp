@@ -606,6 +606,8 @@ namespace IO
         Vector3 stt_polarisation_normal = { 1.0, -1.0, 0.0 };
         // Force convergence parameter
         scalar force_convergence = 10e-9;
+        // Error tolerance of the adaptive RK45 solver
+        scalar rk_tolerance = 1e-5;
 
         //------------------------------- Parser --------------------------------
         Log(Log_Level::Info, Log_Sender::IO, "Parameters LLG: building");
@@ -644,6 +646,7 @@ namespace IO
                 myfile.Read_Single(stt_magnitude, "llg_stt_magnitude");
                 myfile.Read_Vector3(stt_polarisation_normal, "llg_stt_polarisation_normal");
                 myfile.Read_Single(force_convergence, "llg_force_convergence");
+                myfile.Read_Single(rk_tolerance, "llg_rk_tolerance");
             }// end try
             catch (...)
             {
@@ -668,6 +671,7 @@ namespace IO
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "stt magnitude", stt_magnitude));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "stt normal", stt_polarisation_normal.transpose()));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1:e}", "force convergence", force_convergence));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1:e}", "RK45 tolerance", rk_tolerance));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "maximum walltime", str_max_walltime));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations", n_iterations));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations_log", n_iterations_log));
@@ -690,7 +694,7 @@ namespace IO
             { output_any, output_initial, output_final, output_energy_step, output_energy_archive, output_energy_spin_resolved, output_energy_divide_by_nspins, output_configuration_step, output_configuration_archive, output_energy_add_readability_lines},
             output_configuration_filetype, force_convergence, n_iterations, n_iterations_log, max_walltime, pinning, seed,
             temperature, temperature_gradient_direction, temperature_gradient_inclination,
-            damping, beta, dt, renorm_sd, stt_use_gradient, stt_magnitude, stt_polarisation_normal));
+            damping, beta, dt, renorm_sd, stt_use_gradient, stt_magnitude, stt_polarisation_normal, rk_tolerance));
         Log(Log_Level::Info, Log_Sender::IO, "Parameters LLG: built");
         return llg_params;
     }// end Parameters_Method_LLG_from_Config
@@ -727,6 +731,13 @@ namespace IO
         scalar temperature = 0.0;
         // Acceptance ratio
         scalar acceptance_ratio = 0.5;
+        // Cache the local fields for the Metropolis steps
+        bool local_field_cache = false;
+        // Update the spins of each colour of the interaction graph in parallel
+        bool parallel_sweep = false;
+        // Algorithm of the single spin steps
+        std::string algorithm_str = "metropolis";
+        auto algorithm = Data::MC_Algorithm::Metropolis;
 
         //------------------------------- Parser --------------------------------
         Log(Log_Level::Info, Log_Sender::IO, "Parameters MC: building");
@@ -756,6 +767,20 @@ namespace IO
                 myfile.Read_Single(n_iterations_log, "mc_n_iterations_log");
                 myfile.Read_Single(temperature, "mc_temperature");
                 myfile.Read_Single(acceptance_ratio, "mc_acceptance_ratio");
+                myfile.Read_Single(local_field_cache, "mc_local_field_cache");
+                myfile.Read_Single(parallel_sweep, "mc_parallel_sweep");
+                myfile.Read_Single(algorithm_str, "mc_algorithm");
+                if (algorithm_str == "heat_bath")
+                    algorithm = Data::MC_Algorithm::Heat_Bath;
+                else if (algorithm_str == "wolff")
+                    algorithm = Data::MC_Algorithm::Wolff;
+                else if (algorithm_str == "metropolis")
+                    algorithm = Data::MC_Algorithm::Metropolis;
+                else
+                {
+                    Log(Log_Level::Warning, Log_Sender::IO, fmt::format("Parameters MC: Keyword 'mc_algorithm' got passed invalid value \"{}\". Using default: metropolis", algorithm_str));
+                    algorithm_str = "metropolis";
+                }
             }// end try
             catch (...)
             {
@@ -769,6 +794,9 @@ namespace IO
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "seed", seed));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "temperature", temperature));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "acceptance_ratio", acceptance_ratio));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "local_field_cache", local_field_cache));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "parallel_sweep", parallel_sweep));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "algorithm", algorithm_str));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "maximum walltime", str_max_walltime));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations", n_iterations));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations_log", n_iterations_log));
@@ -786,7 +814,7 @@ namespace IO
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<30} = {1}", "output_configuration_filetype", output_configuration_filetype));
         max_walltime = (long int)Utility::Timing::DurationFromString(str_max_walltime).count();
         auto mc_params = std::unique_ptr<Data::Parameters_Method_MC>(new Data::Parameters_Method_MC(output_folder, output_file_tag, { output_any, output_initial, output_final, output_energy_step, output_energy_archive, output_energy_spin_resolved,
-            output_energy_divide_by_nspins, output_configuration_step, output_configuration_archive, output_energy_add_readability_lines }, output_configuration_filetype, n_iterations, n_iterations_log, max_walltime, pinning, seed, temperature, acceptance_ratio));
+            output_energy_divide_by_nspins, output_configuration_step, output_configuration_archive, output_energy_add_readability_lines }, output_configuration_filetype, n_iterations, n_iterations_log, max_walltime, pinning, seed, temperature, acceptance_ratio, local_field_cache, parallel_sweep, algorithm));
         Log(Log_Level::Info, Log_Sender::IO, "Parameters MC: built");
         return mc_params;
     }
@@ -820,6 +848,8 @@ namespace IO
         int n_iterations_log = 100;
         // Number of Energy Interpolation points
         int n_E_interpolations = 10;
+        // Evaluate the images in parallel
+        bool parallel_images = false;
         //------------------------------- Parser --------------------------------
         Log(Log_Level::Info, Log_Sender::IO, "Parameters GNEB: building");
         if (configFile != "")
@@ -845,6 +875,7 @@ namespace IO
                 myfile.Read_Single(n_iterations, "gneb_n_iterations");
                 myfile.Read_Single(n_iterations_log, "gneb_n_iterations_log");
                 myfile.Read_Single(n_E_interpolations, "gneb_n_energy_interpolations");
+                myfile.Read_Single(parallel_images, "gneb_parallel_images");
             }// end try
             catch (...)
             {
@@ -857,6 +888,7 @@ namespace IO
         Log(Log_Level::Parameter, Log_Sender::IO, "Parameters GNEB:");
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1}", "spring_constant", spring_constant));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1}", "n_E_interpolations", n_E_interpolations));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1}", "parallel_images", parallel_images));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1:e}", "force convergence", force_convergence));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1}", "maximum walltime", str_max_walltime));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<18} = {1}", "n_iterations", n_iterations));
@@ -873,6 +905,7 @@ namespace IO
         max_walltime = (long int)Utility::Timing::DurationFromString(str_max_walltime).count();
         auto gneb_params = std::unique_ptr<Data::Parameters_Method_GNEB>(new Data::Parameters_Method_GNEB(output_folder, output_file_tag, { output_any, output_initial, output_final, output_energies_step, output_energies_interpolated, output_energies_divide_by_nspins, output_chain_step, output_energies_add_readability_lines},
             output_chain_filetype, force_convergence, n_iterations, n_iterations_log, max_walltime, pinning, spring_constant, n_E_interpolations));
+        gneb_params->parallel_images = parallel_images;
         Log(Log_Level::Info, Log_Sender::IO, "Parameters GNEB: built");
         return gneb_params;
     }// end Parameters_Method_LLG_from_Config
@@ -901,6 +934,8 @@ namespace IO
         int n_iterations = (int)2E+6;
         // Number of iterations after which the system is logged to file
         int n_iterations_log = 100;
+        // Evaluate the chains in parallel
+        bool parallel_images = false;
         
         //------------------------------- Parser --------------------------------
         Log(Log_Level::Info, Log_Sender::IO, "Parameters MMF: building");
@@ -924,6 +959,7 @@ namespace IO
                 myfile.Read_Single(force_convergence, "mmf_force_convergence");
                 myfile.Read_Single(n_iterations, "mmf_n_iterations");
                 myfile.Read_Single(n_iterations_log, "mmf_n_iterations_log");
+                myfile.Read_Single(parallel_images, "mmf_parallel_images");
             }// end try
             catch (...)
             {
@@ -938,6 +974,7 @@ namespace IO
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "maximum walltime", str_max_walltime));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations", n_iterations));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "n_iterations_log", n_iterations_log));
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "parallel_images", parallel_images));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "output_folder", output_folder));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "output_any", output_any));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<17} = {1}", "output_initial", output_initial));
@@ -950,6 +987,7 @@ namespace IO
         max_walltime = (long int)Utility::Timing::DurationFromString(str_max_walltime).count();
         auto mmf_params = std::unique_ptr<Data::Parameters_Method_MMF>(new Data::Parameters_Method_MMF(output_folder, output_file_tag, {output_any, output_initial, output_final, output_energy_step, output_energy_archive, output_energy_divide_by_nspins, output_configuration_step,output_configuration_archive },
             force_convergence, n_iterations, n_iterations_log, max_walltime, pinning));
+        mmf_params->parallel_images = parallel_images;
         Log(Log_Level::Info, Log_Sender::IO, "Parameters MMF: built");
         return mmf_params;
     }
@@ -1045,6 +1083,8 @@ namespace IO
         int n_shells_dmi = dmi_magnitudes.size();
         int dm_chirality = 1;
         
+        std::string ddi_method_str = "cutoff";
+        auto ddi_method = Engine::DDI_Method::Cutoff;
         scalar ddi_radius = 0.0;
 
         // ------------ Quadruplet Interactions ------------
@@ -1053,6 +1093,9 @@ namespace IO
         bool quadruplets_from_file = false;
         quadrupletfield quadruplets(0); scalarfield quadruplet_magnitudes(0);
 
+        // Interaction cache (disabled by default)
+        std::string interaction_cache_file = "";
+
         //------------------------------- Parser --------------------------------
         Log(Log_Level::Info, Log_Sender::IO, "Hamiltonian_Heisenberg: building");
         // iteration variables
@@ -1259,7 +1302,14 @@ namespace IO
                 IO::Filter_File_Handle myfile(configFile);
 
                 //		Dipole-Dipole Pairs
-                // Dipole Dipole radius
+                // Dipole Dipole method and radius
+                myfile.Read_Single(ddi_method_str, "ddi_method");
+                if (ddi_method_str == "fft")
+                    ddi_method = Engine::DDI_Method::FFT;
+                else if (ddi_method_str == "cutoff")
+                    ddi_method = Engine::DDI_Method::Cutoff;
+                else
+                    Log(Log_Level::Warning, Log_Sender::IO, fmt::format("Hamiltonian_Heisenberg: Keyword 'ddi_method' got passed invalid value \"{}\". Using default: cutoff", ddi_method_str));
                 myfile.Read_Single(ddi_radius, "dd_radius");
             }// end try
             catch( ... )
@@ -1289,6 +1339,18 @@ namespace IO
             {
                 spirit_handle_exception_core(fmt::format("Unable to read interaction quadruplets from config file  \"{}\"", configFile));
             }
+
+            try
+            {
+                IO::Filter_File_Handle myfile(configFile);
+
+                // Optional cache of the interaction tables
+                myfile.Read_Single(interaction_cache_file, "interaction_cache_file", false);
+            }// end try
+            catch( ... )
+            {
+                spirit_handle_exception_core(fmt::format("Unable to read interaction cache file from config file  \"{}\"", configFile));
+            }
         }
         else Log(Log_Level::Warning, Log_Sender::IO, "Hamiltonian_Heisenberg: Using default configuration!");
         
@@ -1313,7 +1375,10 @@ namespace IO
             Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<19} = {1}", "DM chirality", dm_chirality));
         }
 
+        Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<19} = {1}", "ddi_method", ddi_method_str));
         Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<19} = {1}", "dd_radius", ddi_radius));
+        if (interaction_cache_file != "")
+            Log(Log_Level::Parameter, Log_Sender::IO, fmt::format("        {0:<19} = \"{1}\"", "interaction cache", interaction_cache_file));
 
         std::unique_ptr<Engine::Hamiltonian_Heisenberg> hamiltonian;
 
@@ -1325,10 +1390,11 @@ namespace IO
                 anisotropy_index, anisotropy_magnitude, anisotropy_normal,
                 exchange_magnitudes,
                 dmi_magnitudes, dm_chirality,
-                ddi_radius,
+                ddi_method, ddi_radius,
                 quadruplets, quadruplet_magnitudes,
                 geometry,
-                boundary_conditions
+                boundary_conditions,
+                interaction_cache_file
             ));
         }
         else
@@ -1339,10 +1405,11 @@ namespace IO
                 anisotropy_index, anisotropy_magnitude, anisotropy_normal,
                 exchange_pairs, exchange_magnitudes,
                 dmi_pairs, dmi_magnitudes, dmi_normals,
-                ddi_radius,
+                ddi_method, ddi_radius,
                 quadruplets, quadruplet_magnitudes,
                 geometry,
-                boundary_conditions
+                boundary_conditions,
+                interaction_cache_file
             ));
         }
         Log(Log_Level::Info, Log_Sender::IO, "Hamiltonian_Heisenberg: built");
@@ -114,6 +114,7 @@ namespace IO
         config += fmt::format("{:<35} {}\n",   "llg_dt",                              parameters->dt/std::pow(10, -12) * Constants::mu_B/1.760859644/std::pow(10, 11));
         config += fmt::format("{:<35} {}\n",   "llg_stt_magnitude",                   parameters->stt_magnitude);
         config += fmt::format("{:<35} {}\n",   "llg_stt_polarisation_normal",         parameters->stt_polarisation_normal.transpose());
+        config += fmt::format("{:<35} {:e}\n", "llg_rk_tolerance",                    parameters->rk_tolerance);
         config += "############### End LLG Parameters ###############";
         Append_String_to_File(config, configFile);
     }// end Parameters_Method_LLG_to_Config
@@ -136,6 +137,14 @@ namespace IO
         config += fmt::format("{:<35} {}\n",   "mc_seed",                            parameters->rng_seed);
         config += fmt::format("{:<35} {}\n",   "mc_temperature",                     parameters->temperature);
         config += fmt::format("{:<35} {}\n",   "mc_acceptance_ratio",                parameters->acceptance_ratio_target);
+        config += fmt::format("{:<35} {:d}\n", "mc_local_field_cache",               parameters->local_field_cache);
+        config += fmt::format("{:<35} {:d}\n", "mc_parallel_sweep",                  parameters->parallel_sweep);
+        std::string algorithm = "metropolis";
+        if (parameters->algorithm == Data::MC_Algorithm::Heat_Bath)
+            algorithm = "heat_bath";
+        else if (parameters->algorithm == Data::MC_Algorithm::Wolff)
+            algorithm = "wolff";
+        config += fmt::format("{:<35} {}\n",   "mc_algorithm",                       algorithm);
         config += "############### End MC Parameters ################";
         Append_String_to_File(config, configFile);
     }// end Parameters_Method_MC_to_Config
@@ -156,6 +165,7 @@ namespace IO
         config += fmt::format("{:<38} {}\n",   "gneb_n_iterations_log",                 parameters->n_iterations_log);
         config += fmt::format("{:<38} {}\n",   "gneb_spring_constant",                  parameters->spring_constant);
         config += fmt::format("{:<38} {}\n",   "gneb_n_energy_interpolations",          parameters->n_E_interpolations);
+        config += fmt::format("{:<38} {:d}\n", "gneb_parallel_images",                  parameters->parallel_images);
         config += "############### End GNEB Parameters ##############";
         Append_String_to_File(config, configFile);
     }// end Parameters_Method_GNEB_to_Config
@@ -175,6 +185,7 @@ namespace IO
         config += fmt::format("{:<38} {:e}\n", "mmf_force_convergence",              parameters->force_convergence);
         config += fmt::format("{:<38} {}\n",   "mmf_n_iterations",                   parameters->n_iterations);
         config += fmt::format("{:<38} {}\n",   "mmf_n_iterations_log",               parameters->n_iterations_log);
+        config += fmt::format("{:<38} {:d}\n", "mmf_parallel_images",                parameters->parallel_images);
         config += "############### End MMF Parameters ###############";
         Append_String_to_File(config, configFile);
     }// end Parameters_Method_MMF_to_Config
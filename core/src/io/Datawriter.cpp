@@ -233,6 +233,36 @@ namespace IO
         Append_String_to_File(data, filename);
     }
 
+    void Write_MC_Observables( const Data::Spin_System & system, const std::string filename )
+    {
+        auto& observables = system.mc_observables;
+        scalar temperature = system.mc_parameters->temperature;
+
+        std::string separator = "----------------------++----------------------+----------------------+----------------------\n";
+        std::string data = fmt::format("# Thermal averages of {} MC samples at T = {} K\n", observables.N(), temperature);
+        data += separator;
+        data += fmt::format(" {:^20} || {:^20} | {:^20} | {:^20} \n", "observable", "mean", "error", "tau_int");
+        data += separator;
+        auto line = [&data]( std::string name, const Utility::Blocking_Statistics & statistics )
+        {
+            data += fmt::format(" {:^20} || {:^20.10f} | {:^20.10f} | {:^20.10f} \n", name,
+                statistics.Mean(), statistics.Error(), statistics.Autocorrelation_Time());
+        };
+        line("E_tot", observables.energy);
+        line("m_x", observables.magnetization[0]);
+        line("m_y", observables.magnetization[1]);
+        line("m_z", observables.magnetization[2]);
+        line("|m|", observables.magnetization_abs);
+        line("m^2", observables.magnetization_2);
+        line("m^4", observables.magnetization_4);
+        data += separator;
+        data += fmt::format(" {:^20} || {:^20.10f} \n", "C/N (kB)", observables.Specific_Heat(temperature, system.nos));
+        data += fmt::format(" {:^20} || {:^20.10f} \n", "chi/N (1/meV)", observables.Susceptibility(temperature, system.nos));
+        data += fmt::format(" {:^20} || {:^20.10f} \n", "U_4", observables.Binder_Cumulant());
+
+        String_to_File(data, filename);
+    }
+
     void Write_System_Force(const Data::Spin_System & s, const std::string filename)
     {
     }
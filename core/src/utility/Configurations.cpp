@@ -130,13 +130,10 @@ namespace Utility
 
 			scalar epsilon = std::sqrt(temperature*Constants::k_B);
 			
-			std::mt19937 * prng;
-			if (delta_seed!=0) prng = new std::mt19937(123456789+delta_seed);
-			else prng = &s.llg_parameters->prng;
+			Engine::Random::Philox prng_delta(123456789+delta_seed);
+			auto& prng = (delta_seed!=0) ? prng_delta : s.llg_parameters->philox;
 
-			auto distribution = std::uniform_real_distribution<scalar>(-1, 1);
-
-			Engine::Vectormath::get_random_vectorfield_unitsphere(*prng, xi);
+			Engine::Vectormath::get_random_vectorfield_unitsphere(prng, xi);
 			Engine::Vectormath::scale(xi, epsilon);
 			Engine::Vectormath::add_c_a(1, xi, *s.spins, mask);
 			Engine::Vectormath::normalize_vectors(*s.spins);
@@ -0,0 +1,140 @@
+#include <utility/Statistics.hpp>
+#include <utility/Constants.hpp>
+
+#include <cmath>
+
+namespace Utility
+{
+    Blocking_Statistics::Blocking_Statistics()
+    {
+        this->Reset();
+    }
+
+    void Blocking_Statistics::Add(scalar x)
+    {
+        // The sample is added to the lowest level, and each completed pair of blocks passes its mean on to the next level
+        for (unsigned int k = 0; ; ++k)
+        {
+            if (k == this->levels.size())
+                this->levels.push_back(Level{0, 0, 0, false, 0});
+            auto& level = this->levels[k];
+
+            // Welford's update of the mean and of the sum of squared deviations
+            ++level.n;
+            scalar delta = x - level.mean;
+            level.mean += delta / level.n;
+            level.sum_squared_deviations += delta * (x - level.mean);
+
+            if (!level.has_pending)
+            {
+                level.pending = x;
+                level.has_pending = true;
+                return;
+            }
+            x = 0.5 * (level.pending + x);
+            level.has_pending = false;
+        }
+    }
+
+    void Blocking_Statistics::Reset()
+    {
+        this->levels = std::vector<Level>(0);
+    }
+
+    long int Blocking_Statistics::N() const
+    {
+        if (this->levels.empty()) return 0;
+        return this->levels[0].n;
+    }
+
+    scalar Blocking_Statistics::Mean() const
+    {
+        if (this->levels.empty()) return 0;
+        return this->levels[0].mean;
+    }
+
+    scalar Blocking_Statistics::Variance() const
+    {
+        if (this->N() == 0) return 0;
+        return this->levels[0].sum_squared_deviations / this->levels[0].n;
+    }
+
+    scalar Blocking_Statistics::Variance_of_Mean(int level) const
+    {
+        auto& l = this->levels[level];
+        if (l.n < 2) return 0;
+        return l.sum_squared_deviations / (l.n - 1) / l.n;
+    }
+
+    int Blocking_Statistics::Plateau_Level() const
+    {
+        // The blocks of the highest levels are longer than the correlations, but too few of them are
+        // not enough for an estimate of their variance
+        int level = 0;
+        while (level + 1 < (int)this->levels.size() && this->levels[level+1].n >= 32)
+            ++level;
+        return level;
+    }
+
+    scalar Blocking_Statistics::Autocorrelation_Time() const
+    {
+        if (this->N() < 2) return 0;
+        scalar variance_uncorrelated = this->Variance_of_Mean(0);
+        if (variance_uncorrelated <= 0) return 0.5;
+        return 0.5 * this->Variance_of_Mean(this->Plateau_Level()) / variance_uncorrelated;
+    }
+
+    scalar Blocking_Statistics::Error() const
+    {
+        if (this->N() < 2) return 0;
+        return std::sqrt(this->Variance_of_Mean(this->Plateau_Level()));
+    }
+
+
+    void MC_Observables::Add(scalar energy, const Vector3 & magnetization)
+    {
+        scalar m_2 = magnetization.squaredNorm();
+        this->energy.Add(energy);
+        for (int dim = 0; dim < 3; ++dim)
+            this->magnetization[dim].Add(magnetization[dim]);
+        this->magnetization_abs.Add(std::sqrt(m_2));
+        this->magnetization_2.Add(m_2);
+        this->magnetization_4.Add(m_2 * m_2);
+    }
+
+    void MC_Observables::Reset()
+    {
+        this->energy.Reset();
+        for (int dim = 0; dim < 3; ++dim)
+            this->magnetization[dim].Reset();
+        this->magnetization_abs.Reset();
+        this->magnetization_2.Reset();
+        this->magnetization_4.Reset();
+    }
+
+    long int MC_Observables::N() const
+    {
+        return this->energy.N();
+    }
+
+    scalar MC_Observables::Specific_Heat(scalar temperature, int nos) const
+    {
+        if (temperature <= 0 || nos < 1) return 0;
+        scalar kB_T = Constants::k_B * temperature;
+        return this->energy.Variance() / (nos * kB_T * kB_T);
+    }
+
+    scalar MC_Observables::Susceptibility(scalar temperature, int nos) const
+    {
+        // <m^2>-<|m|>^2 is the variance of |m|, which is accumulated without cancellation
+        if (temperature <= 0) return 0;
+        return nos * this->magnetization_abs.Variance() / (Constants::k_B * temperature);
+    }
+
+    scalar MC_Observables::Binder_Cumulant() const
+    {
+        scalar m_2 = this->magnetization_2.Mean();
+        if (m_2 <= 0) return 0;
+        return 1 - this->magnetization_4.Mean() / (3 * m_2 * m_2);
+    }
+}
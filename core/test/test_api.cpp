@@ -5,6 +5,8 @@
 #include <Spirit/System.h>
 #include <Spirit/Configurations.h>
 #include <Spirit/Quantities.h>
+#include <Spirit/Hamiltonian.h>
+#include <Spirit/Parameters.h>
 #include <Spirit/Simulation.h>
 #include <utility/Exception.hpp>
 
@@ -172,4 +174,86 @@ TEST_CASE( "Quantities", "[quantities]" )
 			REQUIRE(charge == Approx(1));
 		}
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Observables", "[observables]" )
+{
+	auto state = std::shared_ptr<State>(State_Setup(inputfile), State_Delete);
+
+	SECTION("Energy")
+	{
+		// The energy is calculated on demand, so it has to follow the changes of the spins and the Hamiltonian
+		float normal[3] = { 0,0,1 };
+		Hamiltonian_Set_Field(state.get(), 5, normal);
+
+		Configuration_PlusZ(state.get());
+		float E_plus = System_Get_Energy(state.get());
+		Configuration_MinusZ(state.get());
+		float E_minus = System_Get_Energy(state.get());
+		REQUIRE(E_minus > E_plus);
+
+		// The same holds for the energies of the chain
+		Configuration_PlusZ(state.get());
+		float E_chain[1];
+		Chain_Get_Energy(state.get(), E_chain);
+		REQUIRE(E_chain[0] == Approx(E_plus));
+		Configuration_MinusZ(state.get());
+
+		normal[2] = -1;
+		Hamiltonian_Set_Field(state.get(), 5, normal);
+		REQUIRE(System_Get_Energy(state.get()) == Approx(E_plus));
+
+		// After an iteration the energy has to agree with a recalculation
+		Configuration_Random(state.get());
+		Simulation_PlayPause(state.get(), "LLG", "SIB", 10);
+		float E = System_Get_Energy(state.get());
+		System_Update_Data(state.get());
+		REQUIRE(System_Get_Energy(state.get()) == E);
+
+		// The same holds if the energy is calculated together with the gradient
+		Parameters_Set_LLG_Energy_From_Gradient(state.get(), true);
+		REQUIRE(Parameters_Get_LLG_Energy_From_Gradient(state.get()));
+		Configuration_Random(state.get());
+		Simulation_PlayPause(state.get(), "LLG", "SIB", 10);
+		E = System_Get_Energy(state.get());
+		System_Update_Data(state.get());
+		REQUIRE(System_Get_Energy(state.get()) == Approx(E));
+
+		// The re-used gradient does not change the trajectory
+		Configuration_Random(state.get());
+		int nos = System_Get_NOS(state.get());
+		scalar * spins = System_Get_Spin_Directions(state.get());
+		std::vector<scalar> spins_initial(spins, spins + 3*nos);
+		std::vector<std::vector<scalar>> spins_final;
+		for (bool energy_from_gradient : { false, true })
+		{
+			std::copy(spins_initial.begin(), spins_initial.end(), spins);
+			System_Update_Data(state.get());
+			Parameters_Set_LLG_Energy_From_Gradient(state.get(), energy_from_gradient);
+			Simulation_PlayPause(state.get(), "LLG", "SIB", 10);
+			spins_final.push_back(std::vector<scalar>(spins, spins + 3*nos));
+		}
+		for (int i = 0; i < 3*nos; ++i)
+			REQUIRE(spins_final[0][i] == Approx(spins_final[1][i]));
+
+		// The energy sampled by the MC is the sum of the accepted energy differences, which
+		// has to agree with a recalculation for each kind of sweep
+		Parameters_Set_MC_Temperature(state.get(), 10);
+		Parameters_Set_MC_N_Iterations(state.get(), 50, 50);
+		for (int algorithm : { MC_Algorithm_Metropolis, MC_Algorithm_Heat_Bath, MC_Algorithm_Wolff })
+		{
+			for (bool local_field_cache : { false, true })
+			{
+				Parameters_Set_MC_Algorithm(state.get(), algorithm);
+				Parameters_Set_MC_Local_Field_Cache(state.get(), local_field_cache);
+				Parameters_Set_MC_Parallel_Sweep(state.get(), algorithm == MC_Algorithm_Heat_Bath && local_field_cache);
+				Configuration_Random(state.get());
+				Simulation_PlayPause(state.get(), "MC", "");
+				E = System_Get_Energy(state.get());
+				System_Update_Data(state.get());
+				INFO("Algorithm " << algorithm << ", local field cache " << local_field_cache);
+				REQUIRE(System_Get_Energy(state.get()) == Approx(E));
+			}
+		}
+	}
+}
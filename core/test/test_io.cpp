@@ -4,6 +4,10 @@
 #include <Spirit/Configurations.h>
 #include <Spirit/System.h>
 #include <Spirit/Chain.h>
+#include <data/State.hpp>
+#include <engine/Hamiltonian_Heisenberg.hpp>
+#include <cstdio>
+#include <fstream>
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -327,3 +331,67 @@ TEST_CASE( "IO-INTERACTION-PAIRS", "[io-interactions-pairs]" )
     IO_Image_Write_Neighbours_Exchange( state.get(), "core/test/io_test_files/neighbours_J.dat" );
     IO_Image_Write_Neighbours_DMI( state.get(), "core/test/io_test_files/neighbours_DMI.dat" );
 }
+
+TEST_CASE( "IO-INTERACTION-CACHE", "[io-interaction-cache]" )
+{
+    const char cache_file[] = "core/test/io_test_files/interactions.bin";
+
+    // Pairs with a dipole-dipole cutoff, the FFT dipole-dipole interaction and neighbour shells
+    for( auto input : { inputfile, "core/test/input/fd_ddi_fft.cfg", "core/test/input/fd_neighbours.cfg" } )
+    {
+        INFO( " Testing " << input );
+        std::remove( cache_file );
+
+        auto state = std::shared_ptr<State>( State_Setup( input ), State_Delete );
+        Configuration_Random( state.get() );
+        auto& spins = *state->active_image->spins;
+        auto& hamiltonian = *std::dynamic_pointer_cast<Engine::Hamiltonian_Heisenberg>( state->active_image->hamiltonian );
+        if( hamiltonian.ddi_method == Engine::DDI_Method::Cutoff )
+            hamiltonian.ddi_cutoff_radius = 2.5;
+        hamiltonian.Update_Interactions();
+
+        auto gradient_ref = vectorfield( state->nos );
+        hamiltonian.Gradient( spins, gradient_ref );
+        scalar energy_ref = hamiltonian.Energy( spins );
+
+        // The first Hamiltonian writes the cache, the second one reads it
+        for( int pass = 0; pass < 2; ++pass )
+        {
+            Engine::Hamiltonian_Heisenberg cached( hamiltonian );
+            cached.interaction_cache_file = cache_file;
+            cached.Update_Interactions();
+            REQUIRE( std::ifstream( cache_file ).good() );
+
+            REQUIRE( cached.exchange_partners == hamiltonian.exchange_partners );
+            REQUIRE( cached.dmi_partners == hamiltonian.dmi_partners );
+            REQUIRE( cached.ddi_partners == hamiltonian.ddi_partners );
+            REQUIRE( cached.Energy( spins ) == energy_ref );
+            auto gradient = vectorfield( state->nos );
+            cached.Gradient( spins, gradient );
+            REQUIRE( gradient == gradient_ref );
+        }
+
+        // Changed parameters do not match the cache
+        Engine::Hamiltonian_Heisenberg changed( hamiltonian );
+        changed.mu_s[0] *= 2;
+        changed.Update_Interactions();
+        Engine::Hamiltonian_Heisenberg changed_cached( hamiltonian );
+        changed_cached.mu_s[0] *= 2;
+        changed_cached.interaction_cache_file = cache_file;
+        changed_cached.Update_Interactions();
+        REQUIRE( changed_cached.Energy( spins ) == changed.Energy( spins ) );
+
+        // A truncated cache is rebuilt
+        {
+            std::ifstream file( cache_file, std::ios::binary );
+            std::string content( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+            file.close();
+            std::ofstream( cache_file, std::ios::binary ) << content.substr( 0, content.size() / 2 );
+        }
+        Engine::Hamiltonian_Heisenberg truncated( changed );
+        truncated.interaction_cache_file = cache_file;
+        truncated.Update_Interactions();
+        REQUIRE( truncated.Energy( spins ) == changed.Energy( spins ) );
+    }
+    std::remove( cache_file );
+}
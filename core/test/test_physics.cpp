@@ -6,14 +6,34 @@
 #include <Spirit/Hamiltonian.h>
 #include <Spirit/Constants.h>
 #include <Spirit/Parameters.h>
+#include <Spirit/Chain.h>
+#include <Spirit/Quantities.h>
 #include <data/State.hpp>
+#include <engine/Hamiltonian_Heisenberg.hpp>
+#include <engine/Method_LLG.hpp>
+#include <engine/Neighbours.hpp>
+#include <engine/Random.hpp>
+#include <utility/Constants.hpp>
+#include <utility/Statistics.hpp>
 #include <Eigen/Dense>
 #include <Eigen/Core>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <random>
 
 
+// Pairs with anisotropy and a dipole-dipole cutoff
+std::shared_ptr<State> Setup_Pairs_State()
+{
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/fd_pairs.cfg" ), State_Delete );
+    float normal[3] = { 0, 0.6, 0.8 };
+    Hamiltonian_Set_Anisotropy( state.get(), 0.5, normal );
+    Hamiltonian_Set_DDI( state.get(), 2.5 );
+    return state;
+}
+
 TEST_CASE( "Larmor Precession","[physics]" )
 {
     // Input file
@@ -26,7 +46,7 @@ TEST_CASE( "Larmor Precession","[physics]" )
     auto method = "LLG";
 
     // Solvers to be tested
-    std::vector<const char *>  solvers{ "Heun", "Depondt", "SIB" };
+    std::vector<const char *>  solvers{ "Heun", "Depondt", "SIB", "RK45" };
 
     // Set up one the initial direction of the spin
     float init_direction[3] = { 1., 0., 0. };                // vec parallel to x-axis
@@ -81,6 +101,64 @@ TEST_CASE( "Larmor Precession","[physics]" )
     }
 }
 
+TEST_CASE( "Larmor Precession with adaptive step size", "[physics]" )
+{
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/physics_larmor.cfg" ), State_Delete );
+
+    float mu_s;
+    Hamiltonian_Get_mu_s( state.get(), &mu_s );
+    float B_mag;
+    float normal[3];
+    Hamiltonian_Get_Field( state.get(), &B_mag, normal );
+
+    scalar damping = 0.3;
+    Parameters_Set_LLG_Damping( state.get(), damping );
+    Parameters_Set_LLG_RK_Tolerance( state.get(), 1e-7 );
+
+    // The initial step size is far below (the step is accepted and grows) and
+    // far above (the step is rejected and shrinks) the one of the tolerance
+    int n_iterations = 20;
+    std::vector<float> time_steps{ 0.001, 2 };
+
+    float init_direction[3] = { 1., 0., 0. };
+    auto direction = System_Get_Spin_Directions( state.get() );
+
+    for( auto tstep : time_steps )
+    {
+        INFO( "Initial time step " << tstep );
+
+        Configuration_Domain( state.get(), init_direction );
+        Parameters_Set_LLG_Time_Step( state.get(), tstep );
+        Parameters_Set_LLG_N_Iterations( state.get(), n_iterations, n_iterations );
+
+        state->active_image->iteration_allowed = true;
+        Engine::Method_LLG<Engine::Solver::RK45> method( state->active_image, 0, 0 );
+        method.Iterate();
+        REQUIRE( method.getNIterations() == n_iterations );
+
+        // The time passed is the sum of the accepted step sizes
+        scalar time = method.getTime();
+        if( tstep < 1 )
+            REQUIRE( time > 10 * n_iterations * tstep );
+        else
+            REQUIRE( time < n_iterations * tstep );
+
+        // Expected spin orientation after the time passed
+        // TODO: the step size should not be scaled by mu_s
+        scalar dtg = time * Constants_gamma() / ( 1.0 + damping*damping );
+        scalar phi_expected = mu_s * dtg * B_mag;
+        scalar sz_expected  = std::tanh( mu_s * damping * dtg * B_mag );
+        scalar rxy_expected = std::sqrt( 1-sz_expected*sz_expected );
+        scalar sx_expected  = std::cos(phi_expected) * rxy_expected;
+        scalar sy_expected  = std::sin(phi_expected) * rxy_expected;
+
+        INFO( "time " << time << ", phi " << phi_expected );
+        REQUIRE( std::abs( direction[0] - sx_expected ) < 1e-5 );
+        REQUIRE( std::abs( direction[1] - sy_expected ) < 1e-5 );
+        REQUIRE( std::abs( direction[2] - sz_expected ) < 1e-5 );
+    }
+}
+
 TEST_CASE( "Finite Differences", "[physics]" )
 {
     // Hamiltonians to be tested
@@ -115,3 +193,643 @@ TEST_CASE( "Finite Differences", "[physics]" )
         REQUIRE( hessian_fd.isApprox( hessian ) );
     }
 }
+
+TEST_CASE( "Finite Difference Gradient", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, neighbour shells, quadruplets and gaussians
+    auto state_pairs = Setup_Pairs_State();
+    auto state_neighbours = std::shared_ptr<State>( State_Setup( "core/test/input/fd_neighbours.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+    auto state_gaussian = std::shared_ptr<State>( State_Setup( "core/test/input/fd_gaussian.cfg" ), State_Delete );
+
+    for( auto state : { state_pairs, state_neighbours, state_quadruplets, state_gaussian } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        INFO( " Testing " << hamiltonian->Name() );
+
+        // The local differences of the single spin energies have to agree with the gradient.
+        // The narrow gaussians vary quickly, so the truncation error of the differences is larger.
+        scalar precision = hamiltonian->Name() == "Gaussian" ? 1e-4 : 1e-6;
+        auto grad = vectorfield( state->nos );
+        auto grad_fd = vectorfield( state->nos );
+        hamiltonian->Gradient_FD( vf, grad_fd );
+        hamiltonian->Gradient( vf, grad );
+        for( int i=0; i<state->nos; i++)
+            REQUIRE( grad_fd[i].isApprox( grad[i], precision ) );
+    }
+}
+
+TEST_CASE( "Neighbours", "[physics]" )
+{
+    // A sheared lattice with a basis, so that the pairs within a radius reach far along the bravais vectors
+    Data::Geometry geometry( { {1, 0, 0}, {0.7, 0.5, 0}, {0.2, 0.1, 0.9} }, { 6, 7, 5 },
+        { {0, 0, 0}, {0.3, 0.4, 0.1}, {0.6, 0.2, 0.5} }, { 0, 0, 0 }, 1 );
+    const scalar radius = 2.7;
+
+    // Brute force search over all translations within the lattice
+    int n_pairs = 0;
+    for( int iatom = 0; iatom < geometry.n_cell_atoms; ++iatom )
+        for( int i = -geometry.n_cells[0]; i <= geometry.n_cells[0]; ++i )
+            for( int j = -geometry.n_cells[1]; j <= geometry.n_cells[1]; ++j )
+                for( int k = -geometry.n_cells[2]; k <= geometry.n_cells[2]; ++k )
+                    for( int jatom = 0; jatom < geometry.n_cell_atoms; ++jatom )
+                    {
+                        Vector3 x1 = geometry.cell_atoms[jatom] + i*geometry.bravais_vectors[0] + j*geometry.bravais_vectors[1] + k*geometry.bravais_vectors[2];
+                        if( (geometry.cell_atoms[iatom] - x1).norm() < radius )
+                            ++n_pairs;
+                    }
+
+    auto pairs = Engine::Neighbours::Get_Pairs_in_Radius( geometry, radius );
+    REQUIRE( (int)pairs.size() == n_pairs );
+    for( auto& pair : pairs )
+    {
+        scalar magnitude;
+        Vector3 normal;
+        Engine::Neighbours::DDI_from_Pair( geometry, { pair.i, pair.j, pair.translations }, magnitude, normal );
+        REQUIRE( magnitude < radius );
+    }
+
+    // The first shells of the redundant neighbours have to be symmetric
+    pairfield neighbours;
+    intfield shells;
+    auto shell_radius = Engine::Neighbours::Get_Shell_Radius( geometry, 4 );
+    Engine::Neighbours::Get_Neighbours_in_Shells( geometry, 4, neighbours, shells, true );
+    for( int ishell = 1; ishell < 4; ++ishell )
+        REQUIRE( shell_radius[ishell] > shell_radius[ishell-1] );
+    for( auto& pair : neighbours )
+    {
+        auto& t = pair.translations;
+        auto inverse = std::find_if( neighbours.begin(), neighbours.end(), [&]( const Pair & p )
+            { return p.i == pair.j && p.j == pair.i && p.translations[0] == -t[0] && p.translations[1] == -t[1] && p.translations[2] == -t[2]; } );
+        REQUIRE( inverse != neighbours.end() );
+    }
+}
+
+TEST_CASE( "Dipole-Dipole FFT", "[physics]" )
+{
+    // Mixed periodic and open boundaries with lattice sizes which are not powers of two, and
+    // two basis atoms with even periodic sizes, where the offset of half the lattice has two images
+    auto state_odd = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_basis = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft_basis.cfg" ), State_Delete );
+
+    for( auto state : { state_odd, state_basis } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        // The gradient has to be consistent with the energy
+        auto grad = vectorfield( state->nos );
+        auto grad_fd = vectorfield( state->nos );
+        hamiltonian->Gradient_FD( vf, grad_fd );
+        hamiltonian->Gradient( vf, grad );
+        for( int i=0; i<state->nos; i++)
+            REQUIRE( grad_fd[i].isApprox( grad[i], 1e-8 ) );
+
+        // The convolution has to agree with the direct summation in the single spin energies
+        scalar E = hamiltonian->Energy( vf );
+        scalar E_single_spins = 0;
+        for( int i=0; i<state->nos; i++)
+            E_single_spins += hamiltonian->Energy_Single_Spin( i, vf );
+        REQUIRE( E_single_spins == Approx( E ).epsilon( 1e-10 ) );
+    }
+}
+
+TEST_CASE( "Local Fields", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    std::mt19937 prng(1234);
+    auto distribution = std::normal_distribution<scalar>( 0, 1 );
+
+    for( auto state : { state_pairs, state_ddi_fft, state_quadruplets } )
+    {
+        Configuration_Random( state.get() );
+
+        auto spins = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        auto fields = vectorfield( state->nos );
+        auto fields_ref = vectorfield( state->nos );
+        hamiltonian->Local_Fields( spins, fields );
+
+        for( int n=0; n<20; ++n )
+        {
+            int ispin = n % state->nos;
+            Vector3 spin_new{ distribution(prng), distribution(prng), distribution(prng) };
+            spin_new.normalize();
+
+            // The energy difference has to agree with the difference of the total energies
+            scalar E_old = hamiltonian->Energy( spins );
+            scalar E_diff = hamiltonian->Energy_Difference_Single_Spin( ispin, spin_new, spins, fields );
+            Vector3 spin_old = spins[ispin];
+            spins[ispin] = spin_new;
+            scalar E_new = hamiltonian->Energy( spins );
+            REQUIRE( E_diff == Approx( E_new - E_old ).epsilon( 1e-8 ) );
+
+            // The updated fields have to agree with a recalculation
+            hamiltonian->Update_Local_Fields( ispin, spin_old, spins, fields );
+            hamiltonian->Local_Fields( spins, fields_ref );
+            for( int i=0; i<state->nos; i++ )
+                REQUIRE( fields[i].isApprox( fields_ref[i], 1e-8 ) );
+        }
+    }
+}
+
+TEST_CASE( "Single Spin Energies", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    for( auto state : { state_pairs, state_ddi_fft, state_quadruplets } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        // The energy of each spin has to be its share of the energy contributions
+        auto contributions = std::vector<std::pair<std::string, scalarfield>>( 0 );
+        hamiltonian->Energy_Contributions_per_Spin( vf, contributions );
+        for( int i=0; i<state->nos; i++ )
+        {
+            scalar E_i = 0;
+            for( auto& contribution : contributions )
+                E_i += contribution.second[i];
+            REQUIRE( hamiltonian->Energy_Single_Spin( i, vf ) == Approx( E_i ).epsilon( 1e-10 ) );
+        }
+    }
+}
+
+TEST_CASE( "Sparse Hessian", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    for( auto state : { state_pairs, state_ddi_fft, state_quadruplets } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        auto hessian = MatrixX( 3*state->nos, 3*state->nos );
+        auto hessian_fd = MatrixX( 3*state->nos, 3*state->nos );
+        hamiltonian->Hessian_FD( vf, hessian_fd );
+        hamiltonian->Hessian( vf, hessian );
+        REQUIRE( hessian_fd.isApprox( hessian, 1e-6 ) );
+
+        // The FFT dipole-dipole interaction has no sparse Hessian
+        auto hessian_sparse = SpMatrixX( 3*state->nos, 3*state->nos );
+        if( state != state_ddi_fft )
+        {
+            hamiltonian->Sparse_Hessian( vf, hessian_sparse );
+            REQUIRE( MatrixX( hessian_sparse ).isApprox( hessian ) );
+        }
+        else
+            REQUIRE_THROWS( hamiltonian->Sparse_Hessian( vf, hessian_sparse ) );
+    }
+}
+
+TEST_CASE( "Hessian Vector Product", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    std::mt19937 prng(1234);
+    auto distribution = std::normal_distribution<scalar>( 0, 1 );
+
+    for( auto state : { state_pairs, state_ddi_fft, state_quadruplets } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        auto vectors = vectorfield( state->nos );
+        for( auto& v : vectors )
+            v = { distribution(prng), distribution(prng), distribution(prng) };
+
+        // The analytical product has to agree with the dense Hessian and the finite difference fallback
+        auto hessian = MatrixX( 3*state->nos, 3*state->nos );
+        hamiltonian->Hessian( vf, hessian );
+        VectorX product_ref = hessian * Eigen::Map<VectorX>( vectors[0].data(), 3*state->nos );
+
+        auto product = vectorfield( state->nos );
+        auto product_fd = vectorfield( state->nos );
+        hamiltonian->Hessian_Vector_Product( vf, vectors, product );
+        hamiltonian->Engine::Hamiltonian::Hessian_Vector_Product( vf, vectors, product_fd );
+
+        REQUIRE( Eigen::Map<VectorX>( product[0].data(), 3*state->nos ).isApprox( product_ref ) );
+        REQUIRE( Eigen::Map<VectorX>( product_fd[0].data(), 3*state->nos ).isApprox( product_ref, 1e-6 ) );
+    }
+}
+
+TEST_CASE( "Energy and Gradient", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    for( auto state : { state_pairs, state_ddi_fft, state_quadruplets } )
+    {
+        Configuration_Random( state.get() );
+
+        auto& vf = *state->active_image->spins;
+        auto& hamiltonian = state->active_image->hamiltonian;
+
+        // The fused evaluation has to agree with the separate energy and gradient
+        auto gradient = vectorfield( state->nos );
+        auto gradient_ref = vectorfield( state->nos );
+        scalar energy = hamiltonian->Energy_and_Gradient( vf, gradient );
+        hamiltonian->Gradient( vf, gradient_ref );
+
+        REQUIRE( energy == Approx( hamiltonian->Energy( vf ) ).epsilon( 1e-10 ) );
+        for( int i=0; i<state->nos; i++ )
+            REQUIRE( gradient[i].isApprox( gradient_ref[i], 1e-10 ) );
+    }
+}
+
+// Thermal average of the energy over n_samples Monte Carlo sweeps, starting from the
+// ferromagnetic state, which is thermalised for 1000 sweeps
+scalar Sample_MC_Energy( State * state, int n_samples )
+{
+    Configuration_PlusZ( state );
+    Parameters_Set_MC_N_Iterations( state, 1000, 1000 );
+    Simulation_PlayPause( state, "MC", "" );
+    Quantity_Reset_MC_Averages( state );
+    Parameters_Set_MC_N_Iterations( state, n_samples, n_samples );
+    Simulation_PlayPause( state, "MC", "" );
+    REQUIRE( Quantity_Get_MC_N_Samples( state ) == n_samples );
+
+    float energy, m[3], m_abs, m_2, m_4;
+    Quantity_Get_MC_Averages( state, &energy, m, &m_abs, &m_2, &m_4 );
+    return energy;
+}
+
+TEST_CASE( "Metropolis Energy Differences", "[physics]" )
+{
+    // Near the ground state, each spin has two harmonic degrees of freedom, so that the
+    // thermal energy is N kB T by equipartition, with and without the local field cache
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    Configuration_PlusZ( state.get() );
+    scalar energy_ground_state = System_Get_Energy( state.get() );
+    scalar temperature = 5;
+    Parameters_Set_MC_Temperature( state.get(), temperature );
+
+    int n_samples = 10000;
+    for( bool local_field_cache : { false, true } )
+    {
+        Parameters_Set_MC_Local_Field_Cache( state.get(), local_field_cache );
+
+        scalar energy = Sample_MC_Energy( state.get(), n_samples );
+
+        INFO( "Local field cache: " << local_field_cache );
+        REQUIRE( energy - energy_ground_state == Approx( state->nos * Constants_k_B() * temperature ).epsilon( 0.02 ) );
+    }
+}
+
+TEST_CASE( "Parallel Metropolis Sweep", "[physics]" )
+{
+    // Pairs with anisotropy and a dipole-dipole cutoff, the FFT dipole-dipole interaction and quadruplets
+    auto state_pairs = Setup_Pairs_State();
+    auto state_ddi_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    auto state_quadruplets = std::shared_ptr<State>( State_Setup( "core/test/input/fd_quadruplets.cfg" ), State_Delete );
+
+    // The FFT dipole-dipole interaction couples all spins
+    intfield colours( 0 );
+    REQUIRE( state_ddi_fft->active_image->hamiltonian->Interaction_Colouring( state_ddi_fft->nos, 1, colours ) == 0 );
+
+    for( auto state : { state_pairs, state_quadruplets } )
+    {
+        auto& hamiltonian = state->active_image->hamiltonian;
+        intfield offsets( 0 ), partners( 0 );
+        hamiltonian->Interaction_Graph( state->nos, offsets, partners );
+
+        // Spins of one colour must not interact and, for distance 2, not share a partner
+        for( int distance : { 1, 2 } )
+        {
+            REQUIRE( hamiltonian->Interaction_Colouring( state->nos, distance, colours ) > 0 );
+            for( int i=0; i<state->nos; ++i )
+            {
+                for( int idx=offsets[i]; idx<offsets[i+1]; ++idx )
+                {
+                    int j = partners[idx];
+                    REQUIRE( colours[i] != colours[j] );
+                    if( distance < 2 ) continue;
+                    for( int jdx=offsets[j]; jdx<offsets[j+1]; ++jdx )
+                        if( partners[jdx] != i ) REQUIRE( colours[i] != colours[partners[jdx]] );
+                }
+            }
+        }
+    }
+
+    // The thermal average of the energy has to agree with the default serial sweep, which uses the energy
+    // differences instead of the local fields
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    Parameters_Set_MC_Temperature( state.get(), 20 );
+    int n_samples = 10000;
+    std::vector<scalar> energies( 0 );
+    Parameters_Set_MC_Local_Field_Cache( state.get(), false );
+    for( bool parallel_sweep : { false, true } )
+    {
+        Parameters_Set_MC_Parallel_Sweep( state.get(), parallel_sweep );
+
+        scalar energy = Sample_MC_Energy( state.get(), n_samples );
+        energies.push_back( energy );
+    }
+    for( auto energy : energies )
+        REQUIRE( energy == Approx( energies[0] ).epsilon( 1e-3 ) );
+}
+
+TEST_CASE( "Heat Bath", "[physics]" )
+{
+    // The anisotropy is not linear in the spin and corrected by the Metropolis criterion
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    float normal[3] = { 0, 0.6, 0.8 };
+    Hamiltonian_Set_Anisotropy( state.get(), 0.5, normal );
+    Parameters_Set_MC_Temperature( state.get(), 20 );
+    Parameters_Set_MC_Local_Field_Cache( state.get(), true );
+
+    // The thermal average of the energy has to agree with the Metropolis steps, serial and in parallel
+    int n_samples = 10000;
+    std::vector<scalar> energies( 0 );
+    std::vector<std::pair<int, bool>> setups{ { MC_Algorithm_Metropolis, false },
+        { MC_Algorithm_Heat_Bath, false }, { MC_Algorithm_Heat_Bath, true } };
+    for( auto setup : setups )
+    {
+        Parameters_Set_MC_Algorithm( state.get(), setup.first );
+        Parameters_Set_MC_Parallel_Sweep( state.get(), setup.second );
+        REQUIRE( Parameters_Get_MC_Algorithm( state.get() ) == setup.first );
+
+        scalar energy = Sample_MC_Energy( state.get(), n_samples );
+        energies.push_back( energy );
+    }
+    for( auto energy : energies )
+        REQUIRE( energy == Approx( energies[0] ).epsilon( 1e-3 ) );
+}
+
+TEST_CASE( "Wolff Cluster Updates", "[physics]" )
+{
+    // The DMI, the anisotropy and the external field are not part of the clusters and corrected by the Metropolis criterion
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    float normal[3] = { 0, 0.6, 0.8 };
+    Hamiltonian_Set_Anisotropy( state.get(), 0.5, normal );
+    Parameters_Set_MC_Temperature( state.get(), 20 );
+    Parameters_Set_MC_Local_Field_Cache( state.get(), true );
+
+    // The thermal average of the energy has to agree with the Metropolis steps
+    int n_samples = 10000;
+    std::vector<scalar> energies( 0 );
+    for( int algorithm : { MC_Algorithm_Metropolis, MC_Algorithm_Wolff } )
+    {
+        Parameters_Set_MC_Algorithm( state.get(), algorithm );
+        REQUIRE( Parameters_Get_MC_Algorithm( state.get() ) == algorithm );
+
+        scalar energy = Sample_MC_Energy( state.get(), n_samples );
+        energies.push_back( energy );
+    }
+    REQUIRE( energies[1] == Approx( energies[0] ).epsilon( 1e-3 ) );
+}
+
+TEST_CASE( "Parallel Tempering", "[physics]" )
+{
+    // A ladder of replicas
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    std::vector<float> temperatures{ 17, 18.5, 20, 21.5 };
+    int noi = temperatures.size();
+
+    // The samples of an image are not copied with it
+    Parameters_Set_MC_N_Iterations( state.get(), 10, 10 );
+    Simulation_PlayPause( state.get(), "MC", "" );
+    Chain_Image_to_Clipboard( state.get() );
+    Chain_Insert_Image_After( state.get() );
+    REQUIRE( Quantity_Get_MC_N_Samples( state.get(), 0 ) == 10 );
+    REQUIRE( Quantity_Get_MC_N_Samples( state.get(), 1 ) == 0 );
+    Chain_Delete_Image( state.get(), 1 );
+
+    Configuration_PlusZ( state.get() );
+    Chain_Image_to_Clipboard( state.get() );
+    for( int img=1; img<noi; ++img )
+        Chain_Insert_Image_After( state.get() );
+    for( int img=0; img<noi; ++img )
+    {
+        Parameters_Set_MC_Temperature( state.get(), temperatures[img], img );
+        Parameters_Set_MC_Local_Field_Cache( state.get(), true, img );
+    }
+
+    // Thermalise, then sample
+    Simulation_PlayPause( state.get(), "PT", "", 1000, 1000 );
+    for( int img=0; img<noi; ++img )
+        Quantity_Reset_MC_Averages( state.get(), img );
+    Simulation_PlayPause( state.get(), "PT", "", 10000, 1000 );
+    std::vector<float> ratios( noi-1 ), energies( noi ), magnetizations( noi );
+    Chain_Get_PT_Exchange_Ratios( state.get(), ratios.data() );
+    Chain_Get_PT_Energy_Mean( state.get(), energies.data() );
+    Chain_Get_PT_Magnetization_Mean( state.get(), magnetizations.data() );
+
+    for( int i=0; i<noi-1; ++i )
+    {
+        INFO( "Exchange of the images " << i << " and " << i+1 );
+        REQUIRE( ratios[i] > 0 );
+        REQUIRE( ratios[i] <= 1 );
+        REQUIRE( energies[i] < energies[i+1] );
+        REQUIRE( magnetizations[i] > magnetizations[i+1] );
+    }
+
+    // Each image accumulates the samples at its temperature (taken before the exchanges)
+    for( int img=0; img<noi; ++img )
+    {
+        float energy, m[3], m_abs, m_2, m_4;
+        Quantity_Get_MC_Averages( state.get(), &energy, m, &m_abs, &m_2, &m_4, img );
+        INFO( "Image " << img );
+        REQUIRE( Quantity_Get_MC_N_Samples( state.get(), img ) == 10000 );
+        REQUIRE( energy == Approx( energies[img] ).epsilon( 1e-3 ) );
+    }
+
+    // The thermal average of the energy has to agree with a single MC run at the same temperature
+    auto state_mc = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    Parameters_Set_MC_Temperature( state_mc.get(), temperatures[2] );
+    Parameters_Set_MC_Local_Field_Cache( state_mc.get(), true );
+    REQUIRE( energies[2] == Approx( Sample_MC_Energy( state_mc.get(), 10000 ) ).epsilon( 1e-3 ) );
+
+    // The replicas draw from their own streams, the generators of the images keep the key of their seed
+    for( int img=0; img<noi; ++img )
+    {
+        auto& parameters_mc = *state->active_chain->images[img]->mc_parameters;
+        REQUIRE( parameters_mc.philox.Bits( 0, 0 ) == Engine::Random::Philox( parameters_mc.rng_seed ).Bits( 0, 0 ) );
+    }
+
+    // Replicas at the same temperature, also at zero temperature, are always exchanged
+    for( int img=0; img<noi; ++img )
+        Parameters_Set_MC_Temperature( state.get(), 0, img );
+    Simulation_PlayPause( state.get(), "PT", "", 100, 100 );
+    Chain_Get_PT_Exchange_Ratios( state.get(), ratios.data() );
+    for( auto ratio : ratios )
+        REQUIRE( ratio == 1 );
+}
+
+TEST_CASE( "Blocking Analysis", "[physics]" )
+{
+    // Autoregressive series x_t = a x_{t-1} + noise, with the integrated autocorrelation
+    // time 1/2 (1+a)/(1-a) and the variance Var(noise)/(1-a^2)
+    scalar a = 0.8;
+    scalar tau_expected = 0.5 * (1 + a) / (1 - a);
+    scalar variance_expected = 1.0 / 12 / (1 - a*a);
+    std::mt19937 prng( 20006 );
+    Utility::Blocking_Statistics statistics;
+    int n_samples = 1 << 18;
+    scalar x = 0;
+    for( int n=0; n<n_samples; ++n )
+    {
+        x = a * x + (scalar)prng() / 4294967296.0 - 0.5;
+        statistics.Add( x );
+    }
+
+    REQUIRE( statistics.N() == n_samples );
+    REQUIRE( statistics.Variance() == Approx( variance_expected ).epsilon( 1e-2 ) );
+    REQUIRE( statistics.Autocorrelation_Time() == Approx( tau_expected ).epsilon( 0.2 ) );
+    REQUIRE( statistics.Error() == Approx( std::sqrt( 2 * tau_expected * variance_expected / n_samples ) ).epsilon( 0.1 ) );
+    REQUIRE( std::abs( statistics.Mean() ) < 4 * statistics.Error() );
+
+    statistics.Reset();
+    REQUIRE( statistics.N() == 0 );
+    REQUIRE( statistics.Mean() == 0 );
+}
+
+TEST_CASE( "Monte Carlo Averages", "[physics]" )
+{
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+    Parameters_Set_MC_Temperature( state.get(), 20 );
+    Parameters_Set_MC_Local_Field_Cache( state.get(), true );
+
+    // Thermalise, then accumulate the samples of many runs of 10 sweeps
+    Configuration_PlusZ( state.get() );
+    Parameters_Set_MC_N_Iterations( state.get(), 1000, 1000 );
+    Simulation_PlayPause( state.get(), "MC", "" );
+    Quantity_Reset_MC_Averages( state.get() );
+    REQUIRE( Quantity_Get_MC_N_Samples( state.get() ) == 0 );
+
+    Parameters_Set_MC_N_Iterations( state.get(), 10, 10 );
+    int n_runs = 1000;
+    scalar energy_expected = 0, m_abs_expected = 0;
+    for( int n=0; n<n_runs; ++n )
+    {
+        Simulation_PlayPause( state.get(), "MC", "" );
+        float m[3];
+        Quantity_Get_Magnetization( state.get(), m );
+        energy_expected += System_Get_Energy( state.get() ) / n_runs;
+        m_abs_expected  += std::sqrt( m[0]*m[0] + m[1]*m[1] + m[2]*m[2] ) / n_runs;
+    }
+
+    float energy, m[3], m_abs, m_2, m_4;
+    Quantity_Get_MC_Averages( state.get(), &energy, m, &m_abs, &m_2, &m_4 );
+    float specific_heat, susceptibility, binder_cumulant;
+    Quantity_Get_MC_Response( state.get(), &specific_heat, &susceptibility, &binder_cumulant );
+    float tau_energy, tau_m_abs, error_energy, error_m_abs;
+    Quantity_Get_MC_Autocorrelation( state.get(), &tau_energy, &tau_m_abs, &error_energy, &error_m_abs );
+
+    // The averages over every sweep have to agree with the samples taken every 10 sweeps
+    REQUIRE( Quantity_Get_MC_N_Samples( state.get() ) == 10*n_runs );
+    REQUIRE( energy == Approx( energy_expected ).epsilon( 1e-3 ) );
+    REQUIRE( m_abs == Approx( m_abs_expected ).epsilon( 1e-2 ) );
+    REQUIRE( m[2] == Approx( m_abs ).epsilon( 1e-2 ) );
+
+    // Moments and response functions
+    REQUIRE( m_2 >= m_abs*m_abs );
+    REQUIRE( m_4 >= m_2*m_2 );
+    REQUIRE( specific_heat > 0 );
+    REQUIRE( susceptibility > 0 );
+    REQUIRE( binder_cumulant > 0 );
+    REQUIRE( binder_cumulant <= 2.0/3.0 );
+
+    // Consecutive sweeps are correlated
+    REQUIRE( tau_energy > 0.5 );
+    REQUIRE( tau_m_abs > 0.5 );
+    REQUIRE( error_energy > 0 );
+    REQUIRE( error_m_abs > 0 );
+}
+
+TEST_CASE( "Dipole-Dipole Cutoff", "[physics]" )
+{
+    // With open boundaries and a cutoff radius beyond the system size, the energy is the sum over all pairs
+    // -mu_i mu_j mu_0 mu_B^2 / (4 pi r^3) (3 (s_i.n)(s_j.n) - s_i.s_j) and the gradient is its derivative
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/fd_pairs.cfg" ), State_Delete );
+    Configuration_Random( state.get() );
+    auto& spins = *state->active_image->spins;
+    auto& positions = state->active_image->geometry->positions;
+    auto& hamiltonian = state->active_image->hamiltonian;
+    int nos = state->nos;
+
+    auto gradient_without = vectorfield( nos ), gradient_with = vectorfield( nos );
+    scalar energy_without = hamiltonian->Energy( spins );
+    hamiltonian->Gradient( spins, gradient_without );
+    Hamiltonian_Set_DDI( state.get(), 100 );
+    scalar energy_with = hamiltonian->Energy( spins );
+    hamiltonian->Gradient( spins, gradient_with );
+
+    // The positions are in angstrom
+    scalar mu_s = 2;
+    scalar mult = Utility::Constants::mu_0 * std::pow( Utility::Constants::mu_B, 2 ) / ( 4*Utility::Constants::Pi * 1e-30 );
+    scalar energy_expected = 0;
+    for( int i=0; i<nos; ++i )
+    {
+        Vector3 gradient_expected{ 0, 0, 0 };
+        for( int j=0; j<nos; ++j )
+        {
+            if( i == j ) continue;
+            Vector3 r = positions[j] - positions[i];
+            Vector3 n = r.normalized();
+            scalar prefactor = mu_s * mu_s * mult / std::pow( r.norm(), 3 );
+            energy_expected   -= 0.5 * prefactor * ( 3 * spins[i].dot( n ) * spins[j].dot( n ) - spins[i].dot( spins[j] ) );
+            gradient_expected -= prefactor * ( 3 * n * spins[j].dot( n ) - spins[j] );
+        }
+        INFO( "Spin " << i );
+        REQUIRE( ( gradient_with[i] - gradient_without[i] ).isApprox( gradient_expected, 1e-10 ) );
+    }
+    REQUIRE( energy_with - energy_without == Approx( energy_expected ).epsilon( 1e-10 ) );
+}
+
+TEST_CASE( "Dipole-Dipole Cutoff and FFT", "[physics]" )
+{
+    // With open boundaries and a cutoff radius beyond the system size, both methods sum over all pairs
+    bool periodical[3] = { false, false, false };
+    auto state_fft = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    Hamiltonian_Set_Boundary_Conditions( state_fft.get(), periodical );
+    auto state_cutoff = std::shared_ptr<State>( State_Setup( "core/test/input/fd_ddi_fft.cfg" ), State_Delete );
+    Hamiltonian_Set_Boundary_Conditions( state_cutoff.get(), periodical );
+    auto ham_cutoff = std::dynamic_pointer_cast<Engine::Hamiltonian_Heisenberg>( state_cutoff->active_image->hamiltonian );
+    ham_cutoff->ddi_method = Engine::DDI_Method::Cutoff;
+    Hamiltonian_Set_DDI( state_cutoff.get(), 100 );
+
+    Configuration_Random( state_fft.get() );
+    auto& spins = *state_fft->active_image->spins;
+    *state_cutoff->active_image->spins = spins;
+
+    auto& hamiltonian_fft = state_fft->active_image->hamiltonian;
+    auto& hamiltonian_cutoff = state_cutoff->active_image->hamiltonian;
+
+    REQUIRE( hamiltonian_cutoff->Energy( spins ) == Approx( hamiltonian_fft->Energy( spins ) ).epsilon( 1e-10 ) );
+
+    auto grad_fft = vectorfield( state_fft->nos );
+    auto grad_cutoff = vectorfield( state_fft->nos );
+    hamiltonian_fft->Gradient( spins, grad_fft );
+    hamiltonian_cutoff->Gradient( spins, grad_cutoff );
+    for( int i=0; i<state_fft->nos; i++ )
+        REQUIRE( grad_cutoff[i].isApprox( grad_fft[i], 1e-10 ) );
+}
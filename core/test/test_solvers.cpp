@@ -22,7 +22,7 @@ TEST_CASE( "Solvers testing", "[solvers]" )
     auto method = "LLG";
     
     // Solvers to be tested
-    std::vector<const char *>  solvers { "VP", "Heun", "SIB", "Depondt" };
+    std::vector<const char *>  solvers { "VP", "Heun", "SIB", "Depondt", "BFGS" };
     
     // Expected values
     float energy_expected = -5849.69140625f;
@@ -90,7 +90,7 @@ TEST_CASE( "Solvers testing", "[solvers]" )
     method = "GNEB";
 
     // Solvers to be tested
-    solvers = { "VP", "Heun", "Depondt" };
+    solvers = { "VP", "Heun", "Depondt", "BFGS" };
 
     // Expected values
     float energy_sp_expected = -5811.5244140625f;
@@ -135,4 +135,96 @@ TEST_CASE( "Solvers testing", "[solvers]" )
             REQUIRE( magnetization_sp[dim] == Approx( magnetization_sp_expected[dim] ) );
     }
 
-}
\ No newline at end of file
+}
+TEST_CASE( "Parallel evaluation of images", "[solvers]" )
+{
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+
+    // A skyrmion collapse transition
+    int noi = 5;
+    Configuration_PlusZ( state.get() );
+    Configuration_Skyrmion( state.get(), 5, 1, -90, false, false, false );
+    Chain_Image_to_Clipboard( state.get() );
+    for (int i=1; i<noi; ++i)
+        Chain_Insert_Image_After( state.get() );
+    int nos = System_Get_NOS( state.get() );
+
+    // The images have to be the same as with the serial evaluation
+    std::vector<const char *> solvers { "VP", "Heun", "SIB", "Depondt", "BFGS" };
+    for ( auto solver : solvers )
+    {
+        std::vector<std::vector<scalar>> spins_serial( noi );
+        for ( bool parallel_images : { false, true } )
+        {
+            Chain_Replace_Image( state.get(), 0 );
+            Chain_Jump_To_Image( state.get(), noi-1 );
+            Configuration_PlusZ( state.get() );
+            Chain_Jump_To_Image( state.get(), 0 );
+            Transition_Homogeneous( state.get(), 0, noi-1 );
+
+            Parameters_Set_GNEB_Parallel_Images( state.get(), parallel_images );
+            Simulation_PlayPause( state.get(), "GNEB", solver, 200 );
+
+            for (int img=0; img<noi; ++img)
+            {
+                scalar * spins = System_Get_Spin_Directions( state.get(), img );
+                if ( !parallel_images )
+                {
+                    spins_serial[img].assign( spins, spins + 3*nos );
+                    continue;
+                }
+                INFO( solver << std::string( " solver, image " ) << img );
+                for (int i=0; i<3*nos; ++i)
+                    REQUIRE( spins[i] == spins_serial[img][i] );
+            }
+        }
+    }
+    Parameters_Set_GNEB_Parallel_Images( state.get(), false );
+}
+
+TEST_CASE( "Minimum mode following", "[solvers]" )
+{
+    auto state = std::shared_ptr<State>( State_Setup( "core/test/input/solvers.cfg" ), State_Delete );
+
+    // Expected values of the skyrmion collapse saddle point (see the GNEB test)
+    float energy_sp_expected = -5811.5244140625f;
+    std::vector<float> magnetization_sp_expected{ 0, 0, 0.96657f };
+
+    // A rough skyrmion collapse transition
+    int noi = 9;
+    Configuration_PlusZ( state.get() );
+    Configuration_Skyrmion( state.get(), 5, 1, -90, false, false, false );
+    Simulation_PlayPause( state.get(), "LLG", "VP" );
+    Chain_Image_to_Clipboard( state.get() );
+    for (int i=1; i<noi; ++i)
+        Chain_Insert_Image_After( state.get() );
+    Chain_Jump_To_Image( state.get(), noi-1 );
+    Configuration_PlusZ( state.get() );
+    Chain_Jump_To_Image( state.get(), 0 );
+    Transition_Homogeneous( state.get(), 0, noi-1 );
+    Simulation_PlayPause( state.get(), "GNEB", "VP", 2000 );
+
+    // Start the minimum mode following from the highest image, which it uses as the last image of the chain
+    int i_max = 1;
+    for (int i=2; i<noi-1; ++i)
+        if (System_Get_Energy(state.get(), i) > System_Get_Energy(state.get(), i_max)) i_max = i;
+    Chain_Image_to_Clipboard( state.get(), i_max );
+    Chain_Replace_Image( state.get(), noi-1 );
+
+    std::vector<const char *> solvers { "VP", "Depondt", "BFGS" };
+    for ( auto solver : solvers )
+    {
+        Chain_Jump_To_Image( state.get(), noi-1 );
+        Chain_Replace_Image( state.get(), noi-1 );
+        Simulation_PlayPause( state.get(), "MMF", solver );
+
+        float energy_sp = System_Get_Energy( state.get(), noi-1 );
+        std::vector<float> magnetization_sp{ 0, 0, 0 };
+        Quantity_Get_Magnetization( state.get(), magnetization_sp.data(), noi-1 );
+
+        INFO( solver << std::string( " solver using MMF" ) );
+        REQUIRE( energy_sp == Approx( energy_sp_expected ) );
+        for (int dim=0; dim<3; dim++)
+            REQUIRE( magnetization_sp[dim] == Approx( magnetization_sp_expected[dim] ) );
+    }
+}
@@ -2,6 +2,9 @@
 #include <engine/Vectormath_Defines.hpp>
 #include <engine/Vectormath.hpp>
 
+#include <Eigen/Geometry>
+#include <random>
+
 
 TEST_CASE( "Vectormath operations", "[vectormath]" )
 {
@@ -262,4 +265,148 @@ TEST_CASE( "Vectormath operations", "[vectormath]" )
         for (int i = 0; i < N_check; ++i)
             REQUIRE(vftest[i] == vtest3);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Vectormath kernels on non-uniform fields", "[vectormath]" )
+{
+    // An odd size, so that the SIMD kernels also have to handle a partial tile
+    int N = 1001;
+    std::mt19937 prng(1337);
+    vectorfield vf1(N), vf2(N), vfout(N, Vector3{ 0.5, -0.25, 1.0 });
+    Engine::Vectormath::get_random_vectorfield(prng, vf1);
+    Engine::Vectormath::get_random_vectorfield(prng, vf2);
+    scalar eps = 1e-12;
+
+    SECTION("Cross products")
+    {
+        vectorfield expected = vfout;
+        for (int i = 0; i < N; ++i)
+            expected[i] += 0.7 * vf1[i].cross(vf2[i]);
+        Engine::Vectormath::add_c_cross(0.7, vf1, vf2, vfout);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( vfout[i].isApprox(expected[i], eps) );
+
+        Engine::Vectormath::set_c_cross(-1.3, vf1, vf2, vfout);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( vfout[i].isApprox(-1.3 * vf1[i].cross(vf2[i]), eps) );
+    }
+
+    SECTION("Norms and dot products")
+    {
+        scalarfield sf(N);
+        Engine::Vectormath::norm(vf1, sf);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( sf[i] == Approx(vf1[i].norm()) );
+
+        Engine::Vectormath::dot(vf1, vf2, sf);
+        scalar dot = 0;
+        for (int i = 0; i < N; ++i)
+        {
+            REQUIRE( sf[i] == Approx(vf1[i].dot(vf2[i])) );
+            dot += vf1[i].dot(vf2[i]);
+        }
+        REQUIRE( Engine::Vectormath::dot(vf1, vf2) == Approx(dot) );
+
+        vectorfield expected = vf1;
+        for (int i = 0; i < N; ++i)
+            expected[i].normalize();
+        Engine::Vectormath::normalize_vectors(vf1);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( vf1[i].isApprox(expected[i], eps) );
+    }
+
+    SECTION("Linear combinations")
+    {
+        vectorfield expected(N);
+        for (int i = 0; i < N; ++i)
+            expected[i] = vfout[i] + 0.3 * vf1[i];
+        Engine::Vectormath::add_c_a(0.3, vf1, vfout);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( vfout[i].isApprox(expected[i], eps) );
+
+        Engine::Vectormath::set_c_a(-2, vf2, vfout);
+        Engine::Vectormath::scale(vfout, 0.25);
+        for (int i = 0; i < N; ++i)
+            REQUIRE( vfout[i].isApprox(-0.5 * vf2[i], eps) );
+    }
+
+    SECTION("Rotation and SIB transform")
+    {
+        Engine::Vectormath::normalize_vectors(vf2);
+        scalarfield angle(N);
+        for (int i = 0; i < N; ++i)
+            angle[i] = 0.01 * i;
+        Engine::Vectormath::rotate(vf1, vf2, angle, vfout);
+        for (int i = 0; i < N; ++i)
+        {
+            Vector3 expected;
+            Engine::Vectormath::rotate(vf1[i], vf2[i], angle[i], expected);
+            REQUIRE( vfout[i].isApprox(expected, eps) );
+        }
+
+        // The transform is a rotation, i.e. it preserves the length of the spins
+        Engine::Vectormath::normalize_vectors(vf1);
+        Engine::Vectormath::transform(vf1, vf2, vfout);
+        for (int i = 0; i < N; ++i)
+        {
+            REQUIRE( vfout[i].norm() == Approx(1) );
+            Vector3 A = 0.5 * vf2[i];
+            Vector3 expected = vf1[i] - vf1[i].cross(A);
+            // The SIB update solves (1 + [A]x) s' = (1 - [A]x) s
+            REQUIRE( (vfout[i] + vfout[i].cross(A)).isApprox(expected, eps) );
+        }
+    }
+}
+
+
+TEST_CASE( "Counter-based random numbers", "[vectormath]" )
+{
+    SECTION("Known answers of Philox4x32-10")
+    {
+        auto bits = Engine::Random::Philox(0).Bits(0, 0);
+        REQUIRE( bits[0] == 0x6627e8d5 );
+        REQUIRE( bits[1] == 0xe169c58d );
+        REQUIRE( bits[2] == 0xbc57ac4c );
+        REQUIRE( bits[3] == 0x9b00dbd8 );
+
+        std::uint64_t all = 0xffffffffffffffff;
+        bits = Engine::Random::Philox(all).Bits(all, all);
+        REQUIRE( bits[0] == 0x408f276d );
+        REQUIRE( bits[1] == 0x41c83b0e );
+        REQUIRE( bits[2] == 0xa20bc7c6 );
+        REQUIRE( bits[3] == 0x6d5451fd );
+    }
+
+    SECTION("Random vectorfields")
+    {
+        int N = 5000;
+        Engine::Random::Philox prng_1(42), prng_2(42);
+        vectorfield xi_1(N), xi_2(N), xi_3(N);
+
+        Engine::Vectormath::get_random_vectorfield_unitsphere(prng_1, xi_1);
+        Engine::Vectormath::get_random_vectorfield_unitsphere(prng_1, xi_2);
+        Engine::Vectormath::get_random_vectorfield_unitsphere(prng_2, xi_3);
+        REQUIRE( prng_1.draw == 2 );
+
+        // Each draw gives new vectors, the same seed and draw give the same vectors
+        Vector3 mean{ 0, 0, 0 };
+        for (int i = 0; i < N; ++i)
+        {
+            REQUIRE( xi_1[i].norm() == Approx(1) );
+            REQUIRE( xi_1[i] != xi_2[i] );
+            REQUIRE( xi_1[i] == xi_3[i] );
+            mean += xi_1[i] / N;
+        }
+        REQUIRE( mean.norm() < 0.05 );
+
+        // The vectors lie in [-1,1)^3 and are independent of the order in which they are drawn
+        Engine::Vectormath::get_random_vectorfield(prng_1, xi_1);
+        for (int i = 0; i < N; ++i)
+        {
+            REQUIRE( xi_1[i].cwiseAbs().maxCoeff() <= 1 );
+            auto r = prng_1.Uniform(2, 2*i);
+            REQUIRE( xi_1[i][0] == 2*r[0]-1 );
+            REQUIRE( xi_1[i][1] == 2*r[1]-1 );
+        }
+    }
+}